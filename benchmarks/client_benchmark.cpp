@@ -0,0 +1,108 @@
+// Сквозной бенчмарк клиента против MockOpenAIServer на loopback.
+//
+// Сервер отвечает без задержек, поэтому время уходит на клиент: сборку
+// запроса, libcurl, разбор JSON и SSE. Прогон не требует сети и ключа, а
+// seed сервера делает его повторяемым.
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+std::vector<agentixx::Message> Prompt(size_t i) {
+  return {{"system", "You are a benchmark."},
+          {"user", "Request number " + std::to_string(i)}};
+}
+
+void RunChat(agentixx::OpenAIAdapter& llm, size_t requests) {
+  auto start = std::chrono::steady_clock::now();
+  size_t ok = 0;
+  for (size_t i = 0; i < requests; ++i) {
+    ok += llm.Chat(Prompt(i)).text().empty() ? 0 : 1;
+  }
+  double elapsed = Seconds(start);
+  std::printf("Chat sequential  | %5zu requests | %8.0f req/s | %7.1f us/req"
+              " | ok %zu\n",
+              requests, requests / elapsed, elapsed * 1e6 / requests, ok);
+}
+
+void RunBatch(agentixx::OpenAIAdapter& llm, size_t requests,
+              size_t in_flight) {
+  std::vector<std::vector<agentixx::Message>> batch;
+  for (size_t i = 0; i < requests; ++i) {
+    batch.push_back(Prompt(i));
+  }
+  agentixx::BatchOptions options;
+  options.SetMaxInFlight(in_flight);
+
+  auto start = std::chrono::steady_clock::now();
+  size_t ok = 0;
+  for (const auto& result : llm.ChatBatch(batch, options)) {
+    ok += result.ok() ? 1 : 0;
+  }
+  double elapsed = Seconds(start);
+  std::printf("ChatBatch x%-5zu | %5zu requests | %8.0f req/s | %7.1f us/req"
+              " | ok %zu\n",
+              in_flight, requests, requests / elapsed,
+              elapsed * 1e6 / requests, ok);
+}
+
+void RunStream(agentixx::OpenAIAdapter& llm, size_t streams) {
+  auto start = std::chrono::steady_clock::now();
+  size_t chunks = 0;
+  for (size_t i = 0; i < streams; ++i) {
+    auto stream = llm.ChatStream(Prompt(i));
+    for (const auto& chunk : stream) {
+      chunks += chunk.text().empty() ? 0 : 1;
+    }
+  }
+  double elapsed = Seconds(start);
+  std::printf("ChatStream       | %5zu streams  | %8.0f tok/s | %7.1f ns/tok\n",
+              streams, chunks / elapsed, elapsed * 1e9 / chunks);
+}
+
+}  // namespace
+
+int main() {
+  agentixx::MockServerOptions options;
+  options.SetSeed(42);
+  options.behavior.SetCompletionTokens(32);
+  // Потоки длинные: время на токен, а не на открытие запроса
+  options.SetScript(
+      [](const agentixx::MockRequest& request,
+         agentixx::MockBehavior& behavior) {
+        if (request.stream) {
+          behavior.SetCompletionTokens(20000);
+        }
+      });
+  agentixx::MockOpenAIServer server(options);
+  server.Start();
+
+  agentixx::Config config;
+  config.SetApiKey("mock");
+  config.SetBaseUrl(server.base_url());
+  agentixx::OpenAIAdapter llm(config, "mock-model");
+
+  std::printf("=== Client benchmark against %s ===\n",
+              server.base_url().c_str());
+  RunChat(llm, 2000);
+  RunBatch(llm, 2000, 8);
+  RunBatch(llm, 2000, 32);
+  RunStream(llm, 5);
+
+  agentixx::MockServerStats stats = server.stats();
+  std::printf("server: %llu requests, %llu connections\n",
+              static_cast<unsigned long long>(stats.requests),
+              static_cast<unsigned long long>(stats.connections));
+  return 0;
+}
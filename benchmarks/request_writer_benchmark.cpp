@@ -0,0 +1,153 @@
+// Сравнение JsonWriter с прежней сборкой тела chat запроса через DOM
+// (Json объект, Message::ToJson на каждое сообщение и dump).
+//
+// История сообщений агента из 10, 100 и 1000 сообщений с кириллицей,
+// кавычками и переводами строк, чтобы экранирование тоже измерялось.
+// Результаты обоих способов сравниваются после разбора.
+//
+// Отдельно измеряется ход агента: к истории добавляются два сообщения и
+// собирается JSON массив сообщений заново (JsonWriter) или дописывается
+// к готовому (Conversation).
+
+#include <agentixx/agentixx.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using agentixx::Conversation;
+using agentixx::Json;
+using agentixx::JsonWriter;
+using agentixx::Message;
+
+// Прежний алгоритм BuildChatRequestWithOptions
+std::string BuildWithDom(const std::string& model,
+                         const std::vector<Message>& messages) {
+  Json request = {{"model", model},
+                  {"messages", Json::array()},
+                  {"temperature", 0.2}};
+  request["max_tokens"] = 512;
+  request["stream"] = true;
+  for (const auto& msg : messages) {
+    request["messages"].push_back(msg.ToJson());
+  }
+  return request.dump();
+}
+
+void BuildWithWriter(const std::string& model,
+                     const std::vector<Message>& messages, std::string* out) {
+  out->clear();
+  JsonWriter writer(out);
+  writer.BeginObject().Key("model").String(model).Key("messages");
+  writer.BeginArray();
+  for (const auto& msg : messages) {
+    msg.WriteJson(writer);
+  }
+  writer.EndArray();
+  writer.Key("temperature").Double(0.2);
+  writer.Key("max_tokens").Int(512);
+  writer.Key("stream").Bool(true);
+  writer.EndObject();
+}
+
+std::vector<Message> MakeHistory(size_t count) {
+  std::vector<Message> messages;
+  messages.emplace_back("system", "Ты агент. Отвечай кратко.\nИнструменты: "
+                                  "\"search\", \"read_file\".");
+  for (size_t i = 1; i < count; ++i) {
+    std::string content =
+        "Шаг " + std::to_string(i) +
+        ": вызов read_file(\"src/core/module_" + std::to_string(i) +
+        ".cpp\")\n\tрезультат: 200 строк, функция Run() возвращает "
+        "status = \"ok\". ";
+    content += std::string(200, 'x');
+    messages.emplace_back(i % 2 ? "assistant" : "user", content);
+  }
+  return messages;
+}
+
+template <typename Build>
+double Measure(int iterations, Build&& build) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    build();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+void Run(size_t count, int iterations) {
+  const std::string model = "gpt-4o-mini";
+  const std::vector<Message> messages = MakeHistory(count);
+
+  std::string dom_body;
+  double dom_time = Measure(
+      iterations, [&] { dom_body = BuildWithDom(model, messages); });
+
+  // Буфер переиспользуется между итерациями, как в цикле агента
+  std::string writer_body;
+  double writer_time = Measure(
+      iterations, [&] { BuildWithWriter(model, messages, &writer_body); });
+
+  if (Json::parse(dom_body) != Json::parse(writer_body)) {
+    std::printf("MISMATCH for %zu messages\n", count);
+  }
+
+  std::printf("%5zu messages, %8.1f KB | DOM %9.1f us %7.1f MB/s | "
+              "JsonWriter %9.1f us %7.1f MB/s | x%.1f\n",
+              count, writer_body.size() / 1e3, dom_time * 1e6,
+              dom_body.size() / dom_time / 1e6, writer_time * 1e6,
+              writer_body.size() / writer_time / 1e6, dom_time / writer_time);
+}
+
+// Стоимость одного хода при истории из count сообщений
+void RunTurns(size_t count, int iterations) {
+  const std::vector<Message> history = MakeHistory(count);
+  const Message turn("user", history.back().content);
+
+  std::vector<Message> messages = history;
+  std::string body;
+  double writer_time = Measure(iterations, [&] {
+    messages.push_back(turn);
+    messages.push_back(turn);
+    body.clear();
+    JsonWriter writer(&body);
+    writer.BeginArray();
+    for (const auto& msg : messages) {
+      msg.WriteJson(writer);
+    }
+    writer.EndArray();
+    messages.resize(history.size());
+  });
+
+  Conversation conversation = Conversation::FromMessages(history);
+  double conversation_time = Measure(iterations, [&] {
+    conversation.Add(turn);
+    conversation.Add(turn);
+    body.assign(conversation.messages_json());
+    conversation.Truncate(history.size());
+  });
+
+  std::printf("%5zu messages + 2 | JsonWriter %9.1f us | "
+              "Conversation %9.1f us | x%.1f\n",
+              count, writer_time * 1e6, conversation_time * 1e6,
+              writer_time / conversation_time);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("=== Chat request serialization benchmark ===\n");
+  Run(10, 20000);
+  Run(100, 2000);
+  Run(1000, 200);
+
+  std::printf("=== Agent turn: append two messages ===\n");
+  RunTurns(10, 20000);
+  RunTurns(100, 2000);
+  RunTurns(1000, 200);
+  return 0;
+}
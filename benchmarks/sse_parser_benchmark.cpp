@@ -0,0 +1,124 @@
+// Сравнение SseParser с прежним разбором SSE в StreamingWriteCallback
+// (append в буфер, substr и erase на каждую строку).
+//
+// Поток из событий в формате OpenAI chat.completion.chunk подается кусками
+// по 16 KiB (CURL_MAX_WRITE_SIZE) и по 1 MiB (пачка данных от быстрого
+// сервера). JSON не разбирается: измеряется только выделение событий.
+
+#include <agentixx/agentixx.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace {
+
+struct Result {
+  size_t events = 0;
+  size_t payload_bytes = 0;
+};
+
+// Прежний алгоритм разбора, перенесенный без изменений
+class LegacySplitter {
+ public:
+  void Feed(std::string_view input, Result& result) {
+    buffer_.append(input.data(), input.size());
+
+    size_t pos = 0;
+    while ((pos = buffer_.find('\n')) != std::string::npos) {
+      std::string line = buffer_.substr(0, pos);
+      buffer_.erase(0, pos + 1);
+
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+
+      if (line.length() >= 6 && line.substr(0, 6) == "data: ") {
+        std::string json_data = line.substr(6);
+        if (json_data != "[DONE]" && !json_data.empty()) {
+          ++result.events;
+          result.payload_bytes += json_data.size();
+        }
+      }
+    }
+  }
+
+ private:
+  std::string buffer_;
+};
+
+std::string MakeStream(size_t events) {
+  std::string stream;
+  for (size_t i = 0; i < events; ++i) {
+    stream +=
+        "data: {\"id\":\"chatcmpl-9x\",\"object\":\"chat.completion.chunk\","
+        "\"created\":1718000000,\"model\":\"gpt-4o-mini\",\"choices\":[{"
+        "\"index\":0,\"delta\":{\"content\":\"token" +
+        std::to_string(i) + " \"},\"finish_reason\":null}]}\n\n";
+  }
+  stream += "data: [DONE]\n\n";
+  return stream;
+}
+
+template <typename Feed>
+double Measure(const std::string& stream, size_t chunk_size, int iterations,
+               Feed&& feed) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (size_t pos = 0; pos < stream.size(); pos += chunk_size) {
+      feed(std::string_view(stream).substr(pos, chunk_size));
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void Run(const std::string& stream, size_t events, size_t chunk_size,
+         int iterations) {
+  Result legacy;
+  LegacySplitter splitter;
+  double legacy_time =
+      Measure(stream, chunk_size, iterations,
+              [&](std::string_view chunk) { splitter.Feed(chunk, legacy); });
+
+  Result parsed;
+  agentixx::SseParser parser;
+  agentixx::SseParser::EventHandler on_event =
+      [&](const agentixx::SseEvent& event) {
+        if (event.data != "[DONE]") {
+          ++parsed.events;
+          parsed.payload_bytes += event.data.size();
+        }
+      };
+  double parser_time =
+      Measure(stream, chunk_size, iterations,
+              [&](std::string_view chunk) { parser.Feed(chunk, on_event); });
+
+  if (legacy.events != parsed.events ||
+      legacy.payload_bytes != parsed.payload_bytes) {
+    std::printf("MISMATCH: legacy %zu events, SseParser %zu events\n",
+                legacy.events, parsed.events);
+  }
+
+  double megabytes = static_cast<double>(stream.size()) * iterations / 1e6;
+  double total_events = static_cast<double>(events) * iterations;
+  std::printf("chunk %7zu B | legacy %8.1f MB/s %7.1f ns/event | "
+              "SseParser %8.1f MB/s %7.1f ns/event | x%.1f\n",
+              chunk_size, megabytes / legacy_time,
+              legacy_time * 1e9 / total_events, megabytes / parser_time,
+              parser_time * 1e9 / total_events, legacy_time / parser_time);
+}
+
+}  // namespace
+
+int main() {
+  const size_t events = 20000;
+  const std::string stream = MakeStream(events);
+  std::printf("=== SSE parser benchmark: %zu events, %.1f MB ===\n", events,
+              stream.size() / 1e6);
+
+  Run(stream, events, 16 * 1024, 20);
+  Run(stream, events, 1024 * 1024, 20);
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Скорость поиска окончаний строк SSE потока: цикл std::string::find,
+// которым пользовался прежний StreamingWriteCallback, против скалярной,
+// SSE2 и AVX2 реализаций ScanLineEnds.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sse_scan.hpp"
+
+namespace {
+
+std::string MakeStream(size_t events) {
+  std::string stream;
+  for (size_t i = 0; i < events; ++i) {
+    stream +=
+        "data: {\"id\":\"chatcmpl-9x\",\"object\":\"chat.completion.chunk\","
+        "\"created\":1718000000,\"model\":\"gpt-4o-mini\",\"choices\":[{"
+        "\"index\":0,\"delta\":{\"content\":\"token" +
+        std::to_string(i) + " \"},\"finish_reason\":null}]}\n\n";
+  }
+  return stream;
+}
+
+// Прежний способ: find('\n') от позиции за предыдущей строкой
+size_t CountWithFind(const std::string& buffer) {
+  size_t count = 0;
+  size_t pos = 0;
+  while ((pos = buffer.find('\n', pos)) != std::string::npos) {
+    ++count;
+    ++pos;
+  }
+  return count;
+}
+
+template <typename Scan>
+void Report(const char* name, const std::string& stream, size_t chunk_size,
+            int iterations, Scan&& scan) {
+  size_t count = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (size_t pos = 0; pos < stream.size(); pos += chunk_size) {
+      count += scan(stream.data() + pos,
+                    std::min(chunk_size, stream.size() - pos));
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double bytes = static_cast<double>(stream.size()) * iterations;
+  std::printf("  %-12s %8.2f GB/s  (%zu line ends)\n", name,
+              bytes / elapsed.count() / 1e9, count / iterations);
+}
+
+void Run(const std::string& stream, size_t chunk_size, int iterations) {
+  std::printf("chunk %zu B:\n", chunk_size);
+
+  std::string buffer;
+  Report("string::find", stream, chunk_size, iterations,
+         [&](const char* data, size_t size) {
+           buffer.assign(data, size);
+           return CountWithFind(buffer);
+         });
+
+  std::vector<uint32_t> ends;
+  auto scanner = [&](auto scan) {
+    return [&ends, scan](const char* data, size_t size) {
+      ends.clear();
+      scan(data, size, &ends);
+      return ends.size();
+    };
+  };
+
+  Report("scalar", stream, chunk_size, iterations,
+         scanner(agentixx::ScanLineEndsScalar));
+  if (agentixx::ScanIsaSupported(agentixx::ScanIsa::kSse2)) {
+    Report("sse2", stream, chunk_size, iterations,
+           scanner(agentixx::ScanLineEndsSse2));
+  }
+  if (agentixx::ScanIsaSupported(agentixx::ScanIsa::kAvx2)) {
+    Report("avx2", stream, chunk_size, iterations,
+           scanner(agentixx::ScanLineEndsAvx2));
+  }
+  Report("dispatch", stream, chunk_size, iterations,
+         scanner(agentixx::ScanLineEnds));
+}
+
+}  // namespace
+
+int main() {
+  const std::string stream = MakeStream(20000);
+  const char* isa[] = {"scalar", "sse2", "avx2"};
+  std::printf("=== SSE line scan benchmark: %.1f MB, dispatch -> %s ===\n",
+              stream.size() / 1e6,
+              isa[static_cast<int>(agentixx::ActiveScanIsa())]);
+
+  Run(stream, 16 * 1024, 50);
+  Run(stream, 1024 * 1024, 50);
+  return 0;
+}
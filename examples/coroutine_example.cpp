@@ -0,0 +1,60 @@
+// Корутинный API: сотни диалогов агента без потока на каждый.
+// Собирается с -DENABLE_COROUTINES=ON. Ключ и адрес API берутся из
+// AGENT_API_KEY и AGENT_BASE_URL.
+
+#include <agentixx/agentixx.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using agentixx::Task;
+
+// Диалог из двух ходов, записанный последовательно
+Task<std::string> TalkToAgent(const agentixx::OpenAIAdapter& llm, int id) {
+  agentixx::Conversation conversation;
+  conversation.Add("user", "Придумай число для агента " + std::to_string(id));
+
+  agentixx::Response reply = co_await llm.ChatAsync(conversation);
+  conversation.Add("assistant", reply.text());
+  conversation.Add("user", "Умножь его на два");
+
+  reply = co_await llm.ChatAsync(conversation);
+  co_return reply.text();
+}
+
+Task<void> StreamAnswer(const agentixx::OpenAIAdapter& llm) {
+  agentixx::AsyncStream stream =
+      llm.ChatStreamAsync({{"user", "Расскажи про корутины C++20"}});
+  while (auto chunk = co_await stream.Next()) {
+    std::cout << chunk->text() << std::flush;
+  }
+  std::cout << std::endl;
+}
+
+int main() {
+  agentixx::Config config;
+  config.UseEnv();
+  if (config.api_key.empty()) {
+    std::cerr << "Установите переменную среды AGENT_API_KEY" << std::endl;
+    return 1;
+  }
+
+  try {
+    agentixx::OpenAIAdapter llm(config, "gpt-4o-mini");
+
+    std::vector<Task<std::string>> conversations;
+    for (int id = 0; id < 100; ++id) {
+      conversations.push_back(TalkToAgent(llm, id));
+    }
+    std::vector<std::string> answers =
+        agentixx::SyncWait(agentixx::WhenAll(std::move(conversations)));
+    std::cout << "Диалогов завершено: " << answers.size() << std::endl;
+    std::cout << "Первый ответ: " << answers.front() << std::endl;
+
+    agentixx::SyncWait(StreamAnswer(llm));
+  } catch (const std::exception& e) {
+    std::cerr << "Ошибка: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+// Прогон JSONL файла с чатами через OpenAI-совместимый API.
+//
+//   jsonl_batch_example input.jsonl output.jsonl [--checkpoint file]
+//       [--concurrency N] [--model name]
+//
+// Ключ и адрес API берутся из AGENT_API_KEY и AGENT_BASE_URL, поэтому
+// прогон можно проверить на локальном mock сервере. После сбоя повторный
+// запуск с тем же --checkpoint продолжит с места остановки.
+
+#include <agentixx/agentixx.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Использование: " << argv[0]
+              << " input.jsonl output.jsonl [--checkpoint file]"
+                 " [--concurrency N] [--model name]"
+              << std::endl;
+    return 2;
+  }
+
+  std::string input = argv[1];
+  std::string output = argv[2];
+  std::string model = "gpt-4o-mini";
+  agentixx::JsonlRunOptions options;
+
+  for (int i = 3; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    if (flag == "--checkpoint") {
+      options.SetCheckpointPath(argv[i + 1]);
+    } else if (flag == "--concurrency") {
+      options.SetMaxInFlight(std::strtoul(argv[i + 1], nullptr, 10));
+    } else if (flag == "--model") {
+      model = argv[i + 1];
+    } else {
+      std::cerr << "Неизвестный параметр: " << flag << std::endl;
+      return 2;
+    }
+  }
+
+  options.SetOnProgress([](const agentixx::JsonlProgress& progress) {
+    double percent = progress.input_size
+                         ? 100.0 * progress.input_offset / progress.input_size
+                         : 100.0;
+    std::fprintf(stderr,
+                 "\r%llu строк (%llu ok, %llu ошибок) %5.1f%% | "
+                 "%.1f строк/с, %.2f MB/с   ",
+                 static_cast<unsigned long long>(progress.lines),
+                 static_cast<unsigned long long>(progress.succeeded),
+                 static_cast<unsigned long long>(progress.failed), percent,
+                 progress.lines_per_second, progress.bytes_per_second / 1e6);
+  });
+
+  try {
+    agentixx::Config config;
+    config.UseEnv();
+    if (config.api_key.empty()) {
+      std::cerr << "Установите переменную среды AGENT_API_KEY" << std::endl;
+      return 1;
+    }
+
+    agentixx::OpenAIAdapter llm(config, model);
+    agentixx::JsonlRunner runner(llm, options);
+    agentixx::JsonlProgress result = runner.Run(input, output);
+
+    std::fprintf(stderr,
+                 "\nГотово: %llu строк за %.1f с, ошибок: %llu\n",
+                 static_cast<unsigned long long>(result.lines),
+                 result.elapsed_seconds,
+                 static_cast<unsigned long long>(result.failed));
+    return result.failed == 0 ? 0 : 3;
+  } catch (const std::exception& e) {
+    std::cerr << "\nОшибка: " << e.what() << std::endl;
+    return 1;
+  }
+}
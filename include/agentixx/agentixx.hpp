@@ -3,14 +3,34 @@
 // Main AgentCpp header - includes all necessary components
 
 // Core components
+#include "core/connection_pool.hpp"
+#include "core/event_loop.hpp"
 #include "core/http_client.hpp"
+#include "core/json_writer.hpp"
+#include "core/metrics.hpp"
+#include "core/prometheus.hpp"
+#include "core/rate_limiter.hpp"
 #include "core/response.hpp"
+#include "core/sse_parser.hpp"
 #include "core/streaming.hpp"
+#include "core/tracing.hpp"
 #include "core/types.hpp"
 
+// Корутинный API, сборка с ENABLE_COROUTINES
+#ifdef AGENTIXX_COROUTINES
+#include "core/async_stream.hpp"
+#include "core/task.hpp"
+#endif
+
 // LLM adapters
+#include "llm/caching_adapter.hpp"
+#include "llm/coalescing_adapter.hpp"
+#include "llm/conversation.hpp"
+#include "llm/disk_cache.hpp"
+#include "llm/jsonl_runner.hpp"
 #include "llm/llm_interface.hpp"
 #include "llm/openai_adapter.hpp"
+#include "llm/routing_adapter.hpp"
 
 // Main namespace
 namespace agentixx {
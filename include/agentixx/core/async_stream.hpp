@@ -0,0 +1,121 @@
+#pragma once
+
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "streaming.hpp"
+#include "task.hpp"
+
+namespace agentixx {
+
+// Живой поток chunks для корутин. В C++20 нет for co_await, поэтому
+// чтение - цикл по co_await Next():
+//
+//   AsyncStream stream = adapter.ChatStreamAsync(messages);
+//   while (auto chunk = co_await stream.Next()) {
+//     std::cout << chunk->text();
+//   }
+//
+// Пока chunk нет, корутина приостановлена и не занимает поток. Она
+// продолжается в I/O потоке, который принял chunk. Ошибка API или сети
+// выбрасывается из co_await Next(). Уничтожение недочитанного потока
+// прерывает передачу.
+class AsyncStream {
+ public:
+  class NextAwaiter {
+   public:
+    explicit NextAwaiter(AsyncStream* stream) : stream_(stream) {}
+
+    bool await_ready() {
+      state_ = Fetch(nullptr);
+      return state_ != StreamChannel::Poll::kPending;
+    }
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+      // После kPending корутину может продолжить другой поток, поэтому
+      // awaiter больше не трогаем
+      StreamChannel::Poll state = Fetch([awaiting] { awaiting.resume(); });
+      if (state == StreamChannel::Poll::kPending) {
+        return true;
+      }
+      state_ = state;
+      return false;
+    }
+    std::optional<StreamChunk> await_resume() {
+      if (state_ == StreamChannel::Poll::kPending) {
+        state_ = Fetch(nullptr);
+      }
+      if (state_ == StreamChannel::Poll::kReady) {
+        return std::move(chunk_);
+      }
+      return std::nullopt;
+    }
+
+   private:
+    AsyncStream* stream_;
+    StreamChunk chunk_;
+    StreamChannel::Poll state_ = StreamChannel::Poll::kPending;
+
+    StreamChannel::Poll Fetch(std::function<void()> on_ready) {
+      if (!stream_->channel_ || stream_->finished_) {
+        return StreamChannel::Poll::kDone;
+      }
+      StreamChannel::Poll state;
+      try {
+        state = stream_->channel_->TryNext(&chunk_, std::move(on_ready));
+      } catch (...) {
+        stream_->finished_ = true;
+        throw;
+      }
+      if (state == StreamChannel::Poll::kDone) {
+        stream_->finished_ = true;
+      }
+      return state;
+    }
+  };
+
+  AsyncStream() = default;
+  explicit AsyncStream(std::shared_ptr<StreamChannel> channel)
+      : channel_(std::move(channel)) {}
+  AsyncStream(AsyncStream&& other) noexcept
+      : channel_(std::move(other.channel_)),
+        finished_(std::exchange(other.finished_, true)) {}
+  AsyncStream& operator=(AsyncStream&& other) noexcept {
+    if (this != &other) {
+      Cancel();
+      channel_ = std::move(other.channel_);
+      finished_ = std::exchange(other.finished_, true);
+    }
+    return *this;
+  }
+  ~AsyncStream() { Cancel(); }
+
+  // Следующий chunk, std::nullopt - поток завершен
+  NextAwaiter Next() { return NextAwaiter(this); }
+
+  // Дочитать поток и вернуть текст оставшихся chunks
+  Task<std::string> Text() {
+    std::string text;
+    while (auto chunk = co_await Next()) {
+      text += chunk->content;
+    }
+    co_return text;
+  }
+
+  bool finished() const { return finished_; }
+
+ private:
+  std::shared_ptr<StreamChannel> channel_;
+  bool finished_ = false;
+
+  void Cancel() {
+    if (channel_ && !finished_) {
+      channel_->Cancel();
+    }
+  }
+};
+
+}  // namespace agentixx
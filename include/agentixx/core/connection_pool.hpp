@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace agentixx {
+
+// Настройки пула соединений
+struct ConnectionPoolOptions {
+  // Максимум одновременно арендованных CURL handles на один host,
+  // 0 - без ограничения. Запросы сверх лимита ждут свободный handle
+  size_t max_connections_per_host = 0;
+  // Сколько простаивающих keep-alive handles хранить на host. Лишние
+  // закрываются при возврате в пул
+  size_t max_idle_per_host = 8;
+  // Простаивающее keep-alive соединение закрывается после этого времени
+  int idle_timeout_ms = 60000;
+  // Максимальный возраст соединения, 0 - без ограничения
+  int max_connection_age_ms = 0;
+
+  void SetMaxConnectionsPerHost(size_t max) { max_connections_per_host = max; }
+  void SetMaxIdlePerHost(size_t max) { max_idle_per_host = max; }
+  void SetIdleTimeout(int timeout) { idle_timeout_ms = timeout; }
+  void SetMaxConnectionAge(int age) { max_connection_age_ms = age; }
+};
+
+// Потокобезопасный пул keep-alive соединений.
+//
+// Один пул можно разделить между несколькими HttpClient/OpenAIAdapter через
+// Config::SetConnectionPool. Пул хранит "теплые" CURL handles по host-ам
+// (вместе с их открытыми соединениями) и общий curl share handle с DNS
+// кэшем и TLS сессиями, поэтому повторные запросы не платят за TCP и TLS
+// handshake.
+//
+// Асинхронные, streaming и HTTP/2 запросы клиентов пула идут через общий
+// EventLoop пула. Его передачи используют те же DNS кэш и TLS сессии, а
+// открытые соединения живут в кэше curl_multi цикла и общие для всех
+// клиентов пула. С блокирующими запросами эти соединения не делятся.
+// Если в Config задан собственный event_loop, пул его не настраивает.
+//
+// Каждый блокирующий запрос арендует handle на все время передачи. По
+// умолчанию число аренд не ограничено: 16 потоков к одному host получат
+// 16 handles, а после пиковой нагрузки в пуле останется не больше
+// max_idle_per_host из них. Лимит max_connections_per_host включает
+// ожидание: запросы сверх него блокируются до возврата handle.
+class ConnectionPool {
+ private:
+  friend class HttpClient;
+
+  class Impl;  // PIMPL идиома для скрытия libcurl деталей
+  std::unique_ptr<Impl> pimpl_;
+
+ public:
+  // Статистика пула
+  struct Stats {
+    size_t leased = 0;   // Handles, выданные прямо сейчас
+    size_t idle = 0;     // Простаивающие handles с открытыми соединениями
+    size_t created = 0;  // Всего создано handles
+    size_t reused = 0;   // Сколько раз выдан уже прогретый handle
+    size_t evicted = 0;  // Закрыто по таймауту, ошибке или сверх лимита
+  };
+
+  explicit ConnectionPool(const ConnectionPoolOptions& options = {});
+  ~ConnectionPool();
+
+  // Disable copying and moving, пул разделяется через std::shared_ptr
+  ConnectionPool(const ConnectionPool&) = delete;
+  ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+  // Закрыть соединения, простаивающие дольше idle_timeout_ms
+  void EvictIdle();
+
+  Stats GetStats() const;
+  const ConnectionPoolOptions& options() const;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "streaming.hpp"
+#include "types.hpp"
+
+namespace agentixx {
+
+class CurlShare;
+
+// Настройки I/O цикла
+struct EventLoopOptions {
+  // Лимит соединений на host, 0 - без ограничения
+  size_t max_connections_per_host = 0;
+  // Общий лимит открытых соединений, 0 - без ограничения
+  size_t max_total_connections = 0;
+  // Максимум параллельных HTTP/2 потоков в одном соединении
+  size_t max_concurrent_streams = 100;
+};
+
+// Неблокирующий движок HTTP запросов на curl_multi.
+//
+// Один I/O поток ведет все запросы, отправленные в цикл, поэтому
+// сотни запросов могут быть в полете одновременно без потока на каждый.
+// Методы можно вызывать из любого потока. Все callbacks вызываются в I/O
+// потоке и не должны блокироваться.
+class EventLoop {
+ private:
+  friend class ConnectionPool;
+
+  class Impl;  // PIMPL, разделяется с I/O потоком
+  std::shared_ptr<Impl> pimpl_;
+
+  // Цикл пула: передачи подключаются к его DNS кэшу и TLS сессиям
+  EventLoop(const EventLoopOptions& options, std::shared_ptr<CurlShare> share);
+
+ public:
+  using ResponseCallback = std::function<void(HttpResponse)>;
+  using ErrorCallback = std::function<void(std::exception_ptr)>;
+
+  explicit EventLoop(const EventLoopOptions& options = {});
+  // Останавливает I/O поток, незавершенные запросы получают NetworkError.
+  // Задачи Post и PostAfter, еще не выполненные к этому моменту, выполняются
+  // сразу, не дожидаясь срока
+  ~EventLoop();
+
+  // Disable copying and moving, цикл разделяется через std::shared_ptr
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  // Отправить запрос, результат через future
+  std::future<HttpResponse> Send(HttpRequest request);
+
+  // Отправить запрос, результат через callbacks
+  void Send(HttpRequest request, ResponseCallback on_response,
+            ErrorCallback on_error);
+
+  // Отправить streaming (SSE) запрос. Future завершается вместе с потоком:
+  // статус, заголовки и протокол ответа (без тела) или NetworkError/ApiError
+  std::future<HttpResponse> SendStream(
+      HttpRequest request, StreamCallback on_chunk,
+      std::function<void()> on_complete = nullptr,
+      StreamErrorCallback on_error = nullptr);
+
+  // Отправить streaming запрос в очередь потребителя. Передача ставится на
+  // паузу, пока очередь заполнена. Статус ответа приходит через
+  // StreamChannel::WaitStarted, ошибки - из StreamChannel::Next
+  void SendStream(HttpRequest request, std::shared_ptr<StreamChannel> channel);
+
+  // Выполнить задачу в I/O потоке. Остановленный цикл выбрасывает
+  // NetworkError, как и Send
+  void Post(std::function<void()> task);
+  // Выполнить задачу в I/O потоке не раньше чем через delay
+  void PostAfter(std::chrono::milliseconds delay, std::function<void()> task);
+
+  // Количество запросов в полете
+  size_t InFlight() const;
+};
+
+}  // namespace agentixx
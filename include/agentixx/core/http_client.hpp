@@ -1,14 +1,48 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 
+#include "event_loop.hpp"
 #include "streaming.hpp"
 #include "types.hpp"
 
 namespace agentixx {
 
+// Счетчики hedging запросов клиента
+struct HedgingStats {
+  uint64_t requests = 0;    // Запросов post/PostStream при включенном hedging
+  uint64_t hedged = 0;      // Из них отправлен дубль
+  uint64_t hedge_wins = 0;  // Дубль ответил раньше исходного запроса
+};
+
+// HTTP клиент поверх libcurl.
+//
+// Потокобезопасность: get/post можно вызывать одновременно из
+// нескольких потоков. Каждый вызов арендует отдельный CURL handle из пула
+// (Config::connection_pool или собственного пула клиента) и возвращает его
+// после запроса, поэтому потоки не делят handle и не ждут друг друга.
+// Ждать свободный handle приходится, только если задан
+// ConnectionPoolOptions::max_connections_per_host. Асинхронные и streaming
+// методы потокобезопасны всегда: они выполняются в EventLoop.
+//
+// При включенном Config::hedging post и PostStream идут через EventLoop и
+// дублируются по HedgingPolicy. PostStream в этом режиме возвращается
+// после первого chunk, а не после статуса ответа.
+//
+// С Config::rate_limiter каждый POST занимает место в лимите ключа
+// base_url + API key. Блокирующие методы ждут очереди в вызывающем
+// потоке, PostAsync и OpenStream возвращаются сразу, а запрос уходит,
+// когда до него дойдет очередь limiter.
+//
+// С Config::retry post, PostAsync и PostStream повторяют неудачные
+// попытки по RetryPolicy. Ответ с ошибкой после последней попытки
+// возвращается как есть. PostStream повторяет только ошибки до первого
+// chunk и в этом режиме возвращается после него. PostAsync ждет паузу
+// таймером EventLoop. OpenStream и PostStreamAsync не повторяются.
 class HttpClient {
  private:
   class Impl;  // PIMPL идиома для скрытия libcurl деталей
@@ -29,17 +63,43 @@ class HttpClient {
   HttpResponse post(const std::string& url, const std::string& body,
                     const Headers& headers = {});
 
+  // Неблокирующие HTTP методы, выполняются в EventLoop из Config
+  // (или в цикле пула). Callbacks вызываются в I/O потоке
+  std::future<HttpResponse> PostAsync(const std::string& url,
+                                      const std::string& body,
+                                      const Headers& headers = {});
+  void PostAsync(const std::string& url, const std::string& body,
+                 const Headers& headers,
+                 EventLoop::ResponseCallback on_response,
+                 EventLoop::ErrorCallback on_error);
+
   // Streaming HTTP методы
+  // Возвращается, как только получен статус ответа. Chunks читаются из
+  // StreamingResponse по мере прихода, ошибка API выбрасывается сразу
   StreamingResponse PostStream(const std::string& url, const std::string& body,
                                const Headers& headers = {});
-  void PostStreamAsync(const std::string& url, const std::string& body,
-                       const Headers& headers, StreamCallback on_chunk,
-                       std::function<void()> on_complete = nullptr,
-                       StreamErrorCallback on_error = nullptr);
+  // Возвращается сразу, не дожидаясь ответа. Ошибка API придет из
+  // StreamChannel::Next/TryNext. Для асинхронных потребителей
+  std::shared_ptr<StreamChannel> OpenStream(const std::string& url,
+                                            const std::string& body,
+                                            const Headers& headers = {});
+  // Возвращается сразу, chunks приходят в on_chunk из I/O потока.
+  // Future завершается вместе с потоком (статус, заголовки и протокол
+  // ответа) или содержит ошибку
+  std::future<HttpResponse> PostStreamAsync(
+      const std::string& url, const std::string& body, const Headers& headers,
+      StreamCallback on_chunk, std::function<void()> on_complete = nullptr,
+      StreamErrorCallback on_error = nullptr);
+
+  // Счетчики hedging, нули если он выключен
+  HedgingStats hedging_stats() const;
 
   // Установить базовую конфигурацию
   void SetTimeout(int timeout_ms);
   void SetDefaultHeaders(const Headers& headers);
+  // Писать метрики успешных ответов в metrics, nullptr - не писать.
+  // Задается до запросов
+  void SetMetrics(std::shared_ptr<EndpointMetrics> metrics);
 };
 
 }  // namespace agentixx
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace agentixx {
+
+// Потоковая запись JSON прямо в строку, без построения DOM.
+//
+// Пишет в конец переданного буфера, поэтому буфер можно переиспользовать
+// между запросами и не выделять память заново. Запятые и двоеточия
+// расставляются автоматически. Строки экранируются по RFC 8259,
+// некорректные UTF-8 последовательности заменяются на U+FFFD.
+// Вложенность ограничена 64 уровнями.
+class JsonWriter {
+ public:
+  explicit JsonWriter(std::string* out) : out_(out) {}
+
+  JsonWriter& BeginObject();
+  JsonWriter& EndObject();
+  JsonWriter& BeginArray();
+  JsonWriter& EndArray();
+
+  // Ключ следующего значения объекта
+  JsonWriter& Key(std::string_view key);
+
+  JsonWriter& String(std::string_view value);
+  JsonWriter& Int(int64_t value);
+  // NaN и бесконечности пишутся как null
+  JsonWriter& Double(double value);
+  JsonWriter& Bool(bool value);
+  JsonWriter& Null();
+
+  // Готовый JSON фрагмент (значение целиком), вставляется как есть
+  JsonWriter& Raw(std::string_view json);
+
+  // Дописать value в out в кавычках с экранированием
+  static void AppendString(std::string* out, std::string_view value);
+
+ private:
+  static constexpr int kMaxDepth = 64;
+
+  std::string* out_;
+  int depth_ = 0;
+  uint64_t has_items_ = 0;  // Бит уровня: в контейнере уже есть элементы
+  bool after_key_ = false;
+
+  // Разделитель перед очередным значением или ключом
+  void BeforeValue();
+  void Open(char bracket);
+  void Close(char bracket);
+};
+
+}  // namespace agentixx
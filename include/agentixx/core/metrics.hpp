@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace agentixx {
+
+// Гистограмма в стиле HDR без блокировок.
+//
+// Значения хранятся в тысячных долях (мс с точностью до мкс) в
+// логарифмических корзинах: каждая степень двойки делится на 32 линейные
+// подкорзины, поэтому перцентиль отличается от точного не больше чем на
+// ~3%. Record - несколько relaxed атомарных операций, без аллокаций;
+// чтение идет параллельно с записью и видит почти согласованный снимок.
+class Histogram {
+ public:
+  Histogram() = default;
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  // Записать значение >= 0. Больше ~1.1e9 записывается как максимум
+  void Record(double value) {
+    uint64_t units = 0;
+    if (value > 0) {
+      double scaled = value * kScale + 0.5;
+      units = scaled < kMaxUnits ? static_cast<uint64_t>(scaled) : kMaxUnits;
+    }
+    counts_[Index(units)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(units, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (units > max && !max_.compare_exchange_weak(
+                              max, units, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double sum() const;
+  double mean() const;
+  double max() const;
+  // Значение перцентиля q из [0, 1], 0 - нет записей
+  double Percentile(double q) const;
+  // Сколько значений не больше каждой из bounds (по возрастанию), в total
+  // - всего значений. Из одного снимка корзин, поэтому согласованы
+  std::vector<uint64_t> CumulativeCounts(const std::vector<double>& bounds,
+                                         uint64_t* total) const;
+
+ private:
+  static constexpr double kScale = 1000;
+  static constexpr int kSubBits = 5;
+  static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBits;
+  static constexpr int kMaxBits = 40;
+  static constexpr uint64_t kMaxUnits = (uint64_t{1} << kMaxBits) - 1;
+  static constexpr size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+  // Первые 2 * kSubBuckets значений - точные корзины, дальше корзина
+  // степени двойки msb делится на kSubBuckets частей
+  static size_t Index(uint64_t units) {
+    if (units < 2 * kSubBuckets) {
+      return static_cast<size_t>(units);
+    }
+    int msb = 63 - __builtin_clzll(units);
+    int shift = msb - kSubBits;
+    return static_cast<size_t>((shift + 1) * kSubBuckets +
+                               ((units >> shift) - kSubBuckets));
+  }
+  // Середина корзины index в тысячных долях
+  static uint64_t Middle(size_t index);
+
+  std::atomic<uint64_t> counts_[kBuckets] = {};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+// Счетчик без общей точки записи. Поток при первой записи получает свою
+// ячейку в отдельной cache line и дальше пишет только в нее, value()
+// складывает ячейки. Потоков больше kCells делят ячейки по кругу
+class Counter {
+ public:
+  Counter() = default;
+
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Add(uint64_t value = 1) {
+    cells_[ThreadCell()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+  uint64_t value() const;
+
+ private:
+  static constexpr size_t kCells = 16;
+
+  struct alignas(64) Cell {
+    std::atomic<uint64_t> value{0};
+  };
+
+  static size_t ThreadCell() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t cell =
+        next.fetch_add(1, std::memory_order_relaxed) % kCells;
+    return cell;
+  }
+
+  Cell cells_[kCells];
+};
+
+// Метрики запросов к одной модели на одном base_url. Задержки в мс,
+// tokens_per_second - в токенах в секунду. Гистограммы пишутся по
+// завершении успешных ответов, token_gap - по каждому токену потока.
+// Счетчики считают каждую HTTP попытку, включая повторы и дубли
+class EndpointMetrics {
+ public:
+  EndpointMetrics(const std::string& model, const std::string& base_url)
+      : model_(model), base_url_(base_url) {}
+
+  const std::string& model() const { return model_; }
+  const std::string& base_url() const { return base_url_; }
+
+  // Записать фазы запроса, а для потоков с токенами - ttft и темп
+  void Record(const RequestMetrics& metrics);
+
+  // Запрос завершен со статусом status_code, 0 - ошибка передачи.
+  // Статус вне 2xx считается ошибкой
+  void RecordStatus(int status_code) {
+    requests.Add();
+    if (status_code < 200 || status_code >= 300) {
+      size_t code = status_code > 0 && status_code < kStatusCodes
+                        ? static_cast<size_t>(status_code)
+                        : 0;
+      errors_[code].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  // Ошибки по статусу: пары (status_code, число), 0 - ошибки передачи
+  std::vector<std::pair<int, uint64_t>> errors() const;
+
+  // Запросов в полете
+  uint64_t in_flight() const {
+    uint64_t done = finished.value();
+    uint64_t sent = started.value();
+    return sent > done ? sent - done : 0;
+  }
+
+  Counter requests;  // Завершенных запросов, с ошибками
+  Counter started;   // Запросов передано libcurl
+  Counter finished;  // Из них завершено любым образом, включая отмену
+  Counter bytes_sent;      // Тела запросов
+  Counter bytes_received;  // Тела ответов
+  Counter prompt_tokens;   // Из usage ответов
+  Counter completion_tokens;
+
+  Histogram dns;
+  Histogram connect;
+  Histogram tls;
+  Histogram ttfb;
+  Histogram total;
+  Histogram ttft;
+  Histogram token_gap;
+  Histogram tokens_per_second;
+
+ private:
+  static constexpr int kStatusCodes = 600;
+
+  std::string model_;
+  std::string base_url_;
+  // Ошибки редки: общий счетчик на статус без разбиения по потокам
+  std::atomic<uint64_t> errors_[kStatusCodes] = {};
+};
+
+// Реестр EndpointMetrics по модели и base_url.
+//
+// Адаптер находит свои метрики один раз при создании, дальше запросы
+// пишут в гистограммы напрямую. Поиск тоже без блокировок: таблица с
+// открытой адресацией, записи добавляются CAS и не удаляются. Один реестр
+// разделяется между адаптерами через Config::SetMetricsRegistry
+class MetricsRegistry {
+ private:
+  class Impl;
+  std::unique_ptr<Impl> pimpl_;
+
+ public:
+  MetricsRegistry();
+  ~MetricsRegistry();
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  // Метрики пары model и base_url, создаются при первом обращении. Когда
+  // таблица заполнена, новая пара получает метрики вне реестра
+  std::shared_ptr<EndpointMetrics> Endpoint(const std::string& model,
+                                            const std::string& base_url);
+
+  // Все метрики реестра в порядке таблицы
+  std::vector<std::shared_ptr<EndpointMetrics>> Endpoints() const;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "metrics.hpp"
+
+namespace agentixx {
+
+// Настройки PrometheusExporter
+struct PrometheusOptions {
+  // Префикс имен метрик
+  std::string prefix = "agentixx";
+  // Границы корзин гистограмм задержек, секунды по возрастанию
+  std::vector<double> latency_buckets = {0.005, 0.01, 0.025, 0.05, 0.1,
+                                         0.25,  0.5,  1,     2.5,  5,
+                                         10,    30,   60,    120};
+  // Границы корзин темпа генерации, токены в секунду по возрастанию
+  std::vector<double> rate_buckets = {1, 5, 10, 20, 50, 100, 200, 500};
+
+  void SetPrefix(const std::string& value) { prefix = value; }
+  void SetLatencyBuckets(std::vector<double> bounds) {
+    latency_buckets = std::move(bounds);
+  }
+  void SetRateBuckets(std::vector<double> bounds) {
+    rate_buckets = std::move(bounds);
+  }
+};
+
+// Экспорт MetricsRegistry в текстовом формате Prometheus.
+//
+// Scrape складывает счетчики потоков и снимает гистограммы в момент
+// вызова: запросы пишут только в свои ячейки и не ждут экспорта. Метки -
+// model и base_url, у ошибок еще code (HTTP статус или "network").
+//
+// Listen поднимает минимальный HTTP сервер в отдельном потоке: GET
+// /metrics отдает Scrape, остальные пути - 404. Соединения обслуживаются
+// по одному, этого хватает для периодического опроса. Требует POSIX
+// сокетов.
+class PrometheusExporter {
+ private:
+  class Impl;
+  std::unique_ptr<Impl> pimpl_;
+
+ public:
+  explicit PrometheusExporter(std::shared_ptr<MetricsRegistry> registry,
+                              PrometheusOptions options = {});
+  // Останавливает HTTP сервер
+  ~PrometheusExporter();
+
+  PrometheusExporter(const PrometheusExporter&) = delete;
+  PrometheusExporter& operator=(const PrometheusExporter&) = delete;
+
+  // Текущие значения метрик в формате text/plain; version=0.0.4
+  std::string Scrape() const;
+
+  // Слушать address:port, port 0 - свободный порт. Возвращает порт.
+  // Выбрасывает AgentCppException, если сокет не открылся
+  int Listen(int port, const std::string& address = "127.0.0.1");
+  // Остановить HTTP сервер, если он запущен
+  void Stop();
+};
+
+}  // namespace agentixx
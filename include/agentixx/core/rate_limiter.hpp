@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "types.hpp"
+
+namespace agentixx {
+
+// Настройки RateLimiter
+struct RateLimitOptions {
+  // Лимиты на ключ (base_url + API key), 0 - не задан. Лимит из
+  // заголовков x-ratelimit-limit-* ответа API действует, если он ниже
+  // заданного или лимит не задан
+  double requests_per_minute = 0;
+  double tokens_per_minute = 0;
+  // Доля лимита, которую разрешено использовать: запас на запросы других
+  // процессов и неточность оценки токенов
+  double utilization = 0.95;
+  // Оценка токенов запроса: байты тела / chars_per_token плюс
+  // completion_tokens на ответ
+  double chars_per_token = 4;
+  double completion_tokens = 256;
+
+  void SetRequestsPerMinute(double limit) { requests_per_minute = limit; }
+  void SetTokensPerMinute(double limit) { tokens_per_minute = limit; }
+  void SetUtilization(double value) { utilization = value; }
+};
+
+// Клиентское ограничение частоты запросов к API (token bucket).
+//
+// Для каждого ключа два ведра: запросы в минуту и оценка токенов в
+// минуту. Запрос, не помещающийся в лимит, не отклоняется, а ждет в
+// очереди ключа (FIFO), поэтому поток запросов идет чуть ниже лимита, а не
+// колеблется через серии 429. Ведра подстраиваются под заголовки
+// x-ratelimit-limit-*, x-ratelimit-remaining-* и x-ratelimit-reset-*
+// ответов, а 429 останавливает ключ до Retry-After.
+//
+// Один limiter разделяется между потоками и адаптерами через
+// Config::SetRateLimiter; адаптеры с одинаковыми base_url и API key делят
+// одни ведра. Отложенные запросы отправляет собственный поток limiter.
+class RateLimiter {
+ private:
+  class Impl;  // PIMPL, разделяется с потоком очереди
+  std::shared_ptr<Impl> pimpl_;
+
+ public:
+  // Статистика limiter
+  struct Stats {
+    uint64_t granted = 0;    // Запросов пропущено
+    uint64_t delayed = 0;    // Из них ждали в очереди
+    uint64_t throttled = 0;  // Ответов 429
+    size_t queued = 0;       // Ждут в очереди прямо сейчас
+  };
+
+  explicit RateLimiter(const RateLimitOptions& options = {});
+  // Останавливает поток очереди
+  ~RateLimiter();
+
+  // Disable copying and moving, limiter разделяется через std::shared_ptr
+  RateLimiter(const RateLimiter&) = delete;
+  RateLimiter& operator=(const RateLimiter&) = delete;
+
+  // Ключ ведер для base_url и API key
+  static std::string Key(const std::string& base_url,
+                         const std::string& api_key);
+
+  // Оценка токенов запроса с телом body
+  double EstimateTokens(const std::string& body) const;
+
+  // Дождаться места в лимите ключа
+  void Acquire(const std::string& key, double tokens);
+  // Занять место без ожидания. false - лимит исчерпан или очередь не пуста
+  bool TryAcquire(const std::string& key, double tokens);
+  // Вызвать grant, когда запрос поместится в лимит: сразу в вызывающем
+  // потоке или позже в потоке очереди. grant не должен блокироваться
+  void Enqueue(const std::string& key, double tokens,
+               std::function<void()> grant);
+
+  // Учесть статус и заголовки ответа API
+  void Update(const std::string& key, int status_code,
+              const Headers& headers);
+
+  Stats GetStats() const;
+};
+
+}  // namespace agentixx
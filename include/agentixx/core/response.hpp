@@ -13,6 +13,7 @@ class Response {
   Json raw_data_;
   bool has_error_;
   std::string error_message_;
+  RequestMetrics metrics_;
 
  public:
   // Конструкторы
@@ -64,6 +65,10 @@ class Response {
   bool has(const std::string& key) const {
     return !has_error_ && raw_data_.contains(key);
   }
+
+  // Время HTTP запроса, который вернул ответ
+  const RequestMetrics& metrics() const { return metrics_; }
+  void SetMetrics(const RequestMetrics& metrics) { metrics_ = metrics; }
 };
 
 }  // namespace agentixx
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agentixx {
+
+// Событие Server-Sent Events. Views действительны только внутри callback
+struct SseEvent {
+  std::string_view type;  // Поле event:, по умолчанию "message"
+  std::string_view data;  // Строки data: через '\n'
+  std::string_view id;    // Последний id: потока
+};
+
+// Инкрементальный парсер Server-Sent Events по спецификации WHATWG HTML.
+//
+// Принимает данные произвольными кусками (как их отдает libcurl) и
+// вызывает callback на каждое завершенное пустой строкой событие.
+// Поддерживаются event:, id:, retry:, многострочный data:, комментарии
+// и окончания строк CRLF, LF и CR. Данные не копируются: строки, целиком
+// попавшие в кусок, разбираются через string_view прямо во входном буфере.
+// Копируется только хвост незавершенной строки и данные события, которое
+// переходит в следующий кусок. Внутренние буферы переиспользуются.
+// Окончания строк ищутся векторно по всему куску сразу (SSE2/AVX2 по
+// возможностям процессора).
+class SseParser {
+ public:
+  using EventHandler = std::function<void(const SseEvent&)>;
+
+  SseParser() = default;
+
+  // Разобрать очередной кусок потока
+  void Feed(std::string_view input, const EventHandler& on_event);
+
+  // Сбросить состояние. Незавершенное событие отбрасывается,
+  // как требует спецификация для конца потока
+  void Reset();
+
+  // Задержка переподключения из последнего корректного retry:
+  std::optional<long> retry_ms() const { return retry_ms_; }
+  const std::string& last_event_id() const { return last_event_id_; }
+
+ private:
+  std::string carry_;  // Незавершенная строка из предыдущего куска
+  std::vector<uint32_t> line_ends_;  // Окончания строк текущего окна
+  bool pending_cr_ = false;  // Кусок кончился на CR, LF может быть следующим
+  bool started_ = false;     // BOM уже проверен
+
+  // Данные текущего события: view во входной кусок или в data_buffer_
+  std::string_view data_;
+  std::string data_buffer_;
+  bool data_in_buffer_ = false;
+  size_t data_lines_ = 0;
+
+  std::string event_type_;
+  std::string last_event_id_;
+  std::optional<long> retry_ms_;
+
+  void ProcessLine(std::string_view line, const EventHandler& on_event);
+  void ProcessField(std::string_view field, std::string_view value);
+  void AppendData(std::string_view value);
+  void Dispatch(const EventHandler& on_event);
+  // Перенести данные события во внутренний буфер, пока входной кусок жив
+  void Materialize();
+};
+
+}  // namespace agentixx
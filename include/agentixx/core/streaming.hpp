@@ -1,9 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "response.hpp"
@@ -11,86 +18,251 @@
 
 namespace agentixx {
 
+// Фрагмент вызова инструмента из delta.tool_calls. Вызов приходит по
+// частям: id и name в первом фрагменте, arguments - кусками JSON строки
+struct ToolCallDelta {
+  int index = 0;  // Номер вызова, по нему склеиваются фрагменты
+  std::string id;
+  std::string name;
+  std::string arguments;
+};
+
+// Расход токенов, приходит в последнем chunk при
+// stream_options.include_usage
+struct TokenUsage {
+  long prompt_tokens = 0;
+  long completion_tokens = 0;
+  long total_tokens = 0;
+};
+
 // Chunk данных в потоке
 struct StreamChunk {
   std::string content;   // Текстовое содержимое chunk
-  Json raw_data;         // Сырые данные chunk
   bool is_done = false;  // Признак завершения потока
+  int choice_index = 0;  // choices[].index первого варианта в chunk
+  std::optional<std::string> finish_reason;
+  std::vector<ToolCallDelta> tool_calls;
+  std::optional<TokenUsage> usage;
 
   StreamChunk() = default;
   StreamChunk(const std::string& text) : content(text) {}
-  StreamChunk(const Json& data) : raw_data(data) {
-    // Извлекаем контент из delta
-    if (data.contains("choices") && data["choices"].is_array() &&
-        !data["choices"].empty()) {
-      const auto& choice = data["choices"][0];
-      if (choice.contains("delta") && choice["delta"].contains("content")) {
-        content = choice["delta"]["content"].get<std::string>();
-      }
-    }
-  }
+  StreamChunk(const Json& data);
+
+  // Chunk из JSON события SSE. Поля извлекаются прямо из байтов без
+  // построения DOM, он строится только при вызове raw().
+  // Выбрасывает ParseError для некорректного JSON
+  static StreamChunk FromJson(std::string_view json);
 
   // Получить текст chunk
   const std::string& text() const { return content; }
 
-  // Получить сырые данные
-  const Json& raw() const { return raw_data; }
+  // Получить сырые данные. DOM строится при первом вызове, поэтому
+  // один chunk нельзя читать через raw() из нескольких потоков сразу
+  const Json& raw() const;
 
   // Проверить завершение
   bool done() const { return is_done; }
+
+  // Примерный объем памяти chunk, для учета в кэшах
+  size_t ByteSize() const;
+
+ private:
+  std::string raw_json_;  // Исходный JSON, если DOM еще не построен
+  mutable Json raw_data_;
+  mutable bool has_raw_data_ = false;
 };
 
 // Callback типы для streaming
 using StreamCallback = std::function<void(const StreamChunk&)>;
 using StreamErrorCallback = std::function<void(const std::string&)>;
 
-// Класс для работы с потоковыми ответами
+// Ограниченная очередь chunks между I/O потоком (producer) и
+// потребителем StreamingResponse (consumer).
+//
+// Кольцевой буфер без блокировок на одного producer и одного consumer.
+// Mutex нужен только чтобы усыпить consumer на пустой очереди. Когда
+// очередь заполнена, Push отказывает, и producer приостанавливает передачу
+// до вызова on_space: так память потока ограничена емкостью очереди.
+class StreamChannel {
+ private:
+  std::vector<StreamChunk> slots_;
+  std::atomic<size_t> head_{0};  // Следующий chunk для consumer
+  std::atomic<size_t> tail_{0};  // Следующий свободный слот для producer
+  std::atomic<bool> blocked_{false};  // Push отказал, producer ждет места
+  std::atomic<bool> waiting_{false};  // Consumer спит на condvar
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> cancelled_{false};
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool started_ = false;
+  HttpResponse info_;
+  std::exception_ptr error_;
+  std::function<void()> on_space_;
+  std::function<void()> on_ready_;  // Асинхронный consumer ждет данных
+
+  void WakeConsumer();
+  void NotifySpace();
+
+ public:
+  explicit StreamChannel(size_t capacity = 256);
+
+  // Disable copying, очередь разделяется через std::shared_ptr
+  StreamChannel(const StreamChannel&) = delete;
+  StreamChannel& operator=(const StreamChannel&) = delete;
+
+  // Методы producer
+
+  // Положить chunk. false - очередь заполнена и chunk не перемещен,
+  // on_space будет вызван, когда consumer освободит место
+  bool Push(StreamChunk&& chunk);
+  // Статус, заголовки и протокол получены, поток начался
+  void Start(const HttpResponse& info);
+  // Поток завершен: нормально или с ошибкой, которую получит consumer
+  // после уже принятых chunks
+  void Close(std::exception_ptr error = nullptr);
+  // Метрики потока: время до первого токена и, перед Close, итоговые
+  void SetMetrics(const RequestMetrics& metrics);
+  // Вызывается в потоке consumer, когда после отказа Push появилось место
+  // или consumer отказался от потока. Сбрасывается в Close и Cancel
+  void SetOnSpace(std::function<void()> on_space);
+
+  // Методы consumer
+
+  // Дождаться начала потока. Выбрасывает ошибку, если поток завершился
+  // с ошибкой до первых данных
+  HttpResponse WaitStarted();
+  // Следующий chunk, блокируется пока очередь пуста. false - поток
+  // завершен, ошибка потока выбрасывается
+  bool Next(StreamChunk* chunk);
+  // Отказаться от потока: producer прервет передачу
+  void Cancel();
+  // Метрики из Start и последнего SetMetrics
+  RequestMetrics metrics();
+
+  // Результат неблокирующего чтения
+  enum class Poll {
+    kReady,    // chunk получен
+    kPending,  // очередь пуста, поток еще идет
+    kDone,     // поток завершен
+  };
+  // Неблокирующая версия Next для асинхронного consumer. При kPending и
+  // непустом on_ready он будет вызван один раз в потоке producer, когда
+  // появится chunk или поток завершится. Ошибка потока выбрасывается
+  Poll TryNext(StreamChunk* chunk, std::function<void()> on_ready = nullptr);
+
+  bool cancelled() const { return cancelled_.load(); }
+  size_t capacity() const { return slots_.size(); }
+};
+
+// Класс для работы с потоковыми ответами.
+//
+// Живой ответ (из HttpClient::PostStream) читает chunks из StreamChannel по
+// мере прихода: итератор блокируется на следующем chunk, пока передача еще
+// идет. full_text() и chunks() дочитывают поток до конца. Ответ без канала
+// заполняется через AddChunk/finish. Копии разделяют один поток и должны
+// читаться из одного потока; уничтожение последней копии до конца потока
+// прерывает передачу.
+//
+// StreamRetention ограничивает, что остается в памяти после чтения: при
+// TextOnly/None/Ring память ответа не растет с длиной генерации.
 class StreamingResponse {
  private:
-  std::vector<StreamChunk> chunks_;
-  size_t current_index_ = 0;
-  bool is_complete_ = false;
-  std::string accumulated_text_;
+  struct State {
+    // При ограниченном хранении - кольцо, start - слот самого старого chunk
+    std::vector<StreamChunk> chunks;
+    size_t start = 0;
+    size_t total = 0;  // Сколько chunks прочитано за все время
+    StreamRetention retention;
+    bool is_complete = false;
+    std::string accumulated_text;
+    std::string protocol;
+    std::shared_ptr<StreamChannel> channel;  // nullptr - буферизованный ответ
+    std::function<bool(StreamChunk*)> source;  // Источник вместо канала
+    // Метрики источника, без него - метрики канала
+    std::function<RequestMetrics()> metrics;
+    StreamCallback on_chunk;
+
+    ~State();
+    void Add(StreamChunk chunk);
+    void Finish();
+    // Дочитать из канала chunk с номером index. false - поток кончился
+    bool Fetch(size_t index);
+    // Дочитать поток до конца
+    void Drain() { Fetch(kEnd - 1); }
+    // Chunk с номером index, nullptr - уже вытеснен из кольца
+    const StreamChunk* At(size_t index) const;
+    // Упорядочить кольцо от старых к новым
+    void Linearize();
+  };
+  std::shared_ptr<State> state_;
+
+  static constexpr size_t kEnd = static_cast<size_t>(-1);
 
  public:
   // Конструктор
-  StreamingResponse() = default;
+  StreamingResponse();
+  explicit StreamingResponse(StreamRetention retention);
+  // Живой ответ, chunks читаются из канала
+  explicit StreamingResponse(std::shared_ptr<StreamChannel> channel,
+                             StreamRetention retention = {});
+  // Живой ответ из произвольного источника: source отдает следующий chunk
+  // или false в конце потока, блокируется, пока chunk нет, и выбрасывает
+  // ошибку потока. Вызывается в потоке читателя
+  explicit StreamingResponse(std::function<bool(StreamChunk*)> source,
+                             StreamRetention retention = {});
 
   // Добавить chunk
-  void AddChunk(const StreamChunk& chunk) {
-    chunks_.push_back(chunk);
-    if (!chunk.is_done) {
-      accumulated_text_ += chunk.content;
-    } else {
-      is_complete_ = true;
-    }
-  }
+  void AddChunk(const StreamChunk& chunk) { state_->Add(chunk); }
 
   // Завершить поток
-  void finish() {
-    is_complete_ = true;
-    if (chunks_.empty() || !chunks_.back().is_done) {
-      StreamChunk done_chunk;
-      done_chunk.is_done = true;
-      chunks_.push_back(done_chunk);
-    }
-  }
+  void finish() { state_->Finish(); }
 
-  // Получить полный накопленный текст
-  std::string full_text() const { return accumulated_text_; }
+  // Получить полный накопленный текст, дожидаясь конца потока.
+  // Пустой, если StreamRetention не хранит текст
+  std::string full_text() const;
 
-  // Проверить завершение
-  bool IsComplete() const { return is_complete_; }
+  // Проверить завершение, не блокируется
+  bool IsComplete() const { return state_->is_complete; }
 
-  // Получить все chunks
-  const std::vector<StreamChunk>& chunks() const { return chunks_; }
+  // Получить сохраненные chunks, дожидаясь конца потока
+  const std::vector<StreamChunk>& chunks() const;
 
-  // Iterator для range-based for loops
+  // Сменить политику хранения. Действует на chunks, прочитанные после
+  // вызова, уже сохраненные сверх новой емкости отбрасываются
+  void SetRetention(StreamRetention retention);
+  const StreamRetention& retention() const { return state_->retention; }
+
+  // Наблюдатель за каждым прочитанным chunk, включая завершающий done().
+  // Вызывается в потоке читателя независимо от StreamRetention, поэтому
+  // видит весь поток, даже если ответ его не хранит
+  void SetOnChunk(StreamCallback on_chunk) {
+    state_->on_chunk = std::move(on_chunk);
+  }
+
+  // Согласованный протокол потока: "HTTP/1.1", "HTTP/2", ...
+  const std::string& protocol() const { return state_->protocol; }
+  void SetProtocol(const std::string& protocol) { state_->protocol = protocol; }
+
+  // Метрики живого потока. Фазы соединения известны с начала потока,
+  // время до первого токена - с первым токеном, темп генерации и общее
+  // время - после конца потока. Пустые для ответа без канала и источника
+  // метрик
+  RequestMetrics metrics() const;
+  // Откуда брать метрики ответа из произвольного источника
+  void SetMetricsSource(std::function<RequestMetrics()> metrics) {
+    state_->metrics = std::move(metrics);
+  }
+
+  // Iterator для range-based for loops. Разыменование и сравнение с end()
+  // ждут следующий chunk живого потока
   class iterator {
    private:
-    const StreamingResponse* response_;
+    State* state_;
     size_t index_;
 
+    bool AtEnd() const { return index_ == kEnd || !state_->Fetch(index_); }
+
    public:
     using iterator_category = std::input_iterator_tag;
     using value_type = StreamChunk;
@@ -98,11 +270,17 @@ class StreamingResponse {
     using pointer = const StreamChunk*;
     using reference = const StreamChunk&;
 
-    iterator(const StreamingResponse* resp, size_t idx)
-        : response_(resp), index_(idx) {}
+    iterator(State* state, size_t idx) : state_(state), index_(idx) {}
 
-    reference operator*() const { return response_->chunks_[index_]; }
-    pointer operator->() const { return &response_->chunks_[index_]; }
+    reference operator*() const {
+      state_->Fetch(index_);
+      const StreamChunk* chunk = state_->At(index_);
+      if (!chunk) {
+        throw std::out_of_range("Stream chunk is no longer retained");
+      }
+      return *chunk;
+    }
+    pointer operator->() const { return &**this; }
 
     iterator& operator++() {
       ++index_;
@@ -115,14 +293,20 @@ class StreamingResponse {
     }
 
     bool operator==(const iterator& other) const {
-      return response_ == other.response_ && index_ == other.index_;
+      if (state_ != other.state_) {
+        return false;
+      }
+      if (index_ == kEnd || other.index_ == kEnd) {
+        return AtEnd() == other.AtEnd();
+      }
+      return index_ == other.index_;
     }
 
     bool operator!=(const iterator& other) const { return !(*this == other); }
   };
 
-  iterator begin() const { return iterator(this, 0); }
-  iterator end() const { return iterator(this, chunks_.size()); }
+  iterator begin() const { return iterator(state_.get(), 0); }
+  iterator end() const { return iterator(state_.get(), kEnd); }
 };
 
 // Streaming HTTP ответ с callback
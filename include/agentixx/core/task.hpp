@@ -0,0 +1,270 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace agentixx {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+  std::coroutine_handle<> continuation = std::noop_coroutine();
+  std::exception_ptr error;
+
+  // По завершении управление передается ожидающей корутине без роста стека
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      return handle.promise().continuation;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  std::optional<T> value;
+
+  Task<T> get_return_object();
+  template <typename U>
+  void return_value(U&& result) {
+    value.emplace(std::forward<U>(result));
+  }
+  T Take() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return std::move(*value);
+  }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object();
+  void return_void() const noexcept {}
+  void Take() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+}  // namespace detail
+
+// Ленивая корутина: тело начинает выполняться при co_await, результат или
+// исключение передаются ожидающему. Task владеет кадром корутины и
+// уничтожает его в деструкторе.
+//
+// Корутины агентов продолжаются там, где завершился ожидаемый запрос,
+// обычно в I/O потоке EventLoop. Тело корутины не должно блокироваться:
+// вместо Chat/ChatStream используйте ChatAsync/ChatStreamAsync.
+template <typename T>
+class Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() = default;
+  explicit Task(Handle handle) : handle_(handle) {}
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  bool valid() const { return static_cast<bool>(handle_); }
+
+  auto operator co_await() noexcept {
+    struct Awaiter {
+      Handle handle;
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() { return handle.promise().Take(); }
+    };
+    return Awaiter{handle_};
+  }
+
+ private:
+  Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+  return Task<void>(
+      std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Корутина, которая запускается сразу и сама освобождает свой кадр.
+// Исключения перехватывает вызывающий код
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <typename T>
+struct SyncWaitState {
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  bool done = false;
+  std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+  std::exception_ptr error;
+};
+
+template <typename T>
+DetachedTask RunSyncWait(Task<T>& task, SyncWaitState<T>& state) {
+  std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+  std::exception_ptr error;
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await task;
+      value.emplace(true);
+    } else {
+      value.emplace(co_await task);
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // Уведомление под mutex: после него SyncWait может вернуться и
+  // уничтожить state
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.value = std::move(value);
+  state.error = error;
+  state.done = true;
+  state.done_cv.notify_one();
+}
+
+struct WhenAllState {
+  std::atomic<size_t> remaining{0};
+  std::coroutine_handle<> continuation;
+
+  void Arrive() {
+    if (remaining.fetch_sub(1) == 1) {
+      continuation.resume();
+    }
+  }
+};
+
+template <typename T, typename Slot>
+DetachedTask RunWhenAll(Task<T>& task, Slot& slot, std::exception_ptr& error,
+                        WhenAllState& state) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await task;
+    } else {
+      slot.emplace(co_await task);
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  state.Arrive();
+}
+
+}  // namespace detail
+
+// Выполнить задачу и дождаться результата в текущем потоке. Точка входа
+// из обычного кода: main, тесты, рабочие потоки
+template <typename T>
+T SyncWait(Task<T> task) {
+  detail::SyncWaitState<T> state;
+  detail::RunSyncWait(task, state);
+
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.done_cv.wait(lock, [&] { return state.done; });
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+  if constexpr (!std::is_void_v<T>) {
+    return std::move(*state.value);
+  }
+}
+
+// Запустить задачи одновременно и дождаться всех. Результаты в порядке
+// задач. Если задачи бросили исключения, после завершения всех
+// выбрасывается первое по порядку
+template <typename T>
+Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> WhenAll(
+    std::vector<Task<T>> tasks) {
+  using Slot = std::optional<std::conditional_t<std::is_void_v<T>, bool, T>>;
+  std::vector<Slot> slots(tasks.size());
+  std::vector<std::exception_ptr> errors(tasks.size());
+  detail::WhenAllState state;
+
+  struct Awaiter {
+    std::vector<Task<T>>& tasks;
+    std::vector<Slot>& slots;
+    std::vector<std::exception_ptr>& errors;
+    detail::WhenAllState& state;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+      state.continuation = awaiting;
+      // Лишняя единица не дает завершиться, пока запускаются задачи
+      state.remaining.store(tasks.size() + 1);
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        detail::RunWhenAll(tasks[i], slots[i], errors[i], state);
+      }
+      return state.remaining.fetch_sub(1) != 1;
+    }
+    void await_resume() const noexcept {}
+  };
+  co_await Awaiter{tasks, slots, errors, state};
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  if constexpr (!std::is_void_v<T>) {
+    std::vector<T> results;
+    results.reserve(slots.size());
+    for (auto& slot : slots) {
+      results.push_back(std::move(*slot));
+    }
+    co_return results;
+  }
+}
+
+}  // namespace agentixx
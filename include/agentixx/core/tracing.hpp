@@ -0,0 +1,184 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace agentixx {
+
+// Завершенный span. Время - наносекунды Unix epoch, как в OTLP
+struct SpanRecord {
+  // Значения совпадают с SpanKind OTLP
+  enum class Kind : uint8_t { kInternal = 1, kClient = 3 };
+
+  // Имена - строковые литералы: span хранит указатель, а не копию
+  const char* name = "";
+  Kind kind = Kind::kInternal;
+  uint64_t trace_id_high = 0;
+  uint64_t trace_id_low = 0;
+  uint64_t span_id = 0;
+  uint64_t parent_id = 0;  // 0 - корень трассы
+  int64_t start_ns = 0;
+  int64_t end_ns = 0;
+  // Один числовой атрибут, nullptr - нет
+  const char* attribute = nullptr;
+  int64_t attribute_value = 0;
+};
+
+// Получатель spans. Export вызывается из Tracer::Flush: из фонового
+// потока Tracer или из потока, вызвавшего Flush, но не параллельно
+class SpanSink {
+ public:
+  virtual ~SpanSink() = default;
+  virtual void Export(const std::vector<SpanRecord>& spans) = 0;
+};
+
+// Запись spans в файл в формате OTLP/JSON: каждый Export дописывает одну
+// строку ExportTraceServiceRequest, как File Exporter OpenTelemetry.
+// Такой файл читает otelcol-contrib (receiver otlpjsonfile).
+// Выбрасывает AgentCppException, если файл не открылся
+class OtlpJsonFileSink : public SpanSink {
+ public:
+  explicit OtlpJsonFileSink(const std::string& path,
+                            const std::string& service_name = "agentixx");
+
+  OtlpJsonFileSink(const OtlpJsonFileSink&) = delete;
+  OtlpJsonFileSink& operator=(const OtlpJsonFileSink&) = delete;
+
+  void Export(const std::vector<SpanRecord>& spans) override;
+
+  // Одна строка ExportTraceServiceRequest без перевода строки
+  static std::string Serialize(const std::vector<SpanRecord>& spans,
+                               const std::string& service_name);
+
+ private:
+  std::mutex mutex_;
+  std::ofstream out_;
+  std::string service_name_;
+};
+
+// Настройки Tracer
+struct TracerOptions {
+  // Емкость кольцевого буфера, округляется вверх до степени двойки. Не
+  // выгруженные вовремя spans затираются новыми и считаются в dropped()
+  size_t capacity = 4096;
+  // Куда выгружать spans, nullptr - только Drain
+  std::shared_ptr<SpanSink> sink;
+  // Период фоновой выгрузки в sink, 0 - только явный Flush
+  std::chrono::milliseconds flush_interval{1000};
+
+  void SetCapacity(size_t value) { capacity = value; }
+  void SetSink(std::shared_ptr<SpanSink> value) { sink = std::move(value); }
+  void SetFlushInterval(std::chrono::milliseconds value) {
+    flush_interval = value;
+  }
+};
+
+// Сборщик spans.
+//
+// Запись span не блокирует и не аллоцирует: слот кольцевого буфера
+// выделяется fetch_add, запись защищена счетчиком версии слота (seqlock).
+// Вместе с двумя чтениями часов span стоит десятки наносекунд. Выгрузка
+// в sink идет отдельно, фоновым потоком или Flush, и копирует готовые
+// слоты; слоты, которые писатель успел затереть, пропускаются.
+//
+// Spans библиотеки пишутся только в сборке с ENABLE_TRACING, без нее
+// макросы AGENTIXX_TRACE_* не оставляют кода. Один Tracer разделяется
+// между адаптерами через Config::SetTracer
+class Tracer {
+ private:
+  class Impl;
+  std::unique_ptr<Impl> pimpl_;
+
+ public:
+  explicit Tracer(TracerOptions options = {});
+  // Останавливает фоновый поток и выгружает оставшиеся spans
+  ~Tracer();
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  // Записать завершенный span из любого потока
+  void Record(const SpanRecord& span);
+
+  // Забрать записанные с прошлого Drain spans в порядке записи
+  std::vector<SpanRecord> Drain();
+  // Drain и передать spans в sink
+  void Flush();
+
+  // Spans, затертых до выгрузки
+  uint64_t dropped() const;
+
+  // Текущее время, нс Unix epoch. Монотонно: steady_clock со сдвигом,
+  // снятым при старте процесса
+  static int64_t Now();
+  // Span текущего потока, invalid - вне spans
+  static TraceContext Current();
+  // Новый span в трассе parent, для invalid parent - в новой трассе
+  static TraceContext Child(const TraceContext& parent);
+};
+
+// Span на время области видимости. Становится текущим span потока, и
+// вложенные ScopedSpan, а также HTTP запросы клиента, привязываются к
+// нему. С tracer == nullptr ничего не делает
+class ScopedSpan {
+ public:
+  // Дочерний span текущего span потока
+  ScopedSpan(Tracer* tracer, const char* name) : tracer_(tracer) {
+    if (tracer_) {
+      Start(name, Tracer::Current());
+    }
+  }
+  // Дочерний span parent: продолжение трассы из другого потока
+  ScopedSpan(Tracer* tracer, const char* name, const TraceContext& parent)
+      : tracer_(tracer) {
+    if (tracer_) {
+      Start(name, parent);
+    }
+  }
+  ~ScopedSpan() {
+    if (tracer_) {
+      Finish();
+    }
+  }
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+  void SetAttribute(const char* name, int64_t value) {
+    span_.attribute = name;
+    span_.attribute_value = value;
+  }
+
+ private:
+  Tracer* tracer_;
+  SpanRecord span_;
+  TraceContext previous_;
+
+  void Start(const char* name, const TraceContext& parent);
+  void Finish();
+};
+
+}  // namespace agentixx
+
+// Span до конца блока. В сборке без ENABLE_TRACING аргументы не
+// вычисляются и кода не остается
+#ifdef AGENTIXX_TRACING
+#define AGENTIXX_TRACE_CONCAT_(a, b) a##b
+#define AGENTIXX_TRACE_VAR_(line) AGENTIXX_TRACE_CONCAT_(agentixx_span_, line)
+#define AGENTIXX_TRACE_SPAN(tracer, name)                                \
+  ::agentixx::ScopedSpan AGENTIXX_TRACE_VAR_(__LINE__)((tracer), (name))
+#define AGENTIXX_TRACE_CHILD_SPAN(tracer, name, parent)                  \
+  ::agentixx::ScopedSpan AGENTIXX_TRACE_VAR_(__LINE__)((tracer), (name), \
+                                                      (parent))
+#else
+#define AGENTIXX_TRACE_SPAN(tracer, name) static_cast<void>(0)
+#define AGENTIXX_TRACE_CHILD_SPAN(tracer, name, parent) static_cast<void>(0)
+#endif
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <map>
@@ -7,6 +10,7 @@
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace agentixx {
@@ -14,9 +18,110 @@ namespace agentixx {
 // JSON alias для удобства
 using Json = nlohmann::json;
 
+class ConnectionPool;
+class EndpointMetrics;
+class EventLoop;
+class MetricsRegistry;
+class RateLimiter;
+class Tracer;
+
 // Типы для HTTP
 using Headers = std::map<std::string, std::string>;
 
+// Версия HTTP протокола
+enum class HttpVersion {
+  kDefault,              // Выбор libcurl
+  kHttp1,                // Только HTTP/1.1
+  kHttp2,                // HTTP/2 через TLS (ALPN), с мультиплексированием
+  kHttp2PriorKnowledge,  // HTTP/2 без TLS (h2c), с мультиплексированием
+};
+
+// Что StreamingResponse хранит из прочитанного потока. Текущий chunk
+// итератора доступен всегда, остальное зависит от режима
+struct StreamRetention {
+  enum class Mode {
+    kAll,       // Все chunks и полный текст (по умолчанию)
+    kTextOnly,  // Полный текст и текущий chunk
+    kNone,      // Только текущий chunk
+    kRing,      // Последние ring_size chunks, без полного текста
+  };
+
+  Mode mode = Mode::kAll;
+  size_t ring_size = 0;
+
+  static StreamRetention All() { return {Mode::kAll, 0}; }
+  static StreamRetention TextOnly() { return {Mode::kTextOnly, 1}; }
+  static StreamRetention None() { return {Mode::kNone, 1}; }
+  static StreamRetention Ring(size_t size) {
+    return {Mode::kRing, size > 0 ? size : 1};
+  }
+
+  // Сколько последних chunks хранить, 0 - без ограничения
+  size_t capacity() const { return mode == Mode::kAll ? 0 : ring_size; }
+  bool keeps_text() const {
+    return mode == Mode::kAll || mode == Mode::kTextOnly;
+  }
+};
+
+// Дублирование медленных запросов (hedging).
+//
+// Если ответа (для потока - первого chunk) нет дольше percentile задержки
+// недавних запросов, отправляется второй такой же запрос. Побеждает тот,
+// что ответил первым, передача другого прерывается. Дубли получают не
+// больше budget от всех запросов, поэтому при общей деградации API
+// нагрузка растет не больше чем на эту долю
+struct HedgingPolicy {
+  // Перцентиль задержки, после которого уходит дубль, например 0.95.
+  // 0 - hedging выключен
+  double percentile = 0;
+  // Доля запросов, которым разрешен дубль
+  double budget = 0.05;
+  // Задержка, пока не набрано min_samples замеров
+  int initial_delay_ms = 1000;
+  // Задержка не меньше min_delay_ms
+  int min_delay_ms = 1;
+  // Перцентиль считается по window последним ответам
+  size_t window = 256;
+  size_t min_samples = 20;
+
+  bool enabled() const { return percentile > 0 && budget > 0; }
+};
+
+// Повтор неудачных запросов.
+//
+// Пауза перед повтором - экспоненциальный backoff с полным jitter:
+// случайная в [0, min(max_backoff_ms, initial_backoff_ms * multiplier^n)].
+// Если ответ содержит Retry-After, пауза берется из него. Повторы
+// прекращаются после max_attempts попыток или когда следующая не успевает
+// начаться до deadline_ms от первой
+struct RetryPolicy {
+  // Всего попыток, включая первую. 1 - без повторов
+  int max_attempts = 1;
+  int initial_backoff_ms = 500;
+  int max_backoff_ms = 30000;
+  double multiplier = 2;
+  // Общий срок всех попыток, 0 - без ограничения. Таймаут обычного
+  // запроса сокращается до оставшегося срока
+  int deadline_ms = 0;
+  // Какие ошибки повторяются
+  bool retry_rate_limited = true;    // 429
+  bool retry_server_errors = true;   // 408 и 5xx, кроме 501 и 505
+  bool retry_network_errors = true;  // NetworkError: соединение, таймаут
+
+  bool enabled() const { return max_attempts > 1; }
+  // Повторяется ли ответ со статусом status_code
+  bool Retryable(int status_code) const {
+    if (status_code == 429) {
+      return retry_rate_limited;
+    }
+    if (status_code == 408 ||
+        (status_code >= 500 && status_code != 501 && status_code != 505)) {
+      return retry_server_errors;
+    }
+    return false;
+  }
+};
+
 // Базовая конфигурация
 struct Config {
   std::string api_key;
@@ -25,12 +130,58 @@ struct Config {
   std::string project;
   int timeout_ms = 90000;
   Headers default_headers;
+  // HTTP/2: все запросы клиента идут через EventLoop и мультиплексируются
+  // в одно соединение на base_url
+  HttpVersion http_version = HttpVersion::kDefault;
+  // Общий пул keep-alive соединений и его I/O поток, nullptr - собственный
+  // пул клиента
+  std::shared_ptr<ConnectionPool> connection_pool;
+  // I/O поток для асинхронных запросов вместо цикла пула, nullptr - цикл
+  // пула. Запросы в таком цикле не используют DNS кэш и TLS сессии пула
+  std::shared_ptr<EventLoop> event_loop;
+  // Емкость очереди chunks живого потока. Когда потребитель отстает,
+  // передача приостанавливается, а не копит данные в памяти
+  size_t stream_queue_size = 256;
+  // Хранение прочитанных chunks. Для тысяч долгих потоков TextOnly/None/Ring
+  // держат память потока постоянной, независимо от длины генерации
+  StreamRetention stream_retention;
+  // Hedging запросов, по умолчанию выключен
+  HedgingPolicy hedging;
+  // Общий limiter частоты запросов, nullptr - без ограничения
+  std::shared_ptr<RateLimiter> rate_limiter;
+  // Повтор неудачных запросов, по умолчанию выключен
+  RetryPolicy retry;
+  // Гистограммы задержек по модели и base_url, nullptr - не собираются
+  std::shared_ptr<MetricsRegistry> metrics;
+  // Spans вызовов адаптера, nullptr - не пишутся. Работает в сборке с
+  // ENABLE_TRACING
+  std::shared_ptr<Tracer> tracer;
 
   void SetApiKey(const std::string& key) { api_key = key; }
   void SetBaseUrl(const std::string& url) { base_url = url; }
   void SetOrganization(const std::string& org) { organization = org; }
   void SetProject(const std::string& proj) { project = proj; }
   void SetTimeout(int timeout) { timeout_ms = timeout; }
+  void SetHttpVersion(HttpVersion version) { http_version = version; }
+  void SetConnectionPool(std::shared_ptr<ConnectionPool> pool) {
+    connection_pool = std::move(pool);
+  }
+  void SetEventLoop(std::shared_ptr<EventLoop> loop) {
+    event_loop = std::move(loop);
+  }
+  void SetStreamQueueSize(size_t size) { stream_queue_size = size; }
+  void SetStreamRetention(StreamRetention retention) {
+    stream_retention = retention;
+  }
+  void SetHedging(const HedgingPolicy& policy) { hedging = policy; }
+  void SetRateLimiter(std::shared_ptr<RateLimiter> limiter) {
+    rate_limiter = std::move(limiter);
+  }
+  void SetRetryPolicy(const RetryPolicy& policy) { retry = policy; }
+  void SetMetricsRegistry(std::shared_ptr<MetricsRegistry> registry) {
+    metrics = std::move(registry);
+  }
+  void SetTracer(std::shared_ptr<Tracer> value) { tracer = std::move(value); }
 
   // Загрузка конфигурации из переменных среды
   void UseEnv() {
@@ -46,11 +197,64 @@ struct Config {
   }
 };
 
+// Положение span в трассе: к нему привязываются дочерние spans
+struct TraceContext {
+  uint64_t trace_id_high = 0;
+  uint64_t trace_id_low = 0;
+  uint64_t span_id = 0;
+
+  bool valid() const { return (trace_id_high | trace_id_low) != 0; }
+};
+
+// Структура HTTP запроса
+struct HttpRequest {
+  std::string method = "POST";
+  std::string url;
+  std::string body;
+  Headers headers;
+  int timeout_ms = 90000;
+  HttpVersion http_version = HttpVersion::kDefault;
+  // Флаг отмены, nullptr - запрос не отменяется. Установленный флаг
+  // прерывает передачу с NetworkError
+  std::shared_ptr<const std::atomic<bool>> cancelled;
+  // Куда записать метрики успешного ответа, nullptr - никуда
+  std::shared_ptr<EndpointMetrics> metrics;
+  // Куда записать span запроса и его SSE событий, nullptr - никуда.
+  // trace - span вызывающего потока, родитель span запроса
+  std::shared_ptr<Tracer> tracer;
+  TraceContext trace;
+};
+
+// Время одного запроса. Фазы до первого байта - по таймерам libcurl. Для
+// потоков добавляются время до первого токена и темп генерации; токеном
+// считается chunk с текстом или tool_calls
+struct RequestMetrics {
+  // Момент передачи запроса libcurl
+  std::chrono::steady_clock::time_point start;
+  double dns_ms = 0;      // Разрешение имени
+  double connect_ms = 0;  // TCP соединение после разрешения имени
+  double tls_ms = 0;      // TLS handshake, 0 - без TLS или соединение не новое
+  double ttfb_ms = 0;     // От начала запроса до первого байта ответа
+  double total_ms = 0;    // От начала запроса до конца ответа
+  // Только потоки
+  double ttft_ms = 0;  // От начала запроса до первого токена
+  // completion_tokens из usage, если он пришел, иначе число токенов-chunks
+  long tokens = 0;
+  double mean_gap_ms = 0;  // Средний интервал между токенами
+  double max_gap_ms = 0;   // Самый долгий интервал между токенами
+  double tokens_per_second = 0;  // От первого до последнего токена
+};
+
 // Структура HTTP ответа
 struct HttpResponse {
   int status_code = 0;
   std::string body;
   Headers headers;
+  // Согласованный протокол: "HTTP/1.1", "HTTP/2", ...
+  std::string protocol;
+  // Запрос ушел по уже открытому соединению (keep-alive или HTTP/2 поток)
+  bool reused_connection = false;
+  RequestMetrics metrics;
   bool IsSuccess() const { return status_code >= 200 && status_code < 300; }
 };
 
@@ -73,10 +277,14 @@ class NetworkError : public AgentCppException {
 class ApiError : public AgentCppException {
  public:
   int status_code;
-  explicit ApiError(int code, const std::string& message)
+  // Заголовки ответа, если он был (Retry-After для повтора потока)
+  Headers headers;
+  explicit ApiError(int code, const std::string& message,
+                    Headers response_headers = {})
       : AgentCppException("API error (" + std::to_string(code) +
                           "): " + message),
-        status_code(code) {}
+        status_code(code),
+        headers(std::move(response_headers)) {}
 };
 
 class ParseError : public AgentCppException {
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "../core/response.hpp"
+
+namespace agentixx {
+
+// Результат одного запроса пакета
+struct BatchResult {
+  size_t index = 0;  // Позиция запроса во входном пакете
+  Response response;
+  // Ошибка этого запроса (NetworkError, ApiError, ParseError),
+  // nullptr - успех. Ошибка не прерывает остальной пакет
+  std::exception_ptr error;
+
+  bool ok() const { return error == nullptr; }
+
+  // Ответ или исключение запроса
+  const Response& value() const {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return response;
+  }
+};
+
+// Настройки ChatBatch
+struct BatchOptions {
+  // Сколько запросов пакета одновременно в полете
+  size_t max_in_flight = 16;
+  // Параметры генерации для всех запросов, по умолчанию - как у Chat
+  std::optional<double> temperature;
+  int max_tokens = -1;
+  // Вызывается по мере завершения запросов, в порядке завершения, в
+  // потоке, вызвавшем ChatBatch. Исключение из callback прекращает
+  // отправку новых запросов и выходит из ChatBatch
+  std::function<void(const BatchResult&)> on_result;
+
+  void SetMaxInFlight(size_t count) { max_in_flight = count > 0 ? count : 1; }
+  void SetTemperature(double value) { temperature = value; }
+  void SetMaxTokens(int tokens) { max_tokens = tokens; }
+  void SetOnResult(std::function<void(const BatchResult&)> callback) {
+    on_result = std::move(callback);
+  }
+};
+
+}  // namespace agentixx
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "disk_cache.hpp"
+#include "llm_interface.hpp"
+
+namespace agentixx {
+
+// Настройки CachingAdapter
+struct CacheOptions {
+  // Общий бюджет памяти ответов, делится поровну между сегментами
+  size_t max_bytes = 64 << 20;
+  // Время жизни записи, 0 - без ограничения
+  std::chrono::milliseconds ttl{0};
+  // Число сегментов со своим mutex и LRU списком
+  size_t shards = 16;
+  // Второй уровень на диске, nullptr - только память. Промах в памяти
+  // ищется на диске, новые ответы пишутся в оба уровня. Один DiskCache
+  // можно разделить между адаптерами и процессами
+  std::shared_ptr<DiskCache> disk;
+
+  void SetMaxBytes(size_t bytes) { max_bytes = bytes; }
+  void SetTtl(std::chrono::milliseconds value) { ttl = value; }
+  void SetShards(size_t count) { shards = count > 0 ? count : 1; }
+  void SetDiskCache(std::shared_ptr<DiskCache> cache) {
+    disk = std::move(cache);
+  }
+};
+
+// Счетчики кэша
+struct CacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t disk_hits = 0;  // Из hits найдено на диске
+  uint64_t evictions = 0;  // Вытеснено по бюджету или истекло по TTL
+  size_t entries = 0;
+  size_t bytes = 0;
+
+  double hit_rate() const {
+    uint64_t total = hits + misses;
+    return total > 0 ? static_cast<double>(hits) / total : 0.0;
+  }
+};
+
+// Кэш точных совпадений перед любым LLMInterface.
+//
+// Ключ - хеш канонического тела запроса: модель, вид запроса и сообщения
+// в том же JSON, что уходит в API. Совпадение проверяется по самому телу,
+// поэтому коллизия хеша не отдаст чужой ответ. Записи лежат в памяти в
+// сегментах с LRU вытеснением по бюджету байт и TTL, и, если задан
+// DiskCache, на диске между запусками.
+//
+// Потоковый ответ кэшируется, когда его дочитали до конца, и при попадании
+// воспроизводится теми же chunks. Ошибки и брошенные потоки не кэшируются.
+//
+// Кэш не знает параметров генерации обернутого адаптера, поэтому имеет
+// смысл для детерминированных запросов (temperature=0): повторы, регрессии,
+// одинаковые system prompt. Потокобезопасен, если потокобезопасен
+// обернутый адаптер.
+class CachingAdapter : public LLMInterface {
+ public:
+  // Без владения: inner должен пережить кэш
+  explicit CachingAdapter(LLMInterface& inner, CacheOptions options = {});
+  explicit CachingAdapter(std::unique_ptr<LLMInterface> inner,
+                          CacheOptions options = {});
+  ~CachingAdapter() override;
+
+  CachingAdapter(const CachingAdapter&) = delete;
+  CachingAdapter& operator=(const CachingAdapter&) = delete;
+
+  Response Complete(const std::string& prompt) override;
+  Response Chat(const std::vector<Message>& messages) override;
+  StreamingResponse CompleteStream(const std::string& prompt) override;
+  StreamingResponse ChatStream(const std::vector<Message>& messages) override;
+  // Попадания отдаются сразу, промахи уходят одним пакетом в inner
+  std::vector<BatchResult> ChatBatch(
+      const std::vector<std::vector<Message>>& batch,
+      const BatchOptions& options = {}) override;
+  std::string ModelName() const override;
+
+  CacheStats stats() const;
+  void Clear();
+
+  LLMInterface& inner() { return inner_; }
+
+ private:
+  class Impl;
+
+  std::unique_ptr<LLMInterface> owned_;
+  LLMInterface& inner_;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llm_interface.hpp"
+
+namespace agentixx {
+
+// Счетчики CoalescingAdapter
+struct CoalescingStats {
+  uint64_t requests = 0;   // Вызовов Complete/Chat и потоковых версий
+  uint64_t coalesced = 0;  // Из них присоединились к чужому запросу
+};
+
+// Объединение одинаковых одновременных запросов (single-flight).
+//
+// Пока запрос в полете, такой же запрос из другого потока не уходит в API,
+// а ждет результат первого: все получают тот же Response или то же
+// исключение. Ключ - каноническое тело запроса, как у CachingAdapter.
+// После завершения запроса следующий такой же снова идет в API; чтобы
+// повторы отдавались без запросов, CoalescingAdapter ставится под
+// CachingAdapter.
+//
+// Потоки раздаются подписчикам: каждый получает свой StreamingResponse с
+// той же последовательностью chunks с начала потока. Отдельного потока
+// выполнения нет: следующий chunk из API читает тот подписчик, которому он
+// нужен первым, остальные берут его из общего буфера. Поэтому поток идет
+// со скоростью самого быстрого читателя. Передача прерывается, когда от
+// потока отказались все подписчики.
+//
+// При StreamRetention::All() буфер держит chunks до конца потока, и
+// подписчик может присоединиться в любой момент. При остальных политиках
+// chunks, прочитанные всеми подписчиками, удаляются, и память потока не
+// зависит от длины генерации. Присоединиться к такому потоку можно, пока
+// его первый chunk еще в буфере; позже такой же запрос идет в API сам.
+//
+// ChatBatch передается в обернутый адаптер без объединения.
+class CoalescingAdapter : public LLMInterface {
+ public:
+  // Без владения: inner должен пережить адаптер
+  explicit CoalescingAdapter(LLMInterface& inner);
+  explicit CoalescingAdapter(std::unique_ptr<LLMInterface> inner);
+  ~CoalescingAdapter() override;
+
+  CoalescingAdapter(const CoalescingAdapter&) = delete;
+  CoalescingAdapter& operator=(const CoalescingAdapter&) = delete;
+
+  Response Complete(const std::string& prompt) override;
+  Response Chat(const std::vector<Message>& messages) override;
+  StreamingResponse CompleteStream(const std::string& prompt) override;
+  StreamingResponse ChatStream(const std::vector<Message>& messages) override;
+  std::vector<BatchResult> ChatBatch(
+      const std::vector<std::vector<Message>>& batch,
+      const BatchOptions& options = {}) override;
+  std::string ModelName() const override;
+
+  CoalescingStats stats() const;
+
+  LLMInterface& inner() { return inner_; }
+
+ private:
+  class Impl;
+
+  std::unique_ptr<LLMInterface> owned_;
+  LLMInterface& inner_;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llm_interface.hpp"
+
+namespace agentixx {
+
+// История сообщений чата вместе с ее готовым JSON представлением.
+//
+// В цикле агента история только растет: каждый ход добавляет пару
+// сообщений к предыдущим. Conversation сериализует сообщение один раз при
+// добавлении и хранит JSON массив всех сообщений, поэтому сборка запроса
+// стоит O(новых сообщений), а не O(всей истории). Адаптер вставляет
+// массив в тело запроса без повторного экранирования.
+//
+// Не потокобезопасен: один Conversation - один цикл агента.
+class Conversation {
+ public:
+  Conversation();
+
+  // Конструктора из std::vector нет: с ним Chat({{"user", "..."}}) был бы
+  // неоднозначен между перегрузками для vector и Conversation
+  static Conversation FromMessages(const std::vector<Message>& messages);
+
+  // Добавить сообщение в конец истории
+  void Add(Message message);
+  void Add(const std::string& role, const std::string& content);
+
+  // Оставить первые count сообщений, например чтобы откатить неудачный
+  // ход. JSON при этом не пересобирается
+  void Truncate(size_t count);
+  void Clear() { Truncate(0); }
+
+  const std::vector<Message>& messages() const { return messages_; }
+  const Message& operator[](size_t index) const { return messages_[index]; }
+  const Message& back() const { return messages_.back(); }
+  size_t size() const { return messages_.size(); }
+  bool empty() const { return messages_.empty(); }
+
+  // JSON массив сообщений в формате поля "messages": [{...},{...}]
+  std::string_view messages_json() const { return json_; }
+
+ private:
+  std::vector<Message> messages_;
+  std::string json_;  // Всегда закрытый массив
+  // json_.size() до добавления каждого сообщения, без закрывающей ']'
+  std::vector<size_t> offsets_;
+};
+
+}  // namespace agentixx
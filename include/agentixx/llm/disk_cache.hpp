@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace agentixx {
+
+// Настройки DiskCache
+struct DiskCacheOptions {
+  // Время жизни записи, 0 - без ограничения. Срок записывается вместе с
+  // записью, поэтому действует и для других процессов
+  std::chrono::seconds ttl{0};
+  // Только чтение: каталог не создается, Put игнорируется, блокировка
+  // писателя не берется
+  bool read_only = false;
+  // Автоматическое сжатие, когда мертвые записи занимают больше половины
+  // журнала и журнал больше этого размера. 0 - только вызовом Compact
+  uint64_t auto_compact_bytes = 64 << 20;
+
+  void SetTtl(std::chrono::seconds value) { ttl = value; }
+  void SetReadOnly(bool value) { read_only = value; }
+  void SetAutoCompactBytes(uint64_t bytes) { auto_compact_bytes = bytes; }
+};
+
+// Состояние DiskCache
+struct DiskCacheStats {
+  uint64_t entries = 0;
+  uint64_t log_bytes = 0;   // Размер журнала
+  uint64_t live_bytes = 0;  // Из них занято актуальными записями
+  uint64_t generation = 0;  // Номер журнала, растет при сжатии
+};
+
+// Персистентное хранилище ключ-значение для кэша ответов.
+//
+// Каталог содержит журнал записей data.<generation>.log, который только
+// дописывается, и индекс index - хеш-таблицу с открытой адресацией,
+// отображенную в память. Слот индекса - хеш ключа и смещение записи в
+// журнале. Поиск - несколько сравнений в отображенной таблице и одно
+// чтение записи, при запуске журнал не сканируется и ничего не
+// десериализуется. Запись в журнале содержит ключ и контрольную сумму,
+// поэтому коллизия хеша или оборванная запись дают промах, а не чужой
+// ответ.
+//
+// Несколько процессов могут читать кэш одновременно с писателем. Писатели
+// разных процессов сериализуются flock на файле lock. Слот публикуется
+// атомарной записью после того, как запись уже в журнале. Рост индекса и
+// сжатие строят новые файлы и подменяют их через rename, старый индекс
+// помечается устаревшим, и читатели переоткрывают файлы при следующем
+// поиске.
+//
+// Потокобезопасен. Требует POSIX (mmap, flock).
+class DiskCache {
+ public:
+  explicit DiskCache(const std::string& directory,
+                     DiskCacheOptions options = {});
+  ~DiskCache();
+
+  DiskCache(const DiskCache&) = delete;
+  DiskCache& operator=(const DiskCache&) = delete;
+
+  // Значение по ключу. std::nullopt - нет, истекло или повреждено
+  std::optional<std::string> Get(std::string_view key);
+  // Записать значение, заменяет прежнее значение ключа
+  void Put(std::string_view key, std::string_view value);
+  // Переписать журнал без замененных и истекших записей
+  void Compact();
+
+  DiskCacheStats stats();
+  const std::string& directory() const { return directory_; }
+
+ private:
+  class Impl;
+
+  std::string directory_;
+  std::unique_ptr<Impl> pimpl_;
+};
+
+}  // namespace agentixx
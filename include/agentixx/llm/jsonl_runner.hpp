@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "llm_interface.hpp"
+
+namespace agentixx {
+
+// Прогресс обработки JSONL файла
+struct JsonlProgress {
+  uint64_t lines = 0;      // Обработано строк, включая прошлые запуски
+  uint64_t succeeded = 0;  // Из них успешных ответов
+  uint64_t failed = 0;     // Ошибок API, сети или формата строки
+  uint64_t input_offset = 0;  // Байт входа записано в результат
+  uint64_t input_size = 0;
+  double elapsed_seconds = 0;    // Время текущего запуска
+  double lines_per_second = 0;   // Скорость текущего запуска
+  double bytes_per_second = 0;
+};
+
+// Настройки JsonlRunner
+struct JsonlRunOptions {
+  // Запросов в полете одновременно
+  size_t max_in_flight = 16;
+  // Строк в одном окне чтения, 0 - 8 * max_in_flight. Окно - единица
+  // памяти и checkpoint: в памяти держатся только строки текущего окна
+  size_t window = 0;
+  // Файл checkpoint, пустой - без возобновления
+  std::string checkpoint_path;
+  // Параметры генерации для всех строк
+  std::optional<double> temperature;
+  int max_tokens = -1;
+  // Отчет о прогрессе не чаще раза в progress_interval_ms и в конце
+  int progress_interval_ms = 1000;
+  std::function<void(const JsonlProgress&)> on_progress;
+
+  void SetMaxInFlight(size_t count) { max_in_flight = count > 0 ? count : 1; }
+  void SetWindow(size_t lines) { window = lines; }
+  void SetCheckpointPath(const std::string& path) { checkpoint_path = path; }
+  void SetTemperature(double value) { temperature = value; }
+  void SetMaxTokens(int tokens) { max_tokens = tokens; }
+  void SetOnProgress(std::function<void(const JsonlProgress&)> callback,
+                     int interval_ms = 1000) {
+    on_progress = std::move(callback);
+    progress_interval_ms = interval_ms;
+  }
+};
+
+// Прогон JSONL файла с чатами через LLM.
+//
+// Строка входа: {"id": ..., "messages": [{"role": ..., "content": ...}]}.
+// Формат OpenAI Batch API ({"custom_id": ..., "body": {"messages": ...}})
+// тоже принимается. Строка результата:
+//   {"id": ..., "line": N, "content": "...", "response": {...}}
+// или {"id": ..., "line": N, "error": "..."}. Без id во входе пишется
+// номер строки. Результаты идут в порядке входа.
+//
+// Вход читается кусками, файл целиком в память не загружается. Запросы
+// окна идут через LLMInterface::ChatBatch. После каждого окна результат
+// сбрасывается на диск и в checkpoint записываются смещение во входе и
+// размер результата. Повторный Run с тем же checkpoint обрезает результат
+// до записанного размера и продолжает со смещения, поэтому после сбоя
+// строки не теряются и не дублируются.
+class JsonlRunner {
+ public:
+  explicit JsonlRunner(LLMInterface& llm, JsonlRunOptions options = {});
+
+  // Обработать input_path в output_path (дописывается). Ошибки отдельных
+  // строк попадают в результат, исключение - только при ошибке файлов
+  JsonlProgress Run(const std::string& input_path,
+                    const std::string& output_path);
+
+ private:
+  LLMInterface& llm_;
+  JsonlRunOptions options_;
+};
+
+}  // namespace agentixx
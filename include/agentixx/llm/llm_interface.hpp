@@ -5,9 +5,11 @@
 #include <type_traits>
 #include <vector>
 
+#include "../core/json_writer.hpp"
 #include "../core/response.hpp"
 #include "../core/streaming.hpp"
 #include "../core/types.hpp"
+#include "batch.hpp"
 
 namespace agentixx {
 
@@ -22,6 +24,16 @@ struct Message {
   // Конвертация в JSON
   Json ToJson() const { return Json{{"role", role}, {"content", content}}; }
 
+  // Запись в JSON напрямую, без промежуточного Json
+  void WriteJson(JsonWriter& writer) const {
+    writer.BeginObject()
+        .Key("role")
+        .String(role)
+        .Key("content")
+        .String(content)
+        .EndObject();
+  }
+
   // Создание из JSON
   static Message FromJson(const Json& json) {
     return Message(json["role"], json["content"]);
@@ -49,6 +61,27 @@ class LLMInterface {
     throw std::runtime_error("Streaming chat not supported by this adapter");
   }
 
+  // Пакет chat запросов: результаты в порядке входа, ошибки по элементам.
+  // По умолчанию запросы выполняются по одному через Chat, temperature и
+  // max_tokens из options не применяются
+  virtual std::vector<BatchResult> ChatBatch(
+      const std::vector<std::vector<Message>>& batch,
+      const BatchOptions& options = {}) {
+    std::vector<BatchResult> results(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      results[i].index = i;
+      try {
+        results[i].response = Chat(batch[i]);
+      } catch (...) {
+        results[i].error = std::current_exception();
+      }
+      if (options.on_result) {
+        options.on_result(results[i]);
+      }
+    }
+    return results;
+  }
+
   // Получить информацию о модели
   virtual std::string ModelName() const = 0;
 };
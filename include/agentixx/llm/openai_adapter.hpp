@@ -3,15 +3,32 @@
 #include <memory>
 
 #include "../core/http_client.hpp"
+#ifdef AGENTIXX_COROUTINES
+#include "../core/async_stream.hpp"
+#include "../core/task.hpp"
+#endif
+#include "conversation.hpp"
 #include "llm_interface.hpp"
 
 namespace agentixx {
 
+// Адаптер для OpenAI-совместимых API.
+//
+// Один экземпляр можно использовать из N рабочих потоков одновременно:
+// все запросы идут через потокобезопасный HttpClient. Чтобы все N потоков
+// переиспользовали соединения, передайте пул с max_idle_per_host >= N
+// через Config::SetConnectionPool. SetModel не потокобезопасен и должен
+// вызываться до начала работы.
 class OpenAIAdapter : public LLMInterface {
  private:
   Config config_;
   std::unique_ptr<HttpClient> http_client_;
   std::string model_;
+  // Метрики модели в Config::metrics, nullptr - не собираются
+  std::shared_ptr<EndpointMetrics> metrics_;
+
+  // Метрики запросов в Config::metrics по модели и base_url
+  void BindMetrics();
 
   // Private methods for building requests
   Headers BuildHeaders() const;
@@ -22,7 +39,20 @@ class OpenAIAdapter : public LLMInterface {
   std::string BuildChatRequestWithOptions(const std::vector<Message>& messages,
                                           double temperature, int max_tokens,
                                           bool stream = false) const;
+  // Общая запись chat запроса через JsonWriter.
+  // temperature == nullptr - поле не передается
+  std::string BuildChatBody(const std::vector<Message>& messages,
+                            const double* temperature, int max_tokens,
+                            bool stream) const;
+  // То же с готовым JSON сообщений из Conversation
+  std::string BuildChatBody(const Conversation& conversation,
+                            const double* temperature, int max_tokens,
+                            bool stream) const;
   Response ParseOpenaiResponse(const HttpResponse& http_response) const;
+#ifdef AGENTIXX_COROUTINES
+  // url и body по значению: кадр корутины живет дольше аргументов вызова
+  Task<Response> PostTask(std::string url, std::string body) const;
+#endif
 
  public:
   explicit OpenAIAdapter(const Config& config,
@@ -42,14 +72,44 @@ class OpenAIAdapter : public LLMInterface {
   StreamingResponse ChatStream(const std::vector<Message>& messages) override;
   std::string ModelName() const override { return model_; }
 
+  // Запросы пакета идут параллельно через EventLoop клиента, не больше
+  // options.max_in_flight одновременно. Ответы разбираются в вызывающем
+  // потоке
+  std::vector<BatchResult> ChatBatch(
+      const std::vector<std::vector<Message>>& batch,
+      const BatchOptions& options = {}) override;
+
   // OpenAI specific methods
-  void SetModel(const std::string& model) { model_ = model; }
+  void SetModel(const std::string& model);
+  // Счетчики hedging по Config::hedging
+  HedgingStats hedging_stats() const { return http_client_->hedging_stats(); }
   Response ChatWithOptions(const std::vector<Message>& messages,
                            double temperature = 1.0, int max_tokens = -1) const;
   StreamingResponse ChatStreamWithOptions(const std::vector<Message>& messages,
                                           double temperature = 1.0,
                                           int max_tokens = -1) const;
 
+  // Чат по Conversation: история не сериализуется заново на каждом ходе
+  Response Chat(const Conversation& conversation);
+  StreamingResponse ChatStream(const Conversation& conversation);
+  Response ChatWithOptions(const Conversation& conversation,
+                           double temperature = 1.0, int max_tokens = -1) const;
+  StreamingResponse ChatStreamWithOptions(const Conversation& conversation,
+                                          double temperature = 1.0,
+                                          int max_tokens = -1) const;
+
+#ifdef AGENTIXX_COROUTINES
+  // Корутинные версии (сборка с ENABLE_COROUTINES, C++20). Запросы идут
+  // через EventLoop клиента: корутина в ожидании ответа не занимает поток
+  // и продолжается в I/O потоке. Тело запроса собирается при вызове,
+  // адаптер должен жить, пока задачи не завершены
+  Task<Response> CompleteAsync(const std::string& prompt) const;
+  Task<Response> ChatAsync(const std::vector<Message>& messages) const;
+  Task<Response> ChatAsync(const Conversation& conversation) const;
+  AsyncStream ChatStreamAsync(const std::vector<Message>& messages) const;
+  AsyncStream ChatStreamAsync(const Conversation& conversation) const;
+#endif
+
   // Real-time streaming with callbacks
   void ChatStreamRealtime(const std::vector<Message>& messages,
                           StreamCallback on_chunk,
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llm_interface.hpp"
+
+namespace agentixx {
+
+// Настройки RoutingAdapter
+struct RoutingOptions {
+  enum class Balance {
+    kLeastOutstanding,  // Меньше запросов в полете на единицу веса
+    kLatency,           // Меньше EWMA задержки * запросов в полете / вес
+  };
+
+  Balance balance = Balance::kLatency;
+  // Постоянная времени EWMA задержки. Медленный ответ поднимает оценку
+  // сразу, быстрые опускают ее за несколько decay; без новых замеров
+  // оценка затухает, и backend снова получает пробные запросы
+  std::chrono::milliseconds decay{2000};
+  // Сколько backends пробовать для одного запроса, 0 - все
+  size_t max_attempts = 0;
+  // Circuit breaker: после failure_threshold ошибок подряд backend
+  // выводится из ротации на open_duration, затем получает один пробный
+  // запрос. Успех возвращает его в ротацию, ошибка - снова на
+  // open_duration
+  int failure_threshold = 5;
+  std::chrono::milliseconds open_duration{10000};
+
+  void SetBalance(Balance value) { balance = value; }
+  void SetDecay(std::chrono::milliseconds value) { decay = value; }
+  void SetMaxAttempts(size_t count) { max_attempts = count; }
+  void SetFailureThreshold(int count) { failure_threshold = count; }
+  void SetOpenDuration(std::chrono::milliseconds value) {
+    open_duration = value;
+  }
+};
+
+// Состояние одного backend RoutingAdapter
+struct RoutingBackendStats {
+  enum class Circuit { kClosed, kOpen, kHalfOpen };
+
+  std::string name;
+  double weight = 1;
+  size_t outstanding = 0;  // Запросов в полете
+  double latency_ms = 0;   // EWMA задержки Complete/Chat, 0 - нет замеров
+  double stream_latency_ms = 0;  // То же для открытия потоков
+  uint64_t requests = 0;
+  uint64_t failures = 0;  // NetworkError, 429 и 5xx
+  Circuit circuit = Circuit::kClosed;
+};
+
+// Балансировка и failover между несколькими LLMInterface.
+//
+// Каждый запрос идет на backend с лучшей оценкой по живой статистике:
+// запросам в полете и EWMA задержки, деленным на вес. Backends без
+// замеров и простаивающие выбираются случайно пропорционально весу,
+// поэтому новый или восстановившийся backend быстро получает трафик, а
+// замедлившийся теряет его с первым медленным ответом.
+//
+// NetworkError, 429 и 5xx считаются отказом backend: запрос повторяется
+// на следующем, ошибка последнего попытанного уходит вызывающему. Прочие
+// ошибки (4xx, ParseError) возвращаются сразу. Отказы подряд размыкают
+// circuit breaker backend; если разомкнуты все, запрос идет на тот, что
+// раньше других должен вернуться в ротацию.
+//
+// Потоки переключаются только при ошибке открытия: ChatStream и
+// CompleteStream возвращаются после первого ответа backend. ChatBatch
+// целиком уходит на лучший backend, элементы с отказами повторяются
+// подпакетом на следующем.
+//
+// Backends добавляются до первого запроса. Потокобезопасен, если
+// потокобезопасны backends.
+class RoutingAdapter : public LLMInterface {
+ public:
+  explicit RoutingAdapter(RoutingOptions options = {});
+  ~RoutingAdapter() override;
+
+  RoutingAdapter(const RoutingAdapter&) = delete;
+  RoutingAdapter& operator=(const RoutingAdapter&) = delete;
+
+  // Без владения: backend должен пережить адаптер
+  void AddBackend(const std::string& name, LLMInterface& backend,
+                  double weight = 1);
+  void AddBackend(const std::string& name,
+                  std::unique_ptr<LLMInterface> backend, double weight = 1);
+
+  Response Complete(const std::string& prompt) override;
+  Response Chat(const std::vector<Message>& messages) override;
+  StreamingResponse CompleteStream(const std::string& prompt) override;
+  StreamingResponse ChatStream(const std::vector<Message>& messages) override;
+  std::vector<BatchResult> ChatBatch(
+      const std::vector<std::vector<Message>>& batch,
+      const BatchOptions& options = {}) override;
+  // Модель первого backend
+  std::string ModelName() const override;
+
+  std::vector<RoutingBackendStats> stats() const;
+
+ private:
+  class Impl;
+
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+// Распределение задержки в мс. Значения ниже 0 считаются 0
+struct MockLatency {
+  enum class Kind {
+    kFixed,      // a
+    kUniform,    // Равномерно от a до b
+    kNormal,     // Среднее a, стандартное отклонение b
+    kLogNormal,  // Медиана a, sigma b: длинный хвост, как у живых API
+  };
+
+  Kind kind = Kind::kFixed;
+  double a = 0;
+  double b = 0;
+
+  static MockLatency Fixed(double ms) { return {Kind::kFixed, ms, 0}; }
+  static MockLatency Uniform(double min_ms, double max_ms) {
+    return {Kind::kUniform, min_ms, max_ms};
+  }
+  static MockLatency Normal(double mean_ms, double stddev_ms) {
+    return {Kind::kNormal, mean_ms, stddev_ms};
+  }
+  static MockLatency LogNormal(double median_ms, double sigma) {
+    return {Kind::kLogNormal, median_ms, sigma};
+  }
+};
+
+// Ответ MockOpenAIServer на один запрос
+struct MockBehavior {
+  enum class Fault {
+    kNone,
+    kRateLimit,    // 429 с Retry-After
+    kServerError,  // 500
+    kDisconnect,   // Соединение рвется посреди ответа
+  };
+
+  // Задержка до заголовков ответа
+  MockLatency latency;
+  // Токенов в ответе: каждый - отдельный chunk потока
+  int completion_tokens = 16;
+  std::string token = "token ";
+  // Темп генерации, 0 - без пауз. Поток ждет между chunks, обычный ответ
+  // - перед отправкой, столько же, сколько шел бы поток
+  double tokens_per_second = 0;
+  // Поле usage в ответе и в последнем chunk потока
+  bool usage = true;
+
+  // Ошибка, выбранная явно; kNone - по вероятностям ниже
+  Fault fault = Fault::kNone;
+  double rate_limit_probability = 0;
+  double server_error_probability = 0;
+  // Поток обрывается после половины токенов, обычный ответ - посреди тела
+  double disconnect_probability = 0;
+  int retry_after_ms = 1000;  // Retry-After и retry-after-ms ответа 429
+
+  void SetLatency(const MockLatency& value) { latency = value; }
+  void SetCompletionTokens(int count) { completion_tokens = count; }
+  void SetToken(const std::string& value) { token = value; }
+  void SetTokensPerSecond(double rate) { tokens_per_second = rate; }
+  void SetUsage(bool value) { usage = value; }
+  void SetFault(Fault value) { fault = value; }
+  void SetRateLimitProbability(double p) { rate_limit_probability = p; }
+  void SetServerErrorProbability(double p) { server_error_probability = p; }
+  void SetDisconnectProbability(double p) { disconnect_probability = p; }
+  void SetRetryAfterMs(int ms) { retry_after_ms = ms; }
+};
+
+// Запрос, пришедший на MockOpenAIServer
+struct MockRequest {
+  uint64_t index = 0;  // Порядковый номер с 0
+  std::string path;
+  Headers headers;  // Имена в нижнем регистре
+  Json body;
+  std::string model;
+  bool stream = false;
+};
+
+// Настройки MockOpenAIServer
+struct MockServerOptions {
+  // Поведение по умолчанию
+  MockBehavior behavior;
+  // Меняет поведение для отдельного запроса: по номеру, модели, тексту
+  // сообщений. Вызывается из потоков соединений, параллельно
+  std::function<void(const MockRequest&, MockBehavior&)> script;
+  // Случайные задержки и ошибки запроса зависят только от seed и номера
+  // запроса, поэтому прогон воспроизводим при любом порядке соединений
+  uint64_t seed = 1;
+
+  void SetBehavior(const MockBehavior& value) { behavior = value; }
+  void SetScript(std::function<void(const MockRequest&, MockBehavior&)> fn) {
+    script = std::move(fn);
+  }
+  void SetSeed(uint64_t value) { seed = value; }
+};
+
+// Счетчики MockOpenAIServer
+struct MockServerStats {
+  uint64_t requests = 0;  // Разобранных запросов к completions
+  uint64_t streams = 0;
+  uint64_t rate_limited = 0;
+  uint64_t server_errors = 0;
+  uint64_t disconnects = 0;
+  // Клиент закрыл соединение до конца ответа (отмена, проигравший дубль)
+  uint64_t abandoned = 0;
+  uint64_t connections = 0;  // Принятых соединений
+};
+
+// Локальный сервер с API OpenAI для бенчмарков и проверок без сети.
+//
+// Отвечает на POST .../chat/completions и .../completions обычным JSON или
+// SSE потоком (при "stream": true) в формате OpenAI, с usage. Задержка,
+// темп токенов и ошибки 429/500/обрыв соединения задаются MockBehavior,
+// для отдельных запросов - MockServerOptions::script.
+//
+// HTTP/1.1 с keep-alive, соединение обслуживает свой поток. Требует POSIX
+// сокетов. Собирается в библиотеку agentixx_mock (опция BUILD_MOCK_SERVER)
+class MockOpenAIServer {
+ private:
+  class Impl;
+  std::unique_ptr<Impl> pimpl_;
+
+ public:
+  explicit MockOpenAIServer(MockServerOptions options = {});
+  // Останавливает сервер
+  ~MockOpenAIServer();
+
+  MockOpenAIServer(const MockOpenAIServer&) = delete;
+  MockOpenAIServer& operator=(const MockOpenAIServer&) = delete;
+
+  // Слушать address:port, port 0 - свободный порт. Возвращает порт.
+  // Выбрасывает AgentCppException, если сокет не открылся
+  int Start(int port = 0, const std::string& address = "127.0.0.1");
+  // Закрыть сокет и оборвать открытые соединения
+  void Stop();
+
+  // "http://address:port/v1" для Config::SetBaseUrl
+  std::string base_url() const;
+  MockServerStats stats() const;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,107 @@
+#include "channel_sink.hpp"
+
+namespace agentixx {
+
+ChannelSink::ChannelSink(std::shared_ptr<StreamChannel> channel,
+                         PostFunction post)
+    : channel_(std::move(channel)), post_(std::move(post)) {}
+
+void ChannelSink::Connect() {
+  // Callback вызывается в потоке потребителя, поэтому только ставит
+  // Resume в очередь I/O потока. Ссылку на sink канал сбросит в Close
+  channel_->SetOnSpace([self = shared_from_this()] {
+    self->post_([self] { self->Resume(); });
+  });
+}
+
+void ChannelSink::Start(const HttpResponse& info) {
+  if (!started_) {
+    started_ = true;
+    channel_->Start(info);
+  }
+}
+
+void ChannelSink::Deliver(StreamChunk chunk) {
+  if (closed_) {
+    return;
+  }
+  if (pending_.empty() && channel_->Push(std::move(chunk))) {
+    return;
+  }
+  pending_.push_back(std::move(chunk));
+}
+
+bool ChannelSink::Congested() {
+  if (Flush()) {
+    return false;
+  }
+  paused_ = true;
+  return true;
+}
+
+void ChannelSink::Finish(std::exception_ptr error) {
+  handle_ = nullptr;
+  paused_ = false;
+  if (closed_) {
+    return;
+  }
+
+  if (error) {
+    pending_.clear();
+    Close(error);
+    return;
+  }
+
+  finished_ = true;
+  if (Flush()) {
+    Close(nullptr);
+  }
+}
+
+bool ChannelSink::Flush() {
+  while (!pending_.empty() && channel_->Push(std::move(pending_.front()))) {
+    pending_.pop_front();
+  }
+  return pending_.empty();
+}
+
+void ChannelSink::Resume() {
+  if (closed_) {
+    return;
+  }
+
+  // Потребитель ушел: отпускаем передачу, следующий write callback
+  // ее прервет
+  if (channel_->cancelled()) {
+    pending_.clear();
+    if (finished_) {
+      Close(nullptr);
+    } else {
+      Unpause();
+    }
+    return;
+  }
+
+  if (!Flush()) {
+    return;
+  }
+  if (finished_) {
+    Close(nullptr);
+  } else {
+    Unpause();
+  }
+}
+
+void ChannelSink::Unpause() {
+  if (paused_ && handle_) {
+    paused_ = false;
+    curl_easy_pause(handle_, CURLPAUSE_CONT);
+  }
+}
+
+void ChannelSink::Close(std::exception_ptr error) {
+  closed_ = true;
+  channel_->Close(error);
+}
+
+}  // namespace agentixx
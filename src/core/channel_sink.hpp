@@ -0,0 +1,71 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+
+#include "agentixx/core/streaming.hpp"
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+// Доставка chunks живого потока из I/O потока в StreamChannel.
+//
+// Если очередь заполнена, chunks копятся в pending, а передача ставится на
+// паузу (CURL_WRITEFUNC_PAUSE) до освобождения места потребителем. Pending
+// ограничен одним буфером данных libcurl. Все методы, кроме callback
+// освобождения места, вызываются только в I/O потоке
+class ChannelSink : public std::enable_shared_from_this<ChannelSink> {
+ public:
+  // Выполнить задачу в I/O потоке
+  using PostFunction = std::function<void(std::function<void()>)>;
+
+  ChannelSink(std::shared_ptr<StreamChannel> channel, PostFunction post);
+
+  // Подписаться на освобождение места в очереди
+  void Connect();
+
+  // Передача началась на handle
+  void Attach(CURL* handle) { handle_ = handle; }
+
+  // Получен успешный статус, поток начался
+  void Start(const HttpResponse& info);
+
+  // Передать chunk потребителю или отложить до освобождения места
+  void Deliver(StreamChunk chunk);
+
+  // Метрики потока для потребителя, доходят до него сразу
+  void SetMetrics(const RequestMetrics& metrics) {
+    channel_->SetMetrics(metrics);
+  }
+
+  // Отложенные chunks не поместились в очередь, передачу нужно
+  // приостановить. Возобновит ее Resume
+  bool Congested();
+
+  // Поток завершен. При ошибке отложенные chunks отбрасываются, иначе
+  // канал закрывается после их доставки
+  void Finish(std::exception_ptr error);
+
+  bool cancelled() const { return channel_->cancelled(); }
+
+ private:
+  std::shared_ptr<StreamChannel> channel_;
+  PostFunction post_;
+  std::deque<StreamChunk> pending_;
+  CURL* handle_ = nullptr;
+  bool started_ = false;
+  bool paused_ = false;
+  bool finished_ = false;
+  bool closed_ = false;
+
+  bool Flush();
+  void Resume();
+  void Unpause();
+  void Close(std::exception_ptr error);
+};
+
+}  // namespace agentixx
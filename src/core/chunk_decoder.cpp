@@ -0,0 +1,492 @@
+#include "chunk_decoder.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace agentixx {
+
+namespace {
+
+// Однопроходный курсор по JSON тексту. Разбирает только то, что
+// запрошено, остальные значения пропускает без выделения памяти
+class JsonCursor {
+ public:
+  explicit JsonCursor(std::string_view json)
+      : p_(json.data()), end_(json.data() + json.size()) {}
+
+  bool AtEnd() {
+    SkipWhitespace();
+    return p_ == end_;
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (p_ < end_ && *p_ == c) {
+      ++p_;
+      return true;
+    }
+    return false;
+  }
+
+  bool Null() { return Literal("null"); }
+
+  // Строка без escape-последовательностей возвращается view во вход,
+  // иначе декодируется в scratch
+  bool String(std::string_view* out, std::string* scratch) {
+    if (!Consume('"')) {
+      return false;
+    }
+    const char* start = p_;
+    while (p_ < end_ && *p_ != '"' && *p_ != '\\') {
+      if (static_cast<unsigned char>(*p_) < 0x20) {
+        return false;
+      }
+      ++p_;
+    }
+    if (p_ == end_) {
+      return false;
+    }
+    if (*p_ == '"') {
+      *out = std::string_view(start, p_ - start);
+      ++p_;
+      return true;
+    }
+
+    scratch->assign(start, p_);
+    if (!DecodeEscaped(scratch)) {
+      return false;
+    }
+    *out = *scratch;
+    return true;
+  }
+
+  bool String(std::string* out) {
+    std::string_view value;
+    if (!String(&value, &scratch_)) {
+      return false;
+    }
+    out->assign(value);
+    return true;
+  }
+
+  bool StringOrNull(std::string* out) { return Null() || String(out); }
+
+  // Целое число. Дробные числа не ожидаются - пусть их разберет DOM
+  bool Integer(long* out) {
+    SkipWhitespace();
+    bool negative = p_ < end_ && *p_ == '-';
+    if (negative) {
+      ++p_;
+    }
+    if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+      return false;
+    }
+    // Ведущий ноль допустим только у самого нуля
+    if (*p_ == '0' && p_ + 1 < end_ && p_[1] >= '0' && p_[1] <= '9') {
+      return false;
+    }
+    long value = 0;
+    while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+      if (value > (std::numeric_limits<long>::max() - 9) / 10) {
+        return false;
+      }
+      value = value * 10 + (*p_++ - '0');
+    }
+    if (p_ < end_ && (*p_ == '.' || *p_ == 'e' || *p_ == 'E')) {
+      return false;
+    }
+    *out = negative ? -value : value;
+    return true;
+  }
+
+  // on_member(key) разбирает значение. Key нельзя использовать после
+  // разбора значения: он может указывать во временный буфер
+  template <typename OnMember>
+  bool Object(OnMember&& on_member) {
+    if (!Consume('{')) {
+      return false;
+    }
+    if (Consume('}')) {
+      return true;
+    }
+    do {
+      std::string_view key;
+      if (!String(&key, &key_scratch_) || !Consume(':') || !on_member(key)) {
+        return false;
+      }
+    } while (Consume(','));
+    return Consume('}');
+  }
+
+  template <typename OnElement>
+  bool Array(OnElement&& on_element) {
+    if (!Consume('[')) {
+      return false;
+    }
+    if (Consume(']')) {
+      return true;
+    }
+    size_t index = 0;
+    do {
+      if (!on_element(index++)) {
+        return false;
+      }
+    } while (Consume(','));
+    return Consume(']');
+  }
+
+  bool Skip() { return SkipValue(0); }
+
+ private:
+  static constexpr int kMaxDepth = 64;
+
+  const char* p_;
+  const char* end_;
+  std::string scratch_;
+  std::string key_scratch_;
+
+  void SkipWhitespace() {
+    while (p_ < end_ &&
+           (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+      ++p_;
+    }
+  }
+
+  bool Literal(std::string_view literal) {
+    SkipWhitespace();
+    if (static_cast<size_t>(end_ - p_) >= literal.size() &&
+        std::memcmp(p_, literal.data(), literal.size()) == 0) {
+      p_ += literal.size();
+      return true;
+    }
+    return false;
+  }
+
+  bool Hex4(uint32_t* out) {
+    if (end_ - p_ < 4) {
+      return false;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = *p_++;
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        return false;
+      }
+    }
+    *out = value;
+    return true;
+  }
+
+  static void AppendUtf8(uint32_t code, std::string* out) {
+    if (code < 0x80) {
+      out->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      out->push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xF0 | (code >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+
+  // Продолжить строку с первой '\\' до закрывающей кавычки
+  bool DecodeEscaped(std::string* out) {
+    while (p_ < end_) {
+      char c = *p_++;
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c != '\\') {
+        out->push_back(c);
+        continue;
+      }
+      if (p_ == end_) {
+        return false;
+      }
+      switch (*p_++) {
+        case '"':
+          out->push_back('"');
+          break;
+        case '\\':
+          out->push_back('\\');
+          break;
+        case '/':
+          out->push_back('/');
+          break;
+        case 'b':
+          out->push_back('\b');
+          break;
+        case 'f':
+          out->push_back('\f');
+          break;
+        case 'n':
+          out->push_back('\n');
+          break;
+        case 'r':
+          out->push_back('\r');
+          break;
+        case 't':
+          out->push_back('\t');
+          break;
+        case 'u': {
+          uint32_t code = 0;
+          if (!Hex4(&code) || (code >= 0xDC00 && code <= 0xDFFF)) {
+            return false;
+          }
+          // Суррогатная пара UTF-16
+          if (code >= 0xD800 && code <= 0xDBFF) {
+            uint32_t low = 0;
+            if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+              return false;
+            }
+            p_ += 2;
+            if (!Hex4(&low) || low < 0xDC00 || low > 0xDFFF) {
+              return false;
+            }
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          }
+          AppendUtf8(code, out);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    return false;
+  }
+
+  bool SkipString() {
+    if (!Consume('"')) {
+      return false;
+    }
+    while (p_ < end_) {
+      char c = *p_++;
+      if (c == '"') {
+        return true;
+      }
+      if (c == '\\') {
+        // Escape проверяется по тем же правилам, что и в String
+        --p_;
+        scratch_.clear();
+        return DecodeEscaped(&scratch_);
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool SkipDigits() {
+    const char* start = p_;
+    while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+      ++p_;
+    }
+    return p_ != start;
+  }
+
+  // Число по грамматике JSON: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+  bool SkipNumber() {
+    if (p_ < end_ && *p_ == '-') {
+      ++p_;
+    }
+    if (p_ < end_ && *p_ == '0') {
+      ++p_;
+    } else if (!SkipDigits()) {
+      return false;
+    }
+    if (p_ < end_ && *p_ == '.') {
+      ++p_;
+      if (!SkipDigits()) {
+        return false;
+      }
+    }
+    if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+      ++p_;
+      if (p_ < end_ && (*p_ == '+' || *p_ == '-')) {
+        ++p_;
+      }
+      if (!SkipDigits()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool SkipValue(int depth) {
+    if (depth > kMaxDepth) {
+      return false;
+    }
+    SkipWhitespace();
+    if (p_ == end_) {
+      return false;
+    }
+    switch (*p_) {
+      case '"':
+        return SkipString();
+      case '{':
+        ++p_;
+        if (Consume('}')) {
+          return true;
+        }
+        do {
+          if (!SkipString() || !Consume(':') || !SkipValue(depth + 1)) {
+            return false;
+          }
+        } while (Consume(','));
+        return Consume('}');
+      case '[':
+        ++p_;
+        if (Consume(']')) {
+          return true;
+        }
+        do {
+          if (!SkipValue(depth + 1)) {
+            return false;
+          }
+        } while (Consume(','));
+        return Consume(']');
+      case 't':
+        return Literal("true");
+      case 'f':
+        return Literal("false");
+      case 'n':
+        return Literal("null");
+      default:
+        return SkipNumber();
+    }
+  }
+};
+
+bool DecodeToolCall(JsonCursor& json, ToolCallDelta* call) {
+  return json.Object([&](std::string_view key) {
+    if (key == "index") {
+      long index = 0;
+      if (!json.Integer(&index)) {
+        return false;
+      }
+      call->index = static_cast<int>(index);
+      return true;
+    }
+    if (key == "id") {
+      return json.StringOrNull(&call->id);
+    }
+    if (key == "function") {
+      return json.Null() || json.Object([&](std::string_view field) {
+               if (field == "name") {
+                 return json.StringOrNull(&call->name);
+               }
+               if (field == "arguments") {
+                 return json.StringOrNull(&call->arguments);
+               }
+               return json.Skip();
+             });
+    }
+    return json.Skip();
+  });
+}
+
+bool DecodeDelta(JsonCursor& json, StreamChunk* chunk) {
+  return json.Object([&](std::string_view key) {
+    if (key == "content") {
+      return json.StringOrNull(&chunk->content);
+    }
+    if (key == "tool_calls") {
+      return json.Null() || json.Array([&](size_t) {
+               chunk->tool_calls.emplace_back();
+               return DecodeToolCall(json, &chunk->tool_calls.back());
+             });
+    }
+    return json.Skip();
+  });
+}
+
+bool DecodeChoice(JsonCursor& json, StreamChunk* chunk) {
+  return json.Object([&](std::string_view key) {
+    if (key == "index") {
+      long index = 0;
+      if (!json.Integer(&index)) {
+        return false;
+      }
+      chunk->choice_index = static_cast<int>(index);
+      return true;
+    }
+    if (key == "delta") {
+      return json.Null() || DecodeDelta(json, chunk);
+    }
+    // Legacy /completions отдает текст в choices[].text
+    if (key == "text") {
+      return json.StringOrNull(&chunk->content);
+    }
+    if (key == "finish_reason") {
+      if (json.Null()) {
+        return true;
+      }
+      std::string reason;
+      if (!json.String(&reason)) {
+        return false;
+      }
+      chunk->finish_reason = std::move(reason);
+      return true;
+    }
+    return json.Skip();
+  });
+}
+
+bool DecodeUsage(JsonCursor& json, StreamChunk* chunk) {
+  TokenUsage usage;
+  bool ok = json.Object([&](std::string_view key) {
+    if (key == "prompt_tokens") {
+      return json.Integer(&usage.prompt_tokens);
+    }
+    if (key == "completion_tokens") {
+      return json.Integer(&usage.completion_tokens);
+    }
+    if (key == "total_tokens") {
+      return json.Integer(&usage.total_tokens);
+    }
+    return json.Skip();
+  });
+  if (ok) {
+    chunk->usage = usage;
+  }
+  return ok;
+}
+
+}  // namespace
+
+bool DecodeStreamChunk(std::string_view json, StreamChunk* chunk) {
+  JsonCursor cursor(json);
+  bool ok = cursor.Object([&](std::string_view key) {
+    if (key == "choices") {
+      return cursor.Null() || cursor.Array([&](size_t index) {
+               return index == 0 ? DecodeChoice(cursor, chunk) : cursor.Skip();
+             });
+    }
+    if (key == "usage") {
+      return cursor.Null() || DecodeUsage(cursor, chunk);
+    }
+    return cursor.Skip();
+  });
+  return ok && cursor.AtEnd();
+}
+
+}  // namespace agentixx
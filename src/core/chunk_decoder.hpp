@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+#include "agentixx/core/streaming.hpp"
+
+namespace agentixx {
+
+// Извлечь из JSON chunk формата chat.completion.chunk поля StreamChunk:
+// choices[0].delta.content (или choices[0].text у /completions),
+// finish_reason, delta.tool_calls и usage. Остальные значения
+// пропускаются без разбора и выделения памяти.
+//
+// false - JSON некорректен или имеет неожиданную структуру, тогда
+// вызывающий разбирает его полным парсером
+bool DecodeStreamChunk(std::string_view json, StreamChunk* chunk);
+
+}  // namespace agentixx
@@ -0,0 +1,187 @@
+#include "agentixx/core/connection_pool.hpp"
+
+#include <algorithm>
+
+#include "agentixx/core/types.hpp"
+#include "connection_pool_impl.hpp"
+
+namespace agentixx {
+
+ConnectionPool::Impl::Impl(const ConnectionPoolOptions& options)
+    : options_(options), share_(std::make_shared<CurlShare>()) {}
+
+ConnectionPool::Impl::~Impl() {
+  for (auto& entry : hosts_) {
+    for (auto& idle : entry.second->idle) {
+      curl_easy_cleanup(idle.handle);
+    }
+  }
+}
+
+std::string ConnectionPool::Impl::HostKey(const std::string& url) {
+  size_t start = url.find("://");
+  start = (start == std::string::npos) ? 0 : start + 3;
+  size_t end = url.find_first_of("/?#", start);
+  return url.substr(0, end);
+}
+
+void ConnectionPool::Impl::Prepare(CURL* handle) const {
+  share_->Attach(handle);
+  curl_easy_setopt(handle, CURLOPT_MAXCONNECTS, 1L);
+  curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN,
+                   std::max(1L, static_cast<long>(options_.idle_timeout_ms /
+                                                  1000)));
+#if LIBCURL_VERSION_NUM >= 0x075000
+  if (options_.max_connection_age_ms > 0) {
+    curl_easy_setopt(
+        handle, CURLOPT_MAXLIFETIME_CONN,
+        std::max(1L, static_cast<long>(options_.max_connection_age_ms / 1000)));
+  }
+#endif
+}
+
+ConnectionPool::Impl::HostSlots& ConnectionPool::Impl::Slots(
+    const std::string& host) {
+  {
+    std::shared_lock<std::shared_mutex> lock(hosts_mutex_);
+    auto it = hosts_.find(host);
+    if (it != hosts_.end()) {
+      return *it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(hosts_mutex_);
+  auto& slots = hosts_[host];
+  if (!slots) {
+    slots = std::make_unique<HostSlots>();
+  }
+  return *slots;
+}
+
+void ConnectionPool::Impl::EvictIdleLocked(HostSlots& slots,
+                                           Clock::time_point now) {
+  auto timeout = std::chrono::milliseconds(options_.idle_timeout_ms);
+  auto expired = std::remove_if(
+      slots.idle.begin(), slots.idle.end(), [&](const IdleHandle& idle) {
+        if (now - idle.since < timeout) {
+          return false;
+        }
+        curl_easy_cleanup(idle.handle);
+        ++evicted_;
+        return true;
+      });
+  slots.idle.erase(expired, slots.idle.end());
+}
+
+ConnectionPool::Impl::Lease ConnectionPool::Impl::Acquire(
+    const std::string& url) {
+  HostSlots& slots = Slots(HostKey(url));
+  CURL* handle = nullptr;
+
+  {
+    std::unique_lock<std::mutex> lock(slots.mutex);
+    size_t limit = options_.max_connections_per_host;
+    slots.slot_released.wait(
+        lock, [&] { return limit == 0 || slots.leased < limit; });
+
+    EvictIdleLocked(slots, Clock::now());
+    if (!slots.idle.empty()) {
+      handle = slots.idle.back().handle;
+      slots.idle.pop_back();
+      ++reused_;
+    }
+    ++slots.leased;
+  }
+
+  if (!handle) {
+    handle = curl_easy_init();
+    if (!handle) {
+      {
+        std::lock_guard<std::mutex> lock(slots.mutex);
+        --slots.leased;
+      }
+      slots.slot_released.notify_one();
+      throw NetworkError("Failed to initialize CURL");
+    }
+    ++created_;
+  }
+
+  Prepare(handle);
+  return Lease(this, handle, &slots);
+}
+
+void ConnectionPool::Impl::Release(CURL* handle, HostSlots* slots,
+                                   bool healthy) {
+  // Сбрасываем опции запроса, открытые соединения и кэши сохраняются
+  curl_easy_reset(handle);
+
+  {
+    std::lock_guard<std::mutex> lock(slots->mutex);
+    --slots->leased;
+    if (healthy && slots->idle.size() < options_.max_idle_per_host) {
+      slots->idle.push_back({handle, Clock::now()});
+      handle = nullptr;
+    }
+  }
+  slots->slot_released.notify_one();
+
+  if (handle) {
+    ++evicted_;
+    curl_easy_cleanup(handle);
+  }
+}
+
+std::shared_ptr<EventLoop> ConnectionPool::Impl::Loop() {
+  std::lock_guard<std::mutex> lock(loop_mutex_);
+  if (!loop_) {
+    EventLoopOptions options;
+    options.max_connections_per_host = options_.max_connections_per_host;
+    // Конструктор цикла закрыт: share доступен только пулу
+    loop_ = std::shared_ptr<EventLoop>(new EventLoop(options, share_));
+  }
+  return loop_;
+}
+
+void ConnectionPool::Impl::EvictIdle() {
+  std::shared_lock<std::shared_mutex> hosts_lock(hosts_mutex_);
+  auto now = Clock::now();
+  for (auto& entry : hosts_) {
+    std::lock_guard<std::mutex> lock(entry.second->mutex);
+    EvictIdleLocked(*entry.second, now);
+  }
+}
+
+ConnectionPool::Stats ConnectionPool::Impl::GetStats() const {
+  Stats stats;
+  stats.created = created_.load();
+  stats.reused = reused_.load();
+  stats.evicted = evicted_.load();
+
+  std::shared_lock<std::shared_mutex> hosts_lock(hosts_mutex_);
+  for (const auto& entry : hosts_) {
+    std::lock_guard<std::mutex> lock(entry.second->mutex);
+    stats.leased += entry.second->leased;
+    stats.idle += entry.second->idle.size();
+  }
+  return stats;
+}
+
+// Реализация публичных методов ConnectionPool
+
+ConnectionPool::ConnectionPool(const ConnectionPoolOptions& options)
+    : pimpl_(std::make_unique<Impl>(options)) {}
+
+ConnectionPool::~ConnectionPool() = default;
+
+void ConnectionPool::EvictIdle() { pimpl_->EvictIdle(); }
+
+ConnectionPool::Stats ConnectionPool::GetStats() const {
+  return pimpl_->GetStats();
+}
+
+const ConnectionPoolOptions& ConnectionPool::options() const {
+  return pimpl_->options();
+}
+
+}  // namespace agentixx
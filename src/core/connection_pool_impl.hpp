@@ -0,0 +1,127 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "agentixx/core/connection_pool.hpp"
+#include "agentixx/core/event_loop.hpp"
+#include "curl_share.hpp"
+
+namespace agentixx {
+
+// Внутренняя реализация пула, доступна только HttpClient.
+// Критические секции короткие и разделены по host-ам: сама передача
+// данных выполняется без блокировок
+class ConnectionPool::Impl {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct IdleHandle {
+    CURL* handle;
+    Clock::time_point since;
+  };
+
+  // Состояние одного host. Собственный mutex, чтобы потоки, работающие
+  // с разными host, не конкурировали за общую блокировку
+  struct HostSlots {
+    std::mutex mutex;
+    std::condition_variable slot_released;
+    size_t leased = 0;
+    std::vector<IdleHandle> idle;  // LIFO: последний самый "теплый"
+  };
+
+  // RAII аренда CURL handle. При уничтожении handle возвращается в пул
+  class Lease {
+   private:
+    Impl* pool_ = nullptr;
+    CURL* handle_ = nullptr;
+    HostSlots* host_ = nullptr;
+    bool healthy_ = true;
+
+   public:
+    Lease() = default;
+    Lease(Impl* pool, CURL* handle, HostSlots* host)
+        : pool_(pool), handle_(handle), host_(host) {}
+    ~Lease() { reset(); }
+
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    Lease(Lease&& other) noexcept { *this = std::move(other); }
+    Lease& operator=(Lease&& other) noexcept {
+      if (this != &other) {
+        reset();
+        pool_ = other.pool_;
+        handle_ = other.handle_;
+        host_ = other.host_;
+        healthy_ = other.healthy_;
+        other.pool_ = nullptr;
+        other.handle_ = nullptr;
+      }
+      return *this;
+    }
+
+    CURL* handle() const { return handle_; }
+    explicit operator bool() const { return handle_ != nullptr; }
+
+    // Соединение сломано - handle будет закрыт, а не возвращен в пул
+    void MarkUnhealthy() { healthy_ = false; }
+
+    void reset() {
+      if (pool_ && handle_) {
+        pool_->Release(handle_, host_, healthy_);
+      }
+      pool_ = nullptr;
+      handle_ = nullptr;
+    }
+  };
+
+  explicit Impl(const ConnectionPoolOptions& options);
+  ~Impl();
+
+  // Арендовать handle для host из url. С max_connections_per_host
+  // блокируется, пока для host не освободится слот
+  Lease Acquire(const std::string& url);
+
+  // I/O цикл пула, создается при первом использовании. Его передачи
+  // используют DNS кэш и TLS сессии пула, а кэш соединений curl_multi
+  // общий для всех клиентов пула
+  std::shared_ptr<EventLoop> Loop();
+
+  void EvictIdle();
+  Stats GetStats() const;
+  const ConnectionPoolOptions& options() const { return options_; }
+
+  // Выделить "scheme://host:port" из url
+  static std::string HostKey(const std::string& url);
+
+ private:
+  ConnectionPoolOptions options_;
+  std::shared_ptr<CurlShare> share_;
+
+  std::mutex loop_mutex_;
+  std::shared_ptr<EventLoop> loop_;
+
+  // Таблица host-ов только растет, поэтому HostSlots* остаются валидными
+  mutable std::shared_mutex hosts_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<HostSlots>> hosts_;
+
+  std::atomic<size_t> created_{0};
+  std::atomic<size_t> reused_{0};
+  std::atomic<size_t> evicted_{0};
+
+  HostSlots& Slots(const std::string& host);
+  void Release(CURL* handle, HostSlots* slots, bool healthy);
+  void Prepare(CURL* handle) const;
+  void EvictIdleLocked(HostSlots& slots, Clock::time_point now);
+};
+
+}  // namespace agentixx
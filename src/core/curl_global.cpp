@@ -0,0 +1,21 @@
+#include "curl_global.hpp"
+
+#include <curl/curl.h>
+
+#include <mutex>
+
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+void EnsureCurlGlobalInit() {
+  static std::once_flag once;
+  static CURLcode result = CURLE_OK;
+  std::call_once(once, [] { result = curl_global_init(CURL_GLOBAL_DEFAULT); });
+  if (result != CURLE_OK) {
+    throw NetworkError(std::string("Failed to initialize libcurl: ") +
+                       curl_easy_strerror(result));
+  }
+}
+
+}  // namespace agentixx
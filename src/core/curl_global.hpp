@@ -0,0 +1,10 @@
+#pragma once
+
+namespace agentixx {
+
+// Однократная потокобезопасная инициализация libcurl на процесс.
+// curl_global_init/curl_global_cleanup не потокобезопасны, поэтому
+// библиотека не вызывает их для каждого клиента
+void EnsureCurlGlobalInit();
+
+}  // namespace agentixx
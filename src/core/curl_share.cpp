@@ -0,0 +1,38 @@
+#include "curl_share.hpp"
+
+#include "agentixx/core/types.hpp"
+#include "curl_global.hpp"
+
+namespace agentixx {
+
+CurlShare::CurlShare() {
+  EnsureCurlGlobalInit();
+  share_ = curl_share_init();
+  if (!share_) {
+    throw NetworkError("Failed to initialize CURL share handle");
+  }
+
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, LockCallback);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, UnlockCallback);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+CurlShare::~CurlShare() { curl_share_cleanup(share_); }
+
+void CurlShare::LockCallback(CURL* handle, curl_lock_data data,
+                             curl_lock_access access, void* userptr) {
+  static_cast<CurlShare*>(userptr)->locks_[data].lock();
+}
+
+void CurlShare::UnlockCallback(CURL* handle, curl_lock_data data,
+                               void* userptr) {
+  static_cast<CurlShare*>(userptr)->locks_[data].unlock();
+}
+
+void CurlShare::Attach(CURL* handle) const {
+  curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+}
+
+}  // namespace agentixx
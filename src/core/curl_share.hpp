@@ -0,0 +1,35 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <mutex>
+
+namespace agentixx {
+
+// curl share handle с DNS кэшем и TLS сессиями.
+//
+// Разделяется через std::shared_ptr между handles пула и EventLoop пула:
+// цикл может пережить пул, пока в нем выполняются асинхронные запросы.
+// Сами соединения не разделяются: libcurl не поддерживает общий
+// connection cache для параллельных потоков
+class CurlShare {
+ private:
+  CURLSH* share_ = nullptr;
+  std::mutex locks_[CURL_LOCK_DATA_LAST];
+
+  static void LockCallback(CURL* handle, curl_lock_data data,
+                           curl_lock_access access, void* userptr);
+  static void UnlockCallback(CURL* handle, curl_lock_data data, void* userptr);
+
+ public:
+  CurlShare();
+  ~CurlShare();
+
+  CurlShare(const CurlShare&) = delete;
+  CurlShare& operator=(const CurlShare&) = delete;
+
+  // Подключить handle к общим кэшам. Сбрасывается curl_easy_reset
+  void Attach(CURL* handle) const;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,478 @@
+#include "curl_transfer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "agentixx/core/metrics.hpp"
+#include "agentixx/core/tracing.hpp"
+#include "channel_sink.hpp"
+
+namespace agentixx {
+
+CurlTransfer::CurlTransfer(HttpRequest request)
+    : request_(std::move(request)) {}
+
+CurlTransfer::~CurlTransfer() {
+  if (counted_) {
+    CountFinished();
+  }
+#ifdef AGENTIXX_TRACING
+  if (span_start_ns_ != 0) {
+    RecordSpan();
+  }
+#endif
+  if (curl_headers_) {
+    curl_slist_free_all(curl_headers_);
+  }
+}
+
+void CurlTransfer::ExpectStream(StreamCallback on_chunk,
+                                std::function<void()> on_complete,
+                                StreamErrorCallback on_error) {
+  streaming_ = true;
+  on_chunk_ = std::move(on_chunk);
+  on_complete_ = std::move(on_complete);
+  on_error_ = std::move(on_error);
+  on_event_ = [this](const SseEvent& event) { ProcessEvent(event); };
+
+  // Добавляем Accept для SSE
+  request_.headers["Accept"] = "text/event-stream";
+  request_.headers["Cache-Control"] = "no-cache";
+}
+
+void CurlTransfer::ExpectLiveStream(std::shared_ptr<ChannelSink> sink) {
+  sink_ = std::move(sink);
+  ExpectStream(
+      [sink = sink_](const StreamChunk& chunk) { sink->Deliver(chunk); },
+      [sink = sink_]() { sink->Finish(nullptr); },
+      [](const std::string& error) {
+        throw NetworkError("Streaming error: " + error);
+      });
+}
+
+void CurlTransfer::Attach(CURL* handle) {
+  handle_ = handle;
+  response_.metrics.start = std::chrono::steady_clock::now();
+  if (request_.metrics && !counted_) {
+    counted_ = true;
+    request_.metrics->started.Add();
+    request_.metrics->bytes_sent.Add(request_.body.size());
+  }
+#ifdef AGENTIXX_TRACING
+  if (request_.tracer && span_start_ns_ == 0) {
+    span_ = Tracer::Child(request_.trace);
+    span_start_ns_ = Tracer::Now();
+  }
+#endif
+  curl_easy_setopt(handle, CURLOPT_URL, request_.url.c_str());
+  curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS,
+                   static_cast<long>(request_.timeout_ms));
+  curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+  curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+  curl_easy_setopt(handle, CURLOPT_PRIVATE, this);
+
+  // Версия протокола. PIPEWAIT заставляет дождаться уже открытого
+  // HTTP/2 соединения к host и открыть в нем новый поток
+  switch (request_.http_version) {
+    case HttpVersion::kDefault:
+      break;
+    case HttpVersion::kHttp1:
+      curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+      break;
+    case HttpVersion::kHttp2:
+      curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+      curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+      break;
+    case HttpVersion::kHttp2PriorKnowledge:
+      curl_easy_setopt(handle, CURLOPT_HTTP_VERSION,
+                       CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
+      curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+      break;
+  }
+
+  // Настройка метода
+  if (request_.method == "POST") {
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, request_.body.c_str());
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE,
+                     static_cast<long>(request_.body.length()));
+  } else if (request_.method == "GET") {
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+  }
+
+  // Установка заголовков
+  if (!curl_headers_) {
+    for (const auto& header : request_.headers) {
+      std::string header_str = header.first + ": " + header.second;
+      curl_headers_ = curl_slist_append(curl_headers_, header_str.c_str());
+    }
+  }
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, curl_headers_);
+
+  // Настройка callbacks
+  if (streaming_) {
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, StreamingWriteCallback);
+  } else {
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+  }
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, this);
+  curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+  curl_easy_setopt(handle, CURLOPT_HEADERDATA, this);
+
+  // Progress callback вызывается и без новых данных, в том числе на паузе,
+  // поэтому отказ потребителя или флаг отмены прерывают даже молчащую
+  // передачу
+  if (sink_) {
+    sink_->Attach(handle);
+  }
+  if (sink_ || request_.cancelled) {
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+    curl_easy_setopt(handle, CURLOPT_XFERINFODATA, this);
+  }
+}
+
+void CurlTransfer::CheckResult(CURLcode result, const char* what) {
+  // Исключение из callback важнее, чем CURLE_WRITE_ERROR, которым
+  // оно прервало передачу
+  if (callback_error_) {
+    std::rethrow_exception(callback_error_);
+  }
+  if (result != CURLE_OK) {
+    throw NetworkError(std::string(what) + curl_easy_strerror(result));
+  }
+}
+
+void CurlTransfer::ReadInfo(CURL* handle) {
+  // Получение кода ответа
+  long response_code;
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
+  response_.status_code = static_cast<int>(response_code);
+
+  long http_version = 0;
+  curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &http_version);
+  switch (http_version) {
+    case CURL_HTTP_VERSION_1_0:
+      response_.protocol = "HTTP/1.0";
+      break;
+    case CURL_HTTP_VERSION_1_1:
+      response_.protocol = "HTTP/1.1";
+      break;
+    case CURL_HTTP_VERSION_2_0:
+      response_.protocol = "HTTP/2";
+      break;
+    case CURL_HTTP_VERSION_3:
+      response_.protocol = "HTTP/3";
+      break;
+    default:
+      response_.protocol.clear();
+  }
+
+  // Ни одного нового соединения - запрос ушел по открытому
+  long new_connections = 0;
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections);
+  response_.reused_connection = new_connections == 0;
+  ReadTimings(handle);
+}
+
+void CurlTransfer::ReadTimings(CURL* handle) {
+  // Таймеры libcurl накопительные, в микросекундах от начала запроса
+  curl_off_t dns = 0;
+  curl_off_t connect = 0;
+  curl_off_t tls = 0;
+  curl_off_t ttfb = 0;
+  curl_off_t total = 0;
+  curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+  curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+  curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &tls);
+  curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+  curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+
+  RequestMetrics& metrics = response_.metrics;
+  metrics.dns_ms = dns / 1000.0;
+  metrics.connect_ms = std::max<curl_off_t>(connect - dns, 0) / 1000.0;
+  metrics.tls_ms =
+      tls > 0 ? std::max<curl_off_t>(tls - connect, 0) / 1000.0 : 0;
+  metrics.ttfb_ms = ttfb / 1000.0;
+  metrics.total_ms = total / 1000.0;
+}
+
+double CurlTransfer::Elapsed() const {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - response_.metrics.start)
+      .count();
+}
+
+void CurlTransfer::TrackToken() {
+  double now_ms = Elapsed();
+  RequestMetrics& metrics = response_.metrics;
+  if (token_chunks_++ == 0) {
+    metrics.ttft_ms = now_ms;
+    if (sink_) {
+      sink_->SetMetrics(metrics);
+    }
+  } else {
+    double gap = now_ms - last_token_ms_;
+    gaps_ms_ += gap;
+    metrics.max_gap_ms = std::max(metrics.max_gap_ms, gap);
+    if (request_.metrics) {
+      request_.metrics->token_gap.Record(gap);
+    }
+  }
+  last_token_ms_ = now_ms;
+}
+
+void CurlTransfer::FinishMetrics() {
+  // [DONE] приходит до ReadInfo в FinishStream, а без sink фазы запроса
+  // еще ни разу не читались
+  ReadTimings(handle_);
+  RequestMetrics& metrics = response_.metrics;
+  metrics.total_ms = Elapsed();
+  metrics.tokens = usage_ && usage_->completion_tokens > 0
+                       ? usage_->completion_tokens
+                       : token_chunks_;
+  if (token_chunks_ > 1) {
+    metrics.mean_gap_ms = gaps_ms_ / (token_chunks_ - 1);
+    double generation_ms = last_token_ms_ - metrics.ttft_ms;
+    if (generation_ms > 0) {
+      metrics.tokens_per_second = (metrics.tokens - 1) * 1000 / generation_ms;
+    }
+  }
+  if (sink_) {
+    sink_->SetMetrics(metrics);
+  }
+  if (request_.metrics) {
+    request_.metrics->Record(metrics);
+    if (usage_) {
+      request_.metrics->prompt_tokens.Add(usage_->prompt_tokens);
+      request_.metrics->completion_tokens.Add(usage_->completion_tokens);
+    }
+  }
+}
+
+void CurlTransfer::CountFinished() {
+  EndpointMetrics& metrics = *request_.metrics;
+  metrics.bytes_received.Add(received_bytes_);
+  // Отмена - не ошибка: так завершаются проигравшие дубли и брошенные
+  // потребителем потоки
+  bool cancelled = (request_.cancelled && request_.cancelled->load()) ||
+                   (sink_ && sink_->cancelled());
+  if (status_ >= 0) {
+    metrics.RecordStatus(status_);
+  } else if (!cancelled) {
+    metrics.RecordStatus(0);
+  }
+  metrics.finished.Add();
+}
+
+#ifdef AGENTIXX_TRACING
+void CurlTransfer::RecordSpan() {
+  SpanRecord span;
+  span.name = "http.request";
+  span.kind = SpanRecord::Kind::kClient;
+  span.trace_id_high = span_.trace_id_high;
+  span.trace_id_low = span_.trace_id_low;
+  span.span_id = span_.span_id;
+  span.parent_id = request_.trace.valid() ? request_.trace.span_id : 0;
+  span.start_ns = span_start_ns_;
+  span.end_ns = Tracer::Now();
+  if (status_ >= 0) {
+    span.attribute = "http.response.status_code";
+    span.attribute_value = status_;
+  }
+  request_.tracer->Record(span);
+}
+#endif
+
+HttpResponse CurlTransfer::TakeResponse(CURL* handle, CURLcode result) {
+  CheckResult(result, "CURL error: ");
+  ReadInfo(handle);
+  status_ = response_.status_code;
+  if (request_.metrics && response_.IsSuccess()) {
+    request_.metrics->Record(response_.metrics);
+  }
+  return std::move(response_);
+}
+
+HttpResponse CurlTransfer::FinishStream(CURL* handle, CURLcode result) {
+  CheckResult(result, "CURL streaming error: ");
+  ReadInfo(handle);
+  status_ = response_.status_code;
+
+  if (!response_.IsSuccess()) {
+    std::string message = "HTTP streaming error";
+    if (!response_.body.empty()) {
+      message += ": " + response_.body;
+    }
+    throw ApiError(response_.status_code, message, response_.headers);
+  }
+
+  // Поток без данных: потребитель узнает статус только сейчас
+  if (sink_) {
+    sink_->Start(response_);
+  }
+
+  // Убедимся что поток завершен
+  if (!finished_) {
+    finished_ = true;
+    FinishMetrics();
+    if (on_complete_) {
+      on_complete_();
+    }
+  }
+  return std::move(response_);
+}
+
+size_t CurlTransfer::WriteCallback(void* contents, size_t size, size_t nmemb,
+                                   CurlTransfer* transfer) {
+  size_t totalSize = size * nmemb;
+  transfer->response_.body.append(static_cast<char*>(contents), totalSize);
+  transfer->received_bytes_ += totalSize;
+  return totalSize;
+}
+
+size_t CurlTransfer::HeaderCallback(void* contents, size_t size, size_t nmemb,
+                                    CurlTransfer* transfer) {
+  size_t totalSize = size * nmemb;
+  std::string header(static_cast<char*>(contents), totalSize);
+
+  // Статусная строка нового ответа (редирект, 100 Continue)
+  if (header.compare(0, 5, "HTTP/") == 0) {
+    size_t space = header.find(' ');
+    transfer->response_.status_code =
+        space == std::string::npos ? 0 : std::atoi(header.c_str() + space + 1);
+    transfer->response_.headers.clear();
+    return totalSize;
+  }
+
+  // Найти разделитель ':'
+  size_t colonPos = header.find(':');
+  if (colonPos != std::string::npos) {
+    std::string key = header.substr(0, colonPos);
+    std::string value = header.substr(colonPos + 1);
+
+    // Убрать пробелы
+    key.erase(key.find_last_not_of(" \t\r\n") + 1);
+    value.erase(0, value.find_first_not_of(" \t\r\n"));
+    value.erase(value.find_last_not_of(" \t\r\n") + 1);
+
+    transfer->response_.headers[key] = value;
+  }
+
+  return totalSize;
+}
+
+// Callback для streaming данных (Server-Sent Events)
+size_t CurlTransfer::StreamingWriteCallback(void* contents, size_t size,
+                                            size_t nmemb,
+                                            CurlTransfer* transfer) {
+  size_t totalSize = size * nmemb;
+  if (transfer->finished_) {
+    transfer->received_bytes_ += totalSize;
+    return totalSize;
+  }
+
+  if (transfer->sink_) {
+    size_t result = transfer->CheckSink(totalSize);
+    if (result != totalSize) {
+      return result;
+    }
+  }
+  // Данные, отклоненные паузой, libcurl передаст повторно
+  transfer->received_bytes_ += totalSize;
+
+  try {
+    transfer->ProcessStreamData(static_cast<char*>(contents), totalSize);
+  } catch (...) {
+    // Исключения не должны проходить через C код libcurl
+    transfer->callback_error_ = std::current_exception();
+    return 0;
+  }
+  return totalSize;
+}
+
+size_t CurlTransfer::CheckSink(size_t size) {
+  if (sink_->cancelled()) {
+    callback_error_ =
+        std::make_exception_ptr(NetworkError("Stream cancelled by consumer"));
+    return 0;
+  }
+
+  // Первые данные: статус известен, потребитель может начинать чтение.
+  // Тело ответа с ошибкой придет в канал исключением по завершении
+  if (!started_) {
+    started_ = true;
+    ReadInfo(handle_);
+    if (response_.IsSuccess()) {
+      sink_->Start(response_);
+    }
+  }
+
+  if (sink_->Congested()) {
+    return CURL_WRITEFUNC_PAUSE;
+  }
+  return size;
+}
+
+int CurlTransfer::ProgressCallback(CurlTransfer* transfer, curl_off_t dltotal,
+                                   curl_off_t dlnow, curl_off_t ultotal,
+                                   curl_off_t ulnow) {
+  if (transfer->request_.cancelled && transfer->request_.cancelled->load()) {
+    transfer->callback_error_ =
+        std::make_exception_ptr(NetworkError("Request cancelled"));
+    return 1;
+  }
+  return transfer->sink_ && transfer->sink_->cancelled() ? 1 : 0;
+}
+
+void CurlTransfer::ProcessStreamData(const char* data, size_t size) {
+  // Тело ответа с ошибкой - обычный JSON, а не SSE
+  if (response_.status_code != 0 && !response_.IsSuccess()) {
+    response_.body.append(data, size);
+    return;
+  }
+
+  parser_.Feed(std::string_view(data, size), on_event_);
+}
+
+void CurlTransfer::ProcessEvent(const SseEvent& event) {
+  if (finished_ || event.data.empty()) {
+    return;
+  }
+  // Разбор chunk и callbacks потребителя в I/O потоке
+  AGENTIXX_TRACE_CHILD_SPAN(request_.tracer.get(), "sse.event", span_);
+
+  if (event.data == "[DONE]") {
+    // Конец потока
+    finished_ = true;
+    FinishMetrics();
+    if (on_complete_) {
+      on_complete_();
+    }
+    return;
+  }
+
+  // Поля chunk извлекаются без построения JSON DOM
+  StreamChunk chunk;
+  try {
+    chunk = StreamChunk::FromJson(event.data);
+  } catch (const ParseError& e) {
+    if (on_error_) {
+      on_error_("Failed to parse JSON chunk: " + std::string(e.what()));
+    }
+    return;
+  }
+  if (!chunk.content.empty() || !chunk.tool_calls.empty()) {
+    TrackToken();
+  }
+  if (chunk.usage) {
+    usage_ = chunk.usage;
+  }
+  if (on_chunk_) {
+    on_chunk_(chunk);
+  }
+}
+
+}  // namespace agentixx
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "agentixx/core/sse_parser.hpp"
+#include "agentixx/core/streaming.hpp"
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+class ChannelSink;
+
+// Состояние одного HTTP запроса поверх CURL easy handle.
+// Используется и блокирующим HttpClient, и EventLoop на curl_multi
+class CurlTransfer {
+ public:
+  explicit CurlTransfer(HttpRequest request);
+  ~CurlTransfer();
+
+  CurlTransfer(const CurlTransfer&) = delete;
+  CurlTransfer& operator=(const CurlTransfer&) = delete;
+
+  // Режим Server-Sent Events: chunks отдаются в callbacks по мере прихода
+  void ExpectStream(StreamCallback on_chunk, std::function<void()> on_complete,
+                    StreamErrorCallback on_error);
+
+  // Живой поток: chunks идут в очередь потребителя через sink, передача
+  // приостанавливается, пока очередь заполнена, и прерывается, если
+  // потребитель отказался от потока
+  void ExpectLiveStream(std::shared_ptr<ChannelSink> sink);
+
+  // Завершить передачу с ошибкой, не дожидаясь libcurl
+  void Fail(std::exception_ptr error) { callback_error_ = error; }
+
+  // Настроить handle под запрос. Handle должен быть сброшен заранее
+  void Attach(CURL* handle);
+
+  // Завершить обычный запрос: вернуть ответ или выбросить NetworkError
+  HttpResponse TakeResponse(CURL* handle, CURLcode result);
+
+  // Завершить streaming запрос: выбросить NetworkError/ApiError или
+  // вызвать on_complete, если поток не завершился через [DONE].
+  // Возвращает статус, заголовки и протокол ответа без тела
+  HttpResponse FinishStream(CURL* handle, CURLcode result);
+
+  const HttpRequest& request() const { return request_; }
+  // Статус, заголовки и протокол ответа
+  const HttpResponse& response() const { return response_; }
+
+ private:
+  HttpRequest request_;
+  struct curl_slist* curl_headers_ = nullptr;
+  HttpResponse response_;
+
+  // Streaming состояние
+  bool streaming_ = false;
+  StreamCallback on_chunk_;
+  std::function<void()> on_complete_;
+  StreamErrorCallback on_error_;
+  SseParser parser_;
+  SseParser::EventHandler on_event_;
+  bool finished_ = false;
+  std::shared_ptr<ChannelSink> sink_;
+  CURL* handle_ = nullptr;
+  bool started_ = false;
+
+  // Исключение из пользовательского callback, прервавшее передачу
+  std::exception_ptr callback_error_;
+
+  // Токены потока для RequestMetrics
+  long token_chunks_ = 0;
+  std::optional<TokenUsage> usage_;
+  double last_token_ms_ = 0;
+  double gaps_ms_ = 0;  // Сумма интервалов между токенами
+
+  // Счетчики request_.metrics
+  bool counted_ = false;  // Запрос учтен в started
+  int status_ = -1;       // Статус завершенного ответа, -1 - не завершен
+  uint64_t received_bytes_ = 0;
+
+#ifdef AGENTIXX_TRACING
+  // Span запроса в request_.tracer, родитель SSE событий. Пишется при
+  // уничтожении передачи
+  TraceContext span_;
+  int64_t span_start_ns_ = 0;
+  void RecordSpan();
+#endif
+
+  void ProcessStreamData(const char* data, size_t size);
+  void ProcessEvent(const SseEvent& event);
+  // Backpressure живого потока: 0 - прервать, CURL_WRITEFUNC_PAUSE -
+  // приостановить, иначе size - продолжать
+  size_t CheckSink(size_t size);
+  void CheckResult(CURLcode result, const char* what);
+  void ReadInfo(CURL* handle);
+  // Фазы запроса по таймерам libcurl
+  void ReadTimings(CURL* handle);
+  // Миллисекунды от начала запроса
+  double Elapsed() const;
+  // Пришел chunk с текстом или tool_calls
+  void TrackToken();
+  // Поток успешно завершен: итоговые метрики потребителю и в
+  // request_.metrics
+  void FinishMetrics();
+  // Учесть завершение запроса в счетчиках request_.metrics
+  void CountFinished();
+
+  static size_t WriteCallback(void* contents, size_t size, size_t nmemb,
+                              CurlTransfer* transfer);
+  static size_t StreamingWriteCallback(void* contents, size_t size,
+                                       size_t nmemb, CurlTransfer* transfer);
+  static size_t HeaderCallback(void* contents, size_t size, size_t nmemb,
+                               CurlTransfer* transfer);
+  static int ProgressCallback(CurlTransfer* transfer, curl_off_t dltotal,
+                              curl_off_t dlnow, curl_off_t ultotal,
+                              curl_off_t ulnow);
+};
+
+}  // namespace agentixx
@@ -0,0 +1,418 @@
+#include "agentixx/core/event_loop.hpp"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "channel_sink.hpp"
+#include "curl_global.hpp"
+#include "curl_share.hpp"
+#include "curl_transfer.hpp"
+
+namespace agentixx {
+
+class EventLoop::Impl {
+ private:
+  // Запрос, ожидающий выполнения в I/O потоке
+  struct Job {
+    std::unique_ptr<CurlTransfer> transfer;
+    // Вызывается в I/O потоке по завершении, handle == nullptr если цикл
+    // остановлен до начала передачи
+    std::function<void(CurlTransfer&, CURL*, CURLcode)> on_done;
+  };
+
+  // Сколько сброшенных easy handles держать для повторного использования
+  static constexpr size_t kMaxFreeHandles = 64;
+
+  CURLM* multi_;
+  std::thread thread_;
+  // DNS кэш и TLS сессии пула, nullptr - у каждого handle свои
+  std::shared_ptr<CurlShare> share_;
+
+  mutable std::mutex mutex_;
+  std::vector<Job> pending_;
+  std::vector<std::function<void()>> tasks_;
+  // Отложенные задачи по времени запуска
+  std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>
+      timers_;
+  bool stopping_ = false;
+  std::atomic<size_t> in_flight_{0};
+
+  // Доступны только из I/O потока
+  std::unordered_map<CURL*, Job> active_;
+  std::vector<CURL*> free_handles_;
+
+  void Run() {
+    std::vector<Job> submitted;
+    std::vector<std::function<void()>> tasks;
+    while (true) {
+      // Ожидание в poll не дольше, чем до ближайшей отложенной задачи
+      int timeout_ms = 1000;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+          break;
+        }
+        submitted.swap(pending_);
+        tasks.swap(tasks_);
+
+        auto now = std::chrono::steady_clock::now();
+        auto due = timers_.begin();
+        for (; due != timers_.end() && due->first <= now; ++due) {
+          tasks.push_back(std::move(due->second));
+        }
+        timers_.erase(timers_.begin(), due);
+        if (!timers_.empty()) {
+          auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+              timers_.begin()->first - now);
+          timeout_ms = static_cast<int>(
+              std::clamp<int64_t>(wait.count() + 1, 0, timeout_ms));
+        }
+      }
+
+      for (auto& job : submitted) {
+        StartJob(std::move(job));
+      }
+      submitted.clear();
+
+      for (auto& task : tasks) {
+        RunTask(task);
+      }
+      tasks.clear();
+
+      int running = 0;
+      curl_multi_perform(multi_, &running);
+
+      int queued = 0;
+      while (CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+        if (msg->msg == CURLMSG_DONE) {
+          Complete(msg->easy_handle, msg->data.result);
+        }
+      }
+
+      curl_multi_poll(multi_, nullptr, 0, timeout_ms, nullptr);
+    }
+
+    Shutdown();
+  }
+
+  void StartJob(Job job) {
+    CURL* handle = nullptr;
+    if (!free_handles_.empty()) {
+      handle = free_handles_.back();
+      free_handles_.pop_back();
+    } else {
+      handle = curl_easy_init();
+    }
+
+    if (!handle) {
+      Abort(job, "Failed to initialize CURL");
+      return;
+    }
+
+    job.transfer->Attach(handle);
+    if (share_) {
+      share_->Attach(handle);
+    }
+    if (curl_multi_add_handle(multi_, handle) != CURLM_OK) {
+      Recycle(handle);
+      Abort(job, "Failed to add transfer to event loop");
+      return;
+    }
+    active_.emplace(handle, std::move(job));
+  }
+
+  void Complete(CURL* handle, CURLcode result) {
+    curl_multi_remove_handle(multi_, handle);
+    auto it = active_.find(handle);
+    if (it == active_.end()) {
+      return;
+    }
+
+    Job job = std::move(it->second);
+    active_.erase(it);
+    Finish(job, handle, result);
+    Recycle(handle);
+  }
+
+  void Abort(Job& job, const std::string& reason) {
+    job.transfer->Fail(std::make_exception_ptr(NetworkError(reason)));
+    Finish(job, nullptr, CURLE_ABORTED_BY_CALLBACK);
+  }
+
+  void Finish(Job& job, CURL* handle, CURLcode result) {
+    --in_flight_;
+    try {
+      job.on_done(*job.transfer, handle, result);
+    } catch (...) {
+      // Исключение из пользовательского callback не должно остановить цикл
+    }
+  }
+
+  void RunTask(std::function<void()>& task) {
+    try {
+      task();
+    } catch (...) {
+      // Исключение из задачи не должно остановить цикл
+    }
+  }
+
+  void Recycle(CURL* handle) {
+    if (free_handles_.size() < kMaxFreeHandles) {
+      curl_easy_reset(handle);
+      free_handles_.push_back(handle);
+    } else {
+      curl_easy_cleanup(handle);
+    }
+  }
+
+  void Shutdown() {
+    for (auto& entry : active_) {
+      curl_multi_remove_handle(multi_, entry.first);
+      Abort(entry.second, "Event loop stopped");
+      curl_easy_cleanup(entry.first);
+    }
+    active_.clear();
+
+    std::vector<Job> pending;
+    std::vector<std::function<void()>> tasks;
+    decltype(timers_) timers;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending.swap(pending_);
+      tasks.swap(tasks_);
+      timers.swap(timers_);
+    }
+    for (auto& job : pending) {
+      Abort(job, "Event loop stopped");
+    }
+
+    // Задачи и таймеры выполняются сразу, не дожидаясь срока: повтор после
+    // паузы дойдет до Submit и получит NetworkError, а не потеряется молча
+    for (auto& task : tasks) {
+      RunTask(task);
+    }
+    for (auto& timer : timers) {
+      RunTask(timer.second);
+    }
+
+    for (CURL* handle : free_handles_) {
+      curl_easy_cleanup(handle);
+    }
+    free_handles_.clear();
+  }
+
+ public:
+  Impl(const EventLoopOptions& options, std::shared_ptr<CurlShare> share)
+      : share_(std::move(share)) {
+    EnsureCurlGlobalInit();
+    multi_ = curl_multi_init();
+    if (!multi_) {
+      throw NetworkError("Failed to initialize CURL multi handle");
+    }
+
+    // HTTP/2 потоки к одному host мультиплексируются в одно соединение
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#if LIBCURL_VERSION_NUM >= 0x074300
+    if (options.max_concurrent_streams > 0) {
+      curl_multi_setopt(multi_, CURLMOPT_MAX_CONCURRENT_STREAMS,
+                        static_cast<long>(options.max_concurrent_streams));
+    }
+#endif
+    if (options.max_connections_per_host > 0) {
+      curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS,
+                        static_cast<long>(options.max_connections_per_host));
+    }
+    if (options.max_total_connections > 0) {
+      curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                        static_cast<long>(options.max_total_connections));
+    }
+  }
+
+  ~Impl() { curl_multi_cleanup(multi_); }
+
+  // I/O поток держит ссылку на Impl, поэтому цикл можно отпустить
+  // даже из его собственного callback
+  void Start(std::shared_ptr<Impl> self) {
+    thread_ = std::thread([self = std::move(self)] { self->Run(); });
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    curl_multi_wakeup(multi_);
+    if (thread_.get_id() == std::this_thread::get_id()) {
+      thread_.detach();
+    } else {
+      thread_.join();
+    }
+  }
+
+  void Submit(std::unique_ptr<CurlTransfer> transfer,
+              std::function<void(CurlTransfer&, CURL*, CURLcode)> on_done) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        throw NetworkError("Event loop stopped");
+      }
+      pending_.push_back({std::move(transfer), std::move(on_done)});
+      ++in_flight_;
+    }
+    curl_multi_wakeup(multi_);
+  }
+
+  void Post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        throw NetworkError("Event loop stopped");
+      }
+      tasks_.push_back(std::move(task));
+    }
+    curl_multi_wakeup(multi_);
+  }
+
+  void PostAfter(std::chrono::milliseconds delay, std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        throw NetworkError("Event loop stopped");
+      }
+      timers_.emplace(std::chrono::steady_clock::now() + delay,
+                      std::move(task));
+    }
+    curl_multi_wakeup(multi_);
+  }
+
+  size_t InFlight() const { return in_flight_.load(); }
+};
+
+// Реализация публичных методов EventLoop
+
+EventLoop::EventLoop(const EventLoopOptions& options)
+    : EventLoop(options, nullptr) {}
+
+EventLoop::EventLoop(const EventLoopOptions& options,
+                     std::shared_ptr<CurlShare> share)
+    : pimpl_(std::make_shared<Impl>(options, std::move(share))) {
+  pimpl_->Start(pimpl_);
+}
+
+EventLoop::~EventLoop() { pimpl_->Stop(); }
+
+std::future<HttpResponse> EventLoop::Send(HttpRequest request) {
+  auto promise = std::make_shared<std::promise<HttpResponse>>();
+  auto future = promise->get_future();
+
+  Send(
+      std::move(request),
+      [promise](HttpResponse response) {
+        promise->set_value(std::move(response));
+      },
+      [promise](std::exception_ptr error) { promise->set_exception(error); });
+
+  return future;
+}
+
+void EventLoop::Send(HttpRequest request, ResponseCallback on_response,
+                     ErrorCallback on_error) {
+  auto transfer = std::make_unique<CurlTransfer>(std::move(request));
+
+  pimpl_->Submit(std::move(transfer),
+                 [on_response = std::move(on_response),
+                  on_error = std::move(on_error)](
+                     CurlTransfer& transfer, CURL* handle, CURLcode result) {
+                   HttpResponse response;
+                   try {
+                     response = transfer.TakeResponse(handle, result);
+                   } catch (...) {
+                     if (on_error) {
+                       on_error(std::current_exception());
+                     }
+                     return;
+                   }
+                   if (on_response) {
+                     on_response(std::move(response));
+                   }
+                 });
+}
+
+std::future<HttpResponse> EventLoop::SendStream(
+    HttpRequest request, StreamCallback on_chunk,
+    std::function<void()> on_complete, StreamErrorCallback on_error) {
+  auto promise = std::make_shared<std::promise<HttpResponse>>();
+  auto future = promise->get_future();
+
+  auto transfer = std::make_unique<CurlTransfer>(std::move(request));
+  transfer->ExpectStream(std::move(on_chunk), std::move(on_complete),
+                         std::move(on_error));
+
+  pimpl_->Submit(std::move(transfer), [promise](CurlTransfer& transfer,
+                                                CURL* handle, CURLcode result) {
+    try {
+      promise->set_value(transfer.FinishStream(handle, result));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+
+  return future;
+}
+
+void EventLoop::SendStream(HttpRequest request,
+                           std::shared_ptr<StreamChannel> channel) {
+  // Задачи sink держат Impl слабо: цикл может быть уже остановлен.
+  // Остановленный цикл сам закрыл канал, Resume больше не нужен
+  std::weak_ptr<Impl> weak = pimpl_;
+  auto sink = std::make_shared<ChannelSink>(
+      std::move(channel), [weak](std::function<void()> task) {
+        if (auto impl = weak.lock()) {
+          try {
+            impl->Post(std::move(task));
+          } catch (const NetworkError&) {
+          }
+        }
+      });
+  sink->Connect();
+
+  auto transfer = std::make_unique<CurlTransfer>(std::move(request));
+  transfer->ExpectLiveStream(sink);
+
+  try {
+    pimpl_->Submit(std::move(transfer), [sink](CurlTransfer& transfer,
+                                               CURL* handle, CURLcode result) {
+      try {
+        transfer.FinishStream(handle, result);
+        sink->Finish(nullptr);
+      } catch (...) {
+        sink->Finish(std::current_exception());
+      }
+    });
+  } catch (...) {
+    // Закрываем канал, иначе он и sink удерживают друг друга
+    sink->Finish(std::current_exception());
+    throw;
+  }
+}
+
+void EventLoop::Post(std::function<void()> task) {
+  pimpl_->Post(std::move(task));
+}
+
+void EventLoop::PostAfter(std::chrono::milliseconds delay,
+                          std::function<void()> task) {
+  pimpl_->PostAfter(delay, std::move(task));
+}
+
+size_t EventLoop::InFlight() const { return pimpl_->InFlight(); }
+
+}  // namespace agentixx
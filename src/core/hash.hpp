@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace agentixx {
+
+// Быстрый некриптографический 64-битный хеш для ключей кэша.
+//
+// Данные читаются словами по 8 байт: умножение и сдвиг на слово, в конце
+// перемешивание как в MurmurHash3 (fmix64). Результат не зависит от
+// компилятора и запуска, поэтому годится и для ключей на диске (на
+// машинах с одинаковым порядком байт).
+
+namespace hash_detail {
+
+constexpr uint64_t kMul1 = 0x9e3779b97f4a7c15ull;
+constexpr uint64_t kMul2 = 0xc2b2ae3d27d4eb4full;
+
+inline uint64_t Load64(const char* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline uint64_t Rotl(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t Fmix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+}  // namespace hash_detail
+
+inline uint64_t HashBytes(std::string_view bytes, uint64_t seed = 0) {
+  using namespace hash_detail;
+  const char* data = bytes.data();
+  size_t size = bytes.size();
+  uint64_t h = seed ^ (size * kMul1);
+
+  // Четыре независимые цепочки, чтобы умножения шли параллельно
+  if (size >= 32) {
+    uint64_t v[4] = {h, h + kMul1, h + kMul2, h - kMul1};
+    for (; size >= 32; data += 32, size -= 32) {
+      for (int i = 0; i < 4; ++i) {
+        v[i] = Rotl(v[i] ^ (Load64(data + 8 * i) * kMul2), 31) * kMul1;
+      }
+    }
+    h = Rotl(v[0], 1) + Rotl(v[1], 7) + Rotl(v[2], 12) + Rotl(v[3], 18);
+  }
+  for (; size >= 8; data += 8, size -= 8) {
+    h = Rotl(h ^ (Load64(data) * kMul2), 27) * kMul1;
+  }
+  if (size > 0) {
+    uint64_t tail = 0;
+    std::memcpy(&tail, data, size);
+    h = Rotl(h ^ (tail * kMul2), 31) * kMul1;
+  }
+  return Fmix(h);
+}
+
+}  // namespace agentixx
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <strings.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+// Значение заголовка без учета регистра имени, nullptr - нет заголовка
+inline const std::string* FindHeader(const Headers& headers,
+                                     const char* name) {
+  for (const auto& header : headers) {
+    if (strcasecmp(header.first.c_str(), name) == 0) {
+      return &header.second;
+    }
+  }
+  return nullptr;
+}
+
+// Пауза из retry-after-ms (OpenAI) или Retry-After в секундах. Форма
+// Retry-After с HTTP датой не поддерживается
+inline bool ParseRetryAfter(const Headers& headers,
+                            std::chrono::milliseconds* delay) {
+  double scale = 1;
+  const std::string* value = FindHeader(headers, "retry-after-ms");
+  if (!value) {
+    value = FindHeader(headers, "retry-after");
+    scale = 1000;
+  }
+  if (!value || value->empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  double number = std::strtod(value->c_str(), &end);
+  if (end == value->c_str() || number < 0) {
+    return false;
+  }
+  *delay = std::chrono::milliseconds(static_cast<int64_t>(number * scale));
+  return true;
+}
+
+}  // namespace agentixx
@@ -0,0 +1,68 @@
+#include "hedger.hpp"
+
+#include <algorithm>
+
+namespace agentixx {
+
+Hedger::Hedger(const HedgingPolicy& policy) : policy_(policy) {
+  policy_.window = std::max<size_t>(policy_.window, 1);
+  policy_.min_samples = std::min(policy_.min_samples, policy_.window);
+  for (Window& window : windows_) {
+    window.samples.reserve(policy_.window);
+  }
+}
+
+Hedger::Clock::duration Hedger::Delay(Kind kind) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++requests_;
+  const Window& window = windows_[static_cast<int>(kind)];
+  Clock::duration delay = std::chrono::milliseconds(policy_.initial_delay_ms);
+  if (window.samples.size() >= std::max<size_t>(policy_.min_samples, 1)) {
+    delay = window.delay;
+  }
+  return std::max<Clock::duration>(
+      delay, std::chrono::milliseconds(policy_.min_delay_ms));
+}
+
+bool Hedger::TryHedge() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<double>(hedged_ + 1) > policy_.budget * requests_) {
+    return false;
+  }
+  ++hedged_;
+  return true;
+}
+
+void Hedger::Record(Kind kind, Clock::duration latency, bool hedge_won) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (hedge_won) {
+    ++hedge_wins_;
+  }
+
+  Window& window = windows_[static_cast<int>(kind)];
+  if (window.samples.size() < policy_.window) {
+    window.samples.push_back(latency);
+  } else {
+    window.samples[window.next] = latency;
+    window.next = (window.next + 1) % policy_.window;
+  }
+
+  // Окно в сотни замеров: nth_element по копии дешевле сетевого запроса
+  std::vector<Clock::duration>& sorted = scratch_;
+  sorted.assign(window.samples.begin(), window.samples.end());
+  double rank = std::clamp(policy_.percentile, 0.0, 1.0) * (sorted.size() - 1);
+  auto nth = sorted.begin() + static_cast<size_t>(rank + 0.5);
+  std::nth_element(sorted.begin(), nth, sorted.end());
+  window.delay = *nth;
+}
+
+HedgingStats Hedger::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  HedgingStats stats;
+  stats.requests = requests_;
+  stats.hedged = hedged_;
+  stats.hedge_wins = hedge_wins_;
+  return stats;
+}
+
+}  // namespace agentixx
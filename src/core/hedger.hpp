@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "agentixx/core/http_client.hpp"
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+// Задержка и бюджет дублей по HedgingPolicy.
+//
+// Задержки ответов и первых chunks потоков считаются в отдельных окнах:
+// первый chunk приходит намного раньше полного ответа. Перцентиль
+// пересчитывается при записи замера, а Delay только читает готовое значение
+class Hedger {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Kind {
+    kResponse,    // Полный ответ обычного запроса
+    kFirstChunk,  // Первый chunk потока
+  };
+
+  explicit Hedger(const HedgingPolicy& policy);
+
+  // Начало запроса: сколько ждать ответа до отправки дубля
+  Clock::duration Delay(Kind kind);
+  // Разрешить дубль, если он укладывается в бюджет
+  bool TryHedge();
+  // Запрос завершен за latency, hedge_won - ответил дубль
+  void Record(Kind kind, Clock::duration latency, bool hedge_won);
+
+  HedgingStats stats() const;
+
+ private:
+  struct Window {
+    std::vector<Clock::duration> samples;  // Кольцо последних замеров
+    size_t next = 0;
+    Clock::duration delay{0};  // Перцентиль samples
+  };
+
+  HedgingPolicy policy_;
+  mutable std::mutex mutex_;
+  Window windows_[2];
+  std::vector<Clock::duration> scratch_;  // Буфер для расчета перцентиля
+  uint64_t requests_ = 0;
+  uint64_t hedged_ = 0;
+  uint64_t hedge_wins_ = 0;
+};
+
+}  // namespace agentixx
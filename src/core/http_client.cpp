@@ -2,292 +2,717 @@
 
 #include <curl/curl.h>
 
-#include <iostream>
-#include <sstream>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "agentixx/core/rate_limiter.hpp"
+#include "agentixx/core/tracing.hpp"
+#include "connection_pool_impl.hpp"
+#include "curl_global.hpp"
+#include "curl_transfer.hpp"
+#include "headers.hpp"
+#include "hedger.hpp"
+#include "retry.hpp"
 
 namespace agentixx {
 
+namespace {
+
+// Поток-победитель hedging: первый chunk уже прочитан при выборе
+struct PeekedStream {
+  std::shared_ptr<StreamChannel> channel;
+  std::optional<StreamChunk> first;
+
+  // Ответ уничтожен до конца потока: прерываем передачу, как ~State
+  ~PeekedStream() { channel->Cancel(); }
+
+  bool Next(StreamChunk* chunk) {
+    if (first) {
+      *chunk = std::move(*first);
+      first.reset();
+      return true;
+    }
+    return channel->Next(chunk);
+  }
+};
+
+// Получатель асинхронного запроса. Не ссылается на HttpClient: повторы
+// после паузы выполняются, когда клиента может уже не быть
+struct AsyncTarget {
+  std::shared_ptr<EventLoop> loop;
+  std::shared_ptr<RateLimiter> limiter;  // nullptr - без ограничения
+  std::string limit_key;
+  double tokens = 0;  // Оценка токенов запроса для limiter
+};
+
+// Отправить запрос в цикл, когда его пропустит limiter. Ждет в очереди
+// limiter, не блокируя вызывающий поток: так можно и из I/O потока
+void SendAsync(const AsyncTarget& target, HttpRequest request,
+               EventLoop::ResponseCallback on_response,
+               EventLoop::ErrorCallback on_error) {
+  if (!target.limiter) {
+    target.loop->Send(std::move(request), std::move(on_response),
+                      std::move(on_error));
+    return;
+  }
+
+  target.limiter->Enqueue(
+      target.limit_key, target.tokens,
+      [target, request = std::move(request),
+       on_response = std::move(on_response),
+       on_error = std::move(on_error)] {
+        try {
+          target.loop->Send(
+              request,
+              [target, on_response](HttpResponse response) {
+                target.limiter->Update(target.limit_key, response.status_code,
+                                       response.headers);
+                if (on_response) {
+                  on_response(std::move(response));
+                }
+              },
+              on_error);
+        } catch (...) {
+          if (on_error) {
+            on_error(std::current_exception());
+          }
+        }
+      });
+}
+
+// Асинхронный запрос с повторами по RetryPolicy. Пауза между попытками
+// ждется таймером EventLoop, поток не блокируется
+struct AsyncRetry : std::enable_shared_from_this<AsyncRetry> {
+  AsyncTarget target;
+  HttpRequest request;
+  RetryTracker tracker;
+  EventLoop::ResponseCallback on_response;
+  EventLoop::ErrorCallback on_error;
+
+  AsyncRetry(AsyncTarget target, HttpRequest request,
+             const RetryPolicy& policy, EventLoop::ResponseCallback on_response,
+             EventLoop::ErrorCallback on_error)
+      : target(std::move(target)),
+        request(std::move(request)),
+        tracker(policy),
+        on_response(std::move(on_response)),
+        on_error(std::move(on_error)) {}
+
+  void Attempt() {
+    HttpRequest attempt = request;
+    attempt.timeout_ms = tracker.AttemptTimeout(request.timeout_ms);
+    auto self = shared_from_this();
+    SendAsync(
+        target, std::move(attempt),
+        [self](HttpResponse response) {
+          std::chrono::milliseconds retry_after;
+          std::chrono::milliseconds delay;
+          bool has_retry_after =
+              ParseRetryAfter(response.headers, &retry_after);
+          if (!response.IsSuccess() &&
+              self->tracker.Next(response.status_code,
+                                 has_retry_after ? &retry_after : nullptr,
+                                 &delay)) {
+            self->Retry(delay);
+          } else if (self->on_response) {
+            self->on_response(std::move(response));
+          }
+        },
+        [self](std::exception_ptr error) {
+          std::chrono::milliseconds delay;
+          if (self->tracker.Next(error, &delay)) {
+            self->Retry(delay);
+          } else if (self->on_error) {
+            self->on_error(error);
+          }
+        });
+  }
+
+  // Ошибка Attempt после паузы и отказ остановленного цикла принять
+  // таймер одинаково завершают запрос через on_error
+  void Retry(std::chrono::milliseconds delay) {
+    auto self = shared_from_this();
+    try {
+      target.loop->PostAfter(delay, [self] {
+        try {
+          self->Attempt();
+        } catch (...) {
+          self->Fail(std::current_exception());
+        }
+      });
+    } catch (...) {
+      Fail(std::current_exception());
+    }
+  }
+
+  void Fail(std::exception_ptr error) {
+    if (on_error) {
+      on_error(error);
+    }
+  }
+};
+
+}  // namespace
+
 // PIMPL реализация для скрытия libcurl деталей
 class HttpClient::Impl {
  private:
-  CURL* curl_;
   Config config_;
+  // Пул handles: общий из Config или собственный. Каждый запрос арендует
+  // отдельный handle, поэтому клиент можно вызывать из нескольких потоков
+  std::shared_ptr<ConnectionPool> pool_;
+  std::atomic<int> timeout_ms_;
 
-  // Callback для записи данных ответа
-  static size_t WriteCallback(void* contents, size_t size, size_t nmemb,
-                              std::string* userp) {
-    size_t totalSize = size * nmemb;
-    userp->append((char*)contents, totalSize);
-    return totalSize;
-  }
+  // I/O цикл для асинхронных запросов, создается при первом использовании
+  std::mutex loop_mutex_;
+  std::shared_ptr<EventLoop> loop_;
 
-  // Callback для записи заголовков
-  static size_t HeaderCallback(void* contents, size_t size, size_t nmemb,
-                               Headers* headers) {
-    size_t totalSize = size * nmemb;
-    std::string header((char*)contents, totalSize);
+  // nullptr - hedging выключен
+  std::unique_ptr<Hedger> hedger_;
 
-    // Найти разделитель ':'
-    size_t colonPos = header.find(':');
-    if (colonPos != std::string::npos) {
-      std::string key = header.substr(0, colonPos);
-      std::string value = header.substr(colonPos + 1);
+  // Общий limiter из Config и ключ его ведер, nullptr - без ограничения
+  std::shared_ptr<RateLimiter> limiter_;
+  std::string limit_key_;
 
-      // Убрать пробелы
-      key.erase(key.find_last_not_of(" \t\r\n") + 1);
-      value.erase(0, value.find_first_not_of(" \t\r\n"));
-      value.erase(value.find_last_not_of(" \t\r\n") + 1);
+  // Куда писать метрики успешных ответов, nullptr - никуда
+  std::shared_ptr<EndpointMetrics> metrics_;
 
-      (*headers)[key] = value;
+  // Выполнить запрос на handle, арендованном из пула
+  template <typename Perform>
+  void WithHandle(const std::string& url, Perform&& perform) {
+    auto lease = pool_->pimpl_->Acquire(url);
+    try {
+      perform(lease.handle());
+    } catch (const NetworkError&) {
+      lease.MarkUnhealthy();
+      throw;
     }
+  }
+
+  // timeout_ms == 0 - таймаут клиента
+  HttpRequest MakeRequest(const std::string& method, const std::string& url,
+                          const std::string& body, const Headers& headers,
+                          int timeout_ms = 0) const {
+    HttpRequest request;
+    request.method = method;
+    request.url = url;
+    request.body = body;
+    request.timeout_ms = timeout_ms > 0 ? timeout_ms : timeout_ms_.load();
+    request.http_version = config_.http_version;
+    request.metrics = metrics_;
+#ifdef AGENTIXX_TRACING
+    if (config_.tracer) {
+      request.tracer = config_.tracer;
+      request.trace = Tracer::Current();
+    }
+#endif
 
-    return totalSize;
+    // Установка заголовков
+    request.headers = config_.default_headers;
+    for (const auto& header : headers) {
+      request.headers[header.first] = header.second;
+    }
+    return request;
   }
 
-  // Структура для streaming callback
-  struct StreamingCallbackData {
-    StreamCallback on_chunk;
-    std::function<void()> on_complete;
-    StreamErrorCallback on_error;
-    std::string buffer;
-    bool finished = false;
-  };
-
-  // Callback для streaming данных (Server-Sent Events)
-  static size_t StreamingWriteCallback(void* contents, size_t size,
-                                       size_t nmemb,
-                                       StreamingCallbackData* data) {
-    size_t totalSize = size * nmemb;
-    std::string chunk((char*)contents, totalSize);
-    data->buffer += chunk;
-
-    // Обрабатываем SSE события построчно
-    size_t pos = 0;
-    while ((pos = data->buffer.find('\n')) != std::string::npos) {
-      std::string line = data->buffer.substr(0, pos);
-      data->buffer.erase(0, pos + 1);
-
-      // Убираем \r если есть
-      if (!line.empty() && line.back() == '\r') {
-        line.pop_back();
-      }
+  // В режиме HTTP/2 блокирующие вызовы тоже идут через EventLoop:
+  // мультиплексировать потоки в одно соединение умеет только curl_multi
+  bool multiplexed() const {
+    return config_.http_version == HttpVersion::kHttp2 ||
+           config_.http_version == HttpVersion::kHttp2PriorKnowledge;
+  }
 
-      // Парсим SSE формат
-      if (line.length() >= 6 && line.substr(0, 6) == "data: ") {
-        std::string json_data = line.substr(6);
+  // Цикл из Config или цикл пула: клиенты одного пула делят и кэш
+  // соединений curl_multi
+  std::shared_ptr<EventLoop> SharedLoop() {
+    std::lock_guard<std::mutex> lock(loop_mutex_);
+    if (!loop_) {
+      loop_ = config_.event_loop ? config_.event_loop : pool_->pimpl_->Loop();
+    }
+    return loop_;
+  }
 
-        if (json_data == "[DONE]") {
-          // Конец потока
-          data->finished = true;
-          if (data->on_complete) {
-            data->on_complete();
-          }
-          break;
-        } else if (!json_data.empty()) {
-          // Парсим JSON chunk
-          try {
-            Json chunk_json = Json::parse(json_data);
-            StreamChunk chunk(chunk_json);
-            if (data->on_chunk) {
-              data->on_chunk(chunk);
-            }
-          } catch (const nlohmann::json::parse_error& e) {
-            if (data->on_error) {
-              data->on_error("Failed to parse JSON chunk: " +
-                             std::string(e.what()));
-            }
-          }
-        }
+  EventLoop& loop() { return *SharedLoop(); }
+
+  // Передать limiter_ статус и заголовки ответа
+  void Observe(const HttpResponse& response) {
+    if (limiter_) {
+      limiter_->Update(limit_key_, response.status_code, response.headers);
+    }
+  }
+
+  // Ошибки потоков приходят исключением, заголовки ответа с Retry-After
+  // лежат в ApiError
+  void ObserveError(const std::exception_ptr& error) {
+    if (!limiter_) {
+      return;
+    }
+    try {
+      std::rethrow_exception(error);
+    } catch (const ApiError& e) {
+      if (e.status_code == 429) {
+        limiter_->Update(limit_key_, e.status_code, e.headers);
       }
+    } catch (...) {
     }
+  }
 
-    return totalSize;
+  // Поток без limiter_: для дублей, уже занявших место в лимите
+  std::shared_ptr<StreamChannel> OpenChannel(const std::string& url,
+                                             const std::string& body,
+                                             const Headers& headers) {
+    auto channel = std::make_shared<StreamChannel>(config_.stream_queue_size);
+    loop().SendStream(MakeRequest("POST", url, body, headers), channel);
+    return channel;
   }
 
- public:
-  explicit Impl(const Config& config) : config_(config) {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl_ = curl_easy_init();
-    if (!curl_) {
-      throw NetworkError("Failed to initialize CURL");
+  HttpResponse WaitStarted(StreamChannel& channel) {
+    HttpResponse info;
+    try {
+      info = channel.WaitStarted();
+    } catch (...) {
+      ObserveError(std::current_exception());
+      throw;
     }
-
-    // Базовые настройки
-    curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS, config_.timeout_ms);
-    curl_easy_setopt(curl_, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl_, CURLOPT_SSL_VERIFYPEER, 1L);
-    curl_easy_setopt(curl_, CURLOPT_SSL_VERIFYHOST, 2L);
+    Observe(info);
+    return info;
   }
 
-  ~Impl() {
-    if (curl_) {
-      curl_easy_cleanup(curl_);
+ public:
+  explicit Impl(const Config& config)
+      : config_(config),
+        pool_(config.connection_pool),
+        timeout_ms_(config.timeout_ms) {
+    EnsureCurlGlobalInit();
+    if (!pool_) {
+      pool_ = std::make_shared<ConnectionPool>();
+    }
+    if (config.hedging.enabled()) {
+      hedger_ = std::make_unique<Hedger>(config.hedging);
+    }
+    if (config.rate_limiter) {
+      limiter_ = config.rate_limiter;
+      limit_key_ = RateLimiter::Key(config.base_url, config.api_key);
     }
-    curl_global_cleanup();
   }
 
   HttpResponse get(const std::string& url, const Headers& headers) {
     return make_request(url, "GET", "", headers);
   }
 
+  // Ответ с ошибкой после всех повторов возвращается как есть, ошибка
+  // передачи выбрасывается
   HttpResponse post(const std::string& url, const std::string& body,
                     const Headers& headers) {
-    return make_request(url, "POST", body, headers);
-  }
+    if (!config_.retry.enabled()) {
+      return PostOnce(url, body, headers, 0);
+    }
 
-  void SetTimeout(int timeout_ms) {
-    config_.timeout_ms = timeout_ms;
-    curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS, timeout_ms);
-  }
+    RetryTracker tracker(config_.retry);
+    std::chrono::milliseconds delay;
+    while (true) {
+      HttpResponse response;
+      try {
+        response = PostOnce(url, body, headers,
+                            tracker.AttemptTimeout(timeout_ms_.load()));
+      } catch (...) {
+        if (!tracker.Next(std::current_exception(), &delay)) {
+          throw;
+        }
+        std::this_thread::sleep_for(delay);
+        continue;
+      }
 
-  StreamingResponse PostStream(const std::string& url, const std::string& body,
-                               const Headers& headers) {
-    StreamingResponse streaming_response;
+      std::chrono::milliseconds retry_after;
+      bool has_retry_after = ParseRetryAfter(response.headers, &retry_after);
+      if (response.IsSuccess() ||
+          !tracker.Next(response.status_code,
+                        has_retry_after ? &retry_after : nullptr, &delay)) {
+        return response;
+      }
+      std::this_thread::sleep_for(delay);
+    }
+  }
 
-    PostStreamAsync(
+  std::future<HttpResponse> PostAsync(const std::string& url,
+                                      const std::string& body,
+                                      const Headers& headers) {
+    if (!limiter_ && !config_.retry.enabled()) {
+      return loop().Send(MakeRequest("POST", url, body, headers));
+    }
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    auto future = promise->get_future();
+    PostAsync(
         url, body, headers,
-        [&streaming_response](const StreamChunk& chunk) {
-          streaming_response.AddChunk(chunk);
+        [promise](HttpResponse response) {
+          promise->set_value(std::move(response));
         },
-        [&streaming_response]() { streaming_response.finish(); },
-        [](const std::string& error) {
-          throw NetworkError("Streaming error: " + error);
-        });
-
-    return streaming_response;
+        [promise](std::exception_ptr error) { promise->set_exception(error); });
+    return future;
   }
 
-  void PostStreamAsync(const std::string& url, const std::string& body,
-                       const Headers& headers, StreamCallback on_chunk,
-                       std::function<void()> on_complete,
-                       StreamErrorCallback on_error) {
-    struct curl_slist* curl_headers = nullptr;
-    StreamingCallbackData callback_data{on_chunk, on_complete, on_error, "",
-                                        false};
-
-    try {
-      // Настройка URL и POST метода
-      curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-      curl_easy_setopt(curl_, CURLOPT_POST, 1L);
-      curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body.c_str());
-      curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, body.length());
-
-      // Установка заголовков
-      Headers all_headers = config_.default_headers;
-      for (const auto& header : headers) {
-        all_headers[header.first] = header.second;
-      }
-
-      // Добавляем Accept для SSE
-      all_headers["Accept"] = "text/event-stream";
-      all_headers["Cache-Control"] = "no-cache";
+  void PostAsync(const std::string& url, const std::string& body,
+                 const Headers& headers,
+                 EventLoop::ResponseCallback on_response,
+                 EventLoop::ErrorCallback on_error) {
+    AsyncTarget target;
+    target.loop = SharedLoop();
+    if (limiter_) {
+      target.limiter = limiter_;
+      target.limit_key = limit_key_;
+      target.tokens = limiter_->EstimateTokens(body);
+    }
+    HttpRequest request = MakeRequest("POST", url, body, headers);
+    if (!config_.retry.enabled()) {
+      SendAsync(target, std::move(request), std::move(on_response),
+                std::move(on_error));
+      return;
+    }
+    std::make_shared<AsyncRetry>(std::move(target), std::move(request),
+                                 config_.retry, std::move(on_response),
+                                 std::move(on_error))
+        ->Attempt();
+  }
 
-      for (const auto& header : all_headers) {
-        std::string header_str = header.first + ": " + header.second;
-        curl_headers = curl_slist_append(curl_headers, header_str.c_str());
-      }
-      curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, curl_headers);
+  void SetTimeout(int timeout_ms) { timeout_ms_ = timeout_ms; }
+  void SetMetrics(std::shared_ptr<EndpointMetrics> metrics) {
+    metrics_ = std::move(metrics);
+  }
 
-      // Настройка streaming callback
-      curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, StreamingWriteCallback);
-      curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &callback_data);
+  // Поток читается из I/O цикла по мере прихода данных. Возвращаемся,
+  // как только известен статус ответа: ошибки API выбрасываются здесь,
+  // а chunks потребитель получает, пока генерация еще идет
+  std::shared_ptr<StreamChannel> OpenStream(const std::string& url,
+                                            const std::string& body,
+                                            const Headers& headers) {
+    if (!limiter_) {
+      return OpenChannel(url, body, headers);
+    }
 
-      // Выполнение запроса
-      CURLcode res = curl_easy_perform(curl_);
+    auto channel = std::make_shared<StreamChannel>(config_.stream_queue_size);
+    limiter_->Enqueue(
+        limit_key_, limiter_->EstimateTokens(body),
+        [loop = SharedLoop(), channel,
+         request = MakeRequest("POST", url, body, headers)] {
+          // Потребитель отказался от потока, пока тот ждал в очереди
+          if (channel->cancelled()) {
+            return;
+          }
+          try {
+            loop->SendStream(request, channel);
+          } catch (...) {
+            // SendStream уже закрыл канал с этой ошибкой
+          }
+        });
+    return channel;
+  }
 
-      if (res != CURLE_OK) {
-        throw NetworkError(std::string("CURL streaming error: ") +
-                           curl_easy_strerror(res));
+  // С повторами поток возвращается после первого chunk: до него ошибку
+  // можно повторить, не отдав потребителю лишних токенов
+  StreamingResponse PostStream(const std::string& url, const std::string& body,
+                               const Headers& headers) {
+    if (!config_.retry.enabled()) {
+      if (hedger_) {
+        return HedgedStream(url, body, headers);
       }
+      auto channel = OpenStream(url, body, headers);
+      HttpResponse info = WaitStarted(*channel);
 
-      // Проверка статуса ответа
-      long response_code;
-      curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &response_code);
-
-      if (response_code < 200 || response_code >= 300) {
-        throw ApiError(static_cast<int>(response_code), "HTTP streaming error");
-      }
+      StreamingResponse streaming_response(std::move(channel),
+                                           config_.stream_retention);
+      streaming_response.SetProtocol(info.protocol);
+      return streaming_response;
+    }
 
-    } catch (...) {
-      if (curl_headers) {
-        curl_slist_free_all(curl_headers);
+    RetryTracker tracker(config_.retry);
+    std::chrono::milliseconds delay;
+    while (true) {
+      try {
+        return hedger_ ? HedgedStream(url, body, headers)
+                       : FirstChunkStream(url, body, headers);
+      } catch (...) {
+        if (!tracker.Next(std::current_exception(), &delay)) {
+          throw;
+        }
       }
-      throw;
+      std::this_thread::sleep_for(delay);
     }
+  }
 
-    if (curl_headers) {
-      curl_slist_free_all(curl_headers);
-    }
+  HedgingStats hedging_stats() const {
+    return hedger_ ? hedger_->stats() : HedgingStats{};
+  }
 
-    // Убедимся что поток завершен
-    if (!callback_data.finished && on_complete) {
-      on_complete();
+  std::future<HttpResponse> PostStreamAsync(
+      const std::string& url, const std::string& body, const Headers& headers,
+      StreamCallback on_chunk, std::function<void()> on_complete,
+      StreamErrorCallback on_error) {
+    // Future завершается только с потоком, поэтому очередь limiter
+    // ожидается здесь, в вызывающем потоке
+    if (limiter_) {
+      limiter_->Acquire(limit_key_, limiter_->EstimateTokens(body));
     }
+    return loop().SendStream(MakeRequest("POST", url, body, headers),
+                             std::move(on_chunk), std::move(on_complete),
+                             std::move(on_error));
   }
 
  private:
-  HttpResponse make_request(const std::string& url, const std::string& method,
-                            const std::string& body, const Headers& headers) {
+  // Одна попытка post. timeout_ms == 0 - таймаут клиента
+  HttpResponse PostOnce(const std::string& url, const std::string& body,
+                        const Headers& headers, int timeout_ms) {
+    if (limiter_) {
+      limiter_->Acquire(limit_key_, limiter_->EstimateTokens(body));
+    }
     HttpResponse response;
-    struct curl_slist* curl_headers = nullptr;
+    if (hedger_) {
+      response = HedgedPost(url, body, headers, timeout_ms);
+    } else if (multiplexed()) {
+      HttpRequest request = MakeRequest("POST", url, body, headers, timeout_ms);
+      response = loop().Send(std::move(request)).get();
+    } else {
+      response = make_request(url, "POST", body, headers, timeout_ms);
+    }
+    Observe(response);
+    return response;
+  }
 
-    try {
-      // Настройка URL
-      curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-
-      // Настройка метода
-      if (method == "POST") {
-        curl_easy_setopt(curl_, CURLOPT_POST, 1L);
-        if (!body.empty()) {
-          curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body.c_str());
-          curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, body.length());
-        }
-      } else if (method == "GET") {
-        curl_easy_setopt(curl_, CURLOPT_HTTPGET, 1L);
-      }
+  // Поток, прочитанный до первого chunk
+  StreamingResponse FirstChunkStream(const std::string& url,
+                                     const std::string& body,
+                                     const Headers& headers) {
+    auto peeked = std::make_shared<PeekedStream>();
+    peeked->channel = OpenStream(url, body, headers);
+    HttpResponse info = WaitStarted(*peeked->channel);
+    StreamChunk chunk;
+    if (peeked->channel->Next(&chunk)) {
+      peeked->first = std::move(chunk);
+    }
 
-      // Установка заголовков
-      Headers all_headers = config_.default_headers;
-      for (const auto& header : headers) {
-        all_headers[header.first] = header.second;
-      }
+    StreamingResponse response(
+        [peeked](StreamChunk* next) { return peeked->Next(next); },
+        config_.stream_retention);
+    response.SetProtocol(info.protocol);
+    response.SetMetricsSource([peeked] { return peeked->channel->metrics(); });
+    return response;
+  }
 
-      for (const auto& header : all_headers) {
-        std::string header_str = header.first + ": " + header.second;
-        curl_headers = curl_slist_append(curl_headers, header_str.c_str());
+  // Обычный запрос с дублем. Ответ ждем не дольше задержки hedger_, затем
+  // отправляем второй такой же запрос. Первый ответ (любой статус)
+  // побеждает, другой запрос отменяется. Ошибка передачи одной попытки
+  // не завершает гонку, пока другая еще в полете
+  HttpResponse HedgedPost(const std::string& url, const std::string& body,
+                          const Headers& headers, int timeout_ms) {
+    struct Race {
+      std::mutex mutex;
+      std::condition_variable finished;
+      int pending = 0;
+      int winner = -1;  // Номер попытки, первой получившей ответ
+      Hedger::Clock::duration latency{0};
+      HttpResponse response;
+      std::exception_ptr error;
+    };
+    auto race = std::make_shared<Race>();
+    std::vector<std::shared_ptr<std::atomic<bool>>> cancels;
+
+    auto send = [&](int attempt) {
+      auto cancelled = std::make_shared<std::atomic<bool>>(false);
+      cancels.push_back(cancelled);
+      HttpRequest request =
+          MakeRequest("POST", url, body, headers, timeout_ms);
+      request.cancelled = cancelled;
+      {
+        std::lock_guard<std::mutex> lock(race->mutex);
+        ++race->pending;
       }
-      curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, curl_headers);
-
-      // Настройка callbacks
-      curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteCallback);
-      curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response.body);
-      curl_easy_setopt(curl_, CURLOPT_HEADERFUNCTION, HeaderCallback);
-      curl_easy_setopt(curl_, CURLOPT_HEADERDATA, &response.headers);
+      auto sent = Hedger::Clock::now();
+      try {
+        loop().Send(
+            std::move(request),
+            [race, attempt, sent](HttpResponse response) {
+              {
+                std::lock_guard<std::mutex> lock(race->mutex);
+                if (race->winner < 0) {
+                  race->winner = attempt;
+                  race->latency = Hedger::Clock::now() - sent;
+                  race->response = std::move(response);
+                }
+                --race->pending;
+              }
+              race->finished.notify_all();
+            },
+            [race](std::exception_ptr error) {
+              {
+                std::lock_guard<std::mutex> lock(race->mutex);
+                if (!race->error) {
+                  race->error = error;
+                }
+                --race->pending;
+              }
+              race->finished.notify_all();
+            });
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(race->mutex);
+        --race->pending;
+        throw;
+      }
+    };
+
+    Hedger::Clock::duration delay = hedger_->Delay(Hedger::Kind::kResponse);
+    send(0);
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+    auto done = [&] { return race->winner >= 0 || race->pending == 0; };
+    if (!race->finished.wait_for(lock, delay, done) && hedger_->TryHedge() &&
+        TryAcquireHedge(body)) {
+      lock.unlock();
+      try {
+        send(1);
+      } catch (const NetworkError&) {
+        // Цикл остановлен: дожидаемся исходной попытки
+      }
+      lock.lock();
+    }
+    race->finished.wait(lock, done);
 
-      // Выполнение запроса
-      CURLcode res = curl_easy_perform(curl_);
+    // Проигравший запрос прерывается в I/O потоке по флагу
+    for (auto& cancelled : cancels) {
+      cancelled->store(true);
+    }
+    if (race->pending > 0) {
+      loop().Post([] {});
+    }
+    if (race->winner < 0) {
+      std::rethrow_exception(race->error);
+    }
+    hedger_->Record(Hedger::Kind::kResponse, race->latency, race->winner > 0);
+    return std::move(race->response);
+  }
 
-      if (res != CURLE_OK) {
-        throw NetworkError(std::string("CURL error: ") +
-                           curl_easy_strerror(res));
+  // Поток с дублем: ждем первый chunk не дольше задержки hedger_, затем
+  // открываем второй такой же поток. Побеждает поток, первым отдавший
+  // chunk или завершившийся, другой отменяется
+  StreamingResponse HedgedStream(const std::string& url,
+                                 const std::string& body,
+                                 const Headers& headers) {
+    struct Signal {
+      std::mutex mutex;
+      std::condition_variable ready;
+      bool notified = false;
+    };
+    struct Attempt {
+      std::shared_ptr<StreamChannel> channel;
+      Hedger::Clock::time_point sent;
+      bool hedge;
+    };
+
+    auto signal = std::make_shared<Signal>();
+    auto notify = [signal] {
+      {
+        std::lock_guard<std::mutex> lock(signal->mutex);
+        signal->notified = true;
       }
+      signal->ready.notify_all();
+    };
+
+    Hedger::Clock::time_point deadline =
+        Hedger::Clock::now() + hedger_->Delay(Hedger::Kind::kFirstChunk);
+    std::vector<Attempt> attempts;
+    attempts.push_back(
+        {OpenStream(url, body, headers), Hedger::Clock::now(), false});
+    bool hedge_decided = false;
+    std::exception_ptr error;
+
+    while (true) {
+      for (size_t i = 0; i < attempts.size();) {
+        StreamChunk chunk;
+        StreamChannel::Poll poll;
+        try {
+          poll = attempts[i].channel->TryNext(&chunk, notify);
+        } catch (...) {
+          ObserveError(std::current_exception());
+          if (!error) {
+            error = std::current_exception();
+          }
+          attempts.erase(attempts.begin() + i);
+          continue;
+        }
+        if (poll == StreamChannel::Poll::kPending) {
+          ++i;
+          continue;
+        }
 
-      // Получение кода ответа
-      long response_code;
-      curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &response_code);
-      response.status_code = static_cast<int>(response_code);
+        for (size_t j = 0; j < attempts.size(); ++j) {
+          if (j != i) {
+            attempts[j].channel->Cancel();
+          }
+        }
+        const Attempt& winner = attempts[i];
+        hedger_->Record(Hedger::Kind::kFirstChunk,
+                        Hedger::Clock::now() - winner.sent, winner.hedge);
+
+        auto peeked = std::make_shared<PeekedStream>();
+        peeked->channel = winner.channel;
+        if (poll == StreamChannel::Poll::kReady) {
+          peeked->first = std::move(chunk);
+        }
+        HttpResponse info = WaitStarted(*winner.channel);
+        StreamingResponse response(
+            [peeked](StreamChunk* next) { return peeked->Next(next); },
+            config_.stream_retention);
+        response.SetProtocol(info.protocol);
+        response.SetMetricsSource(
+            [peeked] { return peeked->channel->metrics(); });
+        return response;
+      }
+      if (attempts.empty()) {
+        std::rethrow_exception(error);
+      }
 
-    } catch (...) {
-      if (curl_headers) {
-        curl_slist_free_all(curl_headers);
+      std::unique_lock<std::mutex> lock(signal->mutex);
+      if (hedge_decided) {
+        signal->ready.wait(lock, [&] { return signal->notified; });
+      } else if (!signal->ready.wait_until(lock, deadline,
+                                           [&] { return signal->notified; })) {
+        hedge_decided = true;
+        if (hedger_->TryHedge() && TryAcquireHedge(body)) {
+          lock.unlock();
+          try {
+            attempts.push_back(
+                {OpenChannel(url, body, headers), Hedger::Clock::now(), true});
+          } catch (const NetworkError&) {
+            // Цикл остановлен: дожидаемся исходной попытки
+          }
+          continue;
+        }
+        signal->ready.wait(lock, [&] { return signal->notified; });
       }
-      throw;
+      signal->notified = false;
     }
+  }
 
-    if (curl_headers) {
-      curl_slist_free_all(curl_headers);
-    }
+  // Дубль не ждет очереди limiter_: нет места - нет дубля
+  bool TryAcquireHedge(const std::string& body) {
+    return !limiter_ ||
+           limiter_->TryAcquire(limit_key_, limiter_->EstimateTokens(body));
+  }
+
+  HttpResponse make_request(const std::string& url, const std::string& method,
+                            const std::string& body, const Headers& headers,
+                            int timeout_ms = 0) {
+    HttpResponse response;
+    CurlTransfer transfer(MakeRequest(method, url, body, headers, timeout_ms));
+
+    WithHandle(url, [&](CURL* handle) {
+      transfer.Attach(handle);
+      CURLcode res = curl_easy_perform(handle);
+      response = transfer.TakeResponse(handle, res);
+    });
 
     return response;
   }
@@ -309,8 +734,30 @@ HttpResponse HttpClient::post(const std::string& url, const std::string& body,
   return pimpl_->post(url, body, headers);
 }
 
+std::future<HttpResponse> HttpClient::PostAsync(const std::string& url,
+                                                const std::string& body,
+                                                const Headers& headers) {
+  return pimpl_->PostAsync(url, body, headers);
+}
+
+void HttpClient::PostAsync(const std::string& url, const std::string& body,
+                           const Headers& headers,
+                           EventLoop::ResponseCallback on_response,
+                           EventLoop::ErrorCallback on_error) {
+  pimpl_->PostAsync(url, body, headers, std::move(on_response),
+                    std::move(on_error));
+}
+
+HedgingStats HttpClient::hedging_stats() const {
+  return pimpl_->hedging_stats();
+}
+
 void HttpClient::SetTimeout(int timeout_ms) { pimpl_->SetTimeout(timeout_ms); }
 
+void HttpClient::SetMetrics(std::shared_ptr<EndpointMetrics> metrics) {
+  pimpl_->SetMetrics(std::move(metrics));
+}
+
 void HttpClient::SetDefaultHeaders(const Headers& headers) {
   // Это метод можно реализовать позже, если понадобится
 }
@@ -321,13 +768,17 @@ StreamingResponse HttpClient::PostStream(const std::string& url,
   return pimpl_->PostStream(url, body, headers);
 }
 
-void HttpClient::PostStreamAsync(const std::string& url,
-                                 const std::string& body,
-                                 const Headers& headers,
-                                 StreamCallback on_chunk,
-                                 std::function<void()> on_complete,
-                                 StreamErrorCallback on_error) {
-  pimpl_->PostStreamAsync(url, body, headers, on_chunk, on_complete, on_error);
+std::shared_ptr<StreamChannel> HttpClient::OpenStream(
+    const std::string& url, const std::string& body, const Headers& headers) {
+  return pimpl_->OpenStream(url, body, headers);
+}
+
+std::future<HttpResponse> HttpClient::PostStreamAsync(
+    const std::string& url, const std::string& body, const Headers& headers,
+    StreamCallback on_chunk, std::function<void()> on_complete,
+    StreamErrorCallback on_error) {
+  return pimpl_->PostStreamAsync(url, body, headers, std::move(on_chunk),
+                                 std::move(on_complete), std::move(on_error));
 }
 
-}  // namespace agentixx
\ No newline at end of file
+}  // namespace agentixx
@@ -0,0 +1,246 @@
+#include "agentixx/core/json_writer.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+namespace agentixx {
+
+namespace {
+
+// Байты, которые копируются без изменений: печатный ASCII без '"' и '\\'
+struct SafeTable {
+  bool safe[256] = {};
+  constexpr SafeTable() {
+    for (int c = 0x20; c < 0x80; ++c) {
+      safe[c] = c != '"' && c != '\\';
+    }
+  }
+};
+
+constexpr SafeTable kSafe;
+
+// Длина корректной UTF-8 последовательности с первым байтом в data[0],
+// 0 - последовательность некорректна
+size_t Utf8Length(const unsigned char* data, size_t size) {
+  unsigned char lead = data[0];
+  size_t length = 0;
+  uint32_t min = 0;
+  uint32_t code = 0;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    min = 0x80;
+    code = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    min = 0x800;
+    code = lead & 0x0F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    min = 0x10000;
+    code = lead & 0x07;
+  } else {
+    return 0;
+  }
+  if (size < length) {
+    return 0;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    if ((data[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+    code = (code << 6) | (data[i] & 0x3F);
+  }
+  // Overlong, суррогаты и значения за пределами Unicode
+  if (code < min || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+    return 0;
+  }
+  return length;
+}
+
+}  // namespace
+
+void JsonWriter::AppendString(std::string* out, std::string_view value) {
+  static const char kHex[] = "0123456789abcdef";
+  const auto* data = reinterpret_cast<const unsigned char*>(value.data());
+  size_t size = value.size();
+
+  out->push_back('"');
+  size_t i = 0;
+  while (i < size) {
+    // Участок из печатного ASCII и корректного UTF-8 копируется целиком
+    size_t start = i;
+    while (i < size) {
+      if (kSafe.safe[data[i]]) {
+        ++i;
+      } else if (data[i] >= 0x80) {
+        size_t length = Utf8Length(data + i, size - i);
+        if (length == 0) {
+          break;
+        }
+        i += length;
+      } else {
+        break;
+      }
+    }
+    out->append(value.data() + start, i - start);
+    if (i == size) {
+      break;
+    }
+
+    unsigned char c = data[i];
+    if (c >= 0x80) {
+      out->append("\xEF\xBF\xBD");
+      ++i;
+      continue;
+    }
+
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\b':
+        out->append("\\b");
+        break;
+      case '\f':
+        out->append("\\f");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      case '\r':
+        out->append("\\r");
+        break;
+      case '\t':
+        out->append("\\t");
+        break;
+      default: {
+        char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+        out->append(escaped, sizeof(escaped));
+      }
+    }
+    ++i;
+  }
+  out->push_back('"');
+}
+
+void JsonWriter::BeforeValue() {
+  if (after_key_) {
+    after_key_ = false;
+    return;
+  }
+  if (depth_ > 0) {
+    uint64_t bit = uint64_t{1} << (depth_ - 1);
+    if (has_items_ & bit) {
+      out_->push_back(',');
+    }
+    has_items_ |= bit;
+  }
+}
+
+void JsonWriter::Open(char bracket) {
+  BeforeValue();
+  if (depth_ == kMaxDepth) {
+    throw std::length_error("JSON nesting is too deep");
+  }
+  out_->push_back(bracket);
+  has_items_ &= ~(uint64_t{1} << depth_);
+  ++depth_;
+}
+
+void JsonWriter::Close(char bracket) {
+  --depth_;
+  out_->push_back(bracket);
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+  Open('{');
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+  Close('}');
+  return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+  Open('[');
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+  Close(']');
+  return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+  BeforeValue();
+  AppendString(out_, key);
+  out_->push_back(':');
+  after_key_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+  BeforeValue();
+  AppendString(out_, value);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+  BeforeValue();
+  out_->append(std::to_string(value));
+  return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+  BeforeValue();
+  if (!std::isfinite(value)) {
+    out_->append("null");
+    return *this;
+  }
+
+  char buffer[32];
+#if defined(__cpp_lib_to_chars)
+  // Кратчайшая запись, которая читается обратно в то же значение
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  size_t length = result.ptr - buffer;
+#else
+  size_t length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+#endif
+  out_->append(buffer, length);
+
+  // 1.0 должно остаться числом с плавающей точкой
+  if (std::string_view(buffer, length).find_first_of(".eE") ==
+      std::string_view::npos) {
+    out_->append(".0");
+  }
+  return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+  BeforeValue();
+  out_->append(value ? "true" : "false");
+  return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+  BeforeValue();
+  out_->append("null");
+  return *this;
+}
+
+JsonWriter& JsonWriter::Raw(std::string_view json) {
+  BeforeValue();
+  out_->append(json);
+  return *this;
+}
+
+}  // namespace agentixx
@@ -0,0 +1,203 @@
+#include "agentixx/core/metrics.hpp"
+
+#include <array>
+#include <cmath>
+#include <functional>
+
+namespace agentixx {
+
+namespace {
+
+// Пар model и base_url в процессе обычно единицы
+constexpr size_t kSlots = 256;
+
+struct Entry {
+  std::string key;
+  std::shared_ptr<EndpointMetrics> metrics;
+};
+
+std::string EntryKey(const std::string& model, const std::string& base_url) {
+  std::string key;
+  key.reserve(model.size() + base_url.size() + 1);
+  key.append(model).push_back('\n');
+  key.append(base_url);
+  return key;
+}
+
+}  // namespace
+
+double Histogram::sum() const {
+  return sum_.load(std::memory_order_relaxed) / kScale;
+}
+
+double Histogram::mean() const {
+  uint64_t records = count();
+  return records > 0 ? sum() / records : 0;
+}
+
+double Histogram::max() const {
+  return max_.load(std::memory_order_relaxed) / kScale;
+}
+
+uint64_t Histogram::Middle(size_t index) {
+  if (index < 2 * kSubBuckets) {
+    return index;
+  }
+  int shift = static_cast<int>(index / kSubBuckets) - 1;
+  uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+  return lower + ((uint64_t{1} << shift) - 1) / 2;
+}
+
+double Histogram::Percentile(double q) const {
+  // Счетчики корзин читаются один раз: count_ мог уйти вперед
+  std::array<uint64_t, kBuckets> counts;
+  uint64_t records = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    counts[i] = counts_[i].load(std::memory_order_relaxed);
+    records += counts[i];
+  }
+  if (records == 0) {
+    return 0;
+  }
+
+  q = std::clamp(q, 0.0, 1.0);
+  uint64_t rank = std::max<uint64_t>(
+      static_cast<uint64_t>(std::ceil(q * records)), 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      uint64_t top = max_.load(std::memory_order_relaxed);
+      return std::min(Middle(i), top) / kScale;
+    }
+  }
+  return max();
+}
+
+std::vector<uint64_t> Histogram::CumulativeCounts(
+    const std::vector<double>& bounds, uint64_t* total) const {
+  std::vector<uint64_t> cumulative(bounds.size());
+  uint64_t seen = 0;
+  size_t bound = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    uint64_t count = counts_[i].load(std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+    // Корзина относится к первой границе не меньше ее середины
+    double middle = Middle(i) / kScale;
+    while (bound < bounds.size() && bounds[bound] < middle) {
+      cumulative[bound++] = seen;
+    }
+    seen += count;
+  }
+  while (bound < bounds.size()) {
+    cumulative[bound++] = seen;
+  }
+  *total = seen;
+  return cumulative;
+}
+
+uint64_t Counter::value() const {
+  uint64_t sum = 0;
+  for (const Cell& cell : cells_) {
+    sum += cell.value.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+std::vector<std::pair<int, uint64_t>> EndpointMetrics::errors() const {
+  std::vector<std::pair<int, uint64_t>> errors;
+  for (int code = 0; code < kStatusCodes; ++code) {
+    uint64_t count = errors_[code].load(std::memory_order_relaxed);
+    if (count > 0) {
+      errors.emplace_back(code, count);
+    }
+  }
+  return errors;
+}
+
+void EndpointMetrics::Record(const RequestMetrics& metrics) {
+  dns.Record(metrics.dns_ms);
+  connect.Record(metrics.connect_ms);
+  tls.Record(metrics.tls_ms);
+  ttfb.Record(metrics.ttfb_ms);
+  total.Record(metrics.total_ms);
+  if (metrics.tokens > 0) {
+    ttft.Record(metrics.ttft_ms);
+    if (metrics.tokens_per_second > 0) {
+      tokens_per_second.Record(metrics.tokens_per_second);
+    }
+  }
+}
+
+class MetricsRegistry::Impl {
+ public:
+  ~Impl() {
+    for (auto& slot : slots_) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::shared_ptr<EndpointMetrics> Find(const std::string& model,
+                                        const std::string& base_url) {
+    std::string key = EntryKey(model, base_url);
+    size_t start = std::hash<std::string>()(key) % kSlots;
+    Entry* created = nullptr;
+    for (size_t i = 0; i < kSlots; ++i) {
+      std::atomic<Entry*>& slot = slots_[(start + i) % kSlots];
+      Entry* entry = slot.load(std::memory_order_acquire);
+      if (!entry) {
+        if (!created) {
+          created = new Entry{
+              key, std::make_shared<EndpointMetrics>(model, base_url)};
+        }
+        // Проиграли гонку за слот: проверяем, не та же ли это пара
+        if (slot.compare_exchange_strong(entry, created,
+                                         std::memory_order_acq_rel)) {
+          return created->metrics;
+        }
+      }
+      if (entry->key == key) {
+        delete created;
+        return entry->metrics;
+      }
+    }
+
+    // Таблица заполнена: метрики работают, но в Endpoints не попадут
+    std::shared_ptr<EndpointMetrics> metrics =
+        created ? created->metrics
+                : std::make_shared<EndpointMetrics>(model, base_url);
+    delete created;
+    return metrics;
+  }
+
+  std::vector<std::shared_ptr<EndpointMetrics>> All() const {
+    std::vector<std::shared_ptr<EndpointMetrics>> all;
+    for (const auto& slot : slots_) {
+      if (Entry* entry = slot.load(std::memory_order_acquire)) {
+        all.push_back(entry->metrics);
+      }
+    }
+    return all;
+  }
+
+ private:
+  std::array<std::atomic<Entry*>, kSlots> slots_{};
+};
+
+MetricsRegistry::MetricsRegistry() : pimpl_(std::make_unique<Impl>()) {}
+
+MetricsRegistry::~MetricsRegistry() = default;
+
+std::shared_ptr<EndpointMetrics> MetricsRegistry::Endpoint(
+    const std::string& model, const std::string& base_url) {
+  return pimpl_->Find(model, base_url);
+}
+
+std::vector<std::shared_ptr<EndpointMetrics>> MetricsRegistry::Endpoints()
+    const {
+  return pimpl_->All();
+}
+
+}  // namespace agentixx
@@ -0,0 +1,360 @@
+#include "agentixx/core/prometheus.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace agentixx {
+
+namespace {
+
+// Больше заголовков запроса scrape не бывает
+constexpr size_t kMaxRequestSize = 8192;
+
+[[noreturn]] void ThrowErrno(const std::string& what) {
+  throw AgentCppException("Metrics endpoint: " + what + ": " +
+                          std::strerror(errno));
+}
+
+std::string FormatDouble(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+  return buffer;
+}
+
+// Метки endpoint: значения экранируются по формату Prometheus
+std::string Labels(const EndpointMetrics& endpoint) {
+  std::string labels;
+  auto append = [&](const char* name, const std::string& value) {
+    if (!labels.empty()) {
+      labels.push_back(',');
+    }
+    labels.append(name).append("=\"");
+    for (char c : value) {
+      if (c == '\\' || c == '"') {
+        labels.push_back('\\');
+        labels.push_back(c);
+      } else if (c == '\n') {
+        labels.append("\\n");
+      } else {
+        labels.push_back(c);
+      }
+    }
+    labels.push_back('"');
+  };
+  append("model", endpoint.model());
+  append("base_url", endpoint.base_url());
+  return labels;
+}
+
+// Семейство метрик: заголовок один раз, затем строки по endpoints
+class Family {
+ public:
+  Family(std::string* out, const std::string& name, const char* type,
+         const char* help)
+      : out_(out), name_(name) {
+    out_->append("# HELP ").append(name_).append(" ").append(help);
+    out_->append("\n# TYPE ").append(name_).append(" ").append(type);
+    out_->push_back('\n');
+  }
+
+  void Sample(const char* suffix, const std::string& labels,
+              const std::string& value) {
+    out_->append(name_).append(suffix).append("{").append(labels);
+    out_->append("} ").append(value).push_back('\n');
+  }
+
+ private:
+  std::string* out_;
+  const std::string& name_;
+};
+
+}  // namespace
+
+class PrometheusExporter::Impl {
+ public:
+  Impl(std::shared_ptr<MetricsRegistry> registry, PrometheusOptions options)
+      : registry_(std::move(registry)), options_(std::move(options)) {}
+
+  ~Impl() { Stop(); }
+
+  std::string Scrape() const {
+    struct Endpoint {
+      std::shared_ptr<EndpointMetrics> metrics;
+      std::string labels;
+    };
+    std::vector<Endpoint> endpoints;
+    for (auto& metrics : registry_->Endpoints()) {
+      std::string labels = Labels(*metrics);
+      endpoints.push_back({std::move(metrics), std::move(labels)});
+    }
+
+    std::string out;
+    auto counter = [&](const char* name, const char* help,
+                       const Counter EndpointMetrics::*member) {
+      std::string full = options_.prefix + "_" + name;
+      Family family(&out, full, "counter", help);
+      for (const auto& endpoint : endpoints) {
+        family.Sample("", endpoint.labels,
+                      std::to_string(((*endpoint.metrics).*member).value()));
+      }
+    };
+
+    counter("requests_total", "HTTP requests completed, including failures.",
+            &EndpointMetrics::requests);
+    {
+      std::string full = options_.prefix + "_request_errors_total";
+      Family family(&out, full, "counter",
+                    "Failed HTTP requests by status code.");
+      for (const auto& endpoint : endpoints) {
+        for (const auto& [code, count] : endpoint.metrics->errors()) {
+          std::string labels = endpoint.labels + ",code=\"" +
+                               (code > 0 ? std::to_string(code) : "network") +
+                               "\"";
+          family.Sample("", labels, std::to_string(count));
+        }
+      }
+    }
+    {
+      std::string full = options_.prefix + "_requests_in_flight";
+      Family family(&out, full, "gauge", "HTTP requests in flight.");
+      for (const auto& endpoint : endpoints) {
+        family.Sample("", endpoint.labels,
+                      std::to_string(endpoint.metrics->in_flight()));
+      }
+    }
+    counter("sent_bytes_total", "Request body bytes sent.",
+            &EndpointMetrics::bytes_sent);
+    counter("received_bytes_total", "Response body bytes received.",
+            &EndpointMetrics::bytes_received);
+    counter("prompt_tokens_total", "Prompt tokens reported in usage.",
+            &EndpointMetrics::prompt_tokens);
+    counter("completion_tokens_total", "Completion tokens reported in usage.",
+            &EndpointMetrics::completion_tokens);
+
+    // Гистограммы хранят мс, Prometheus ждет секунды
+    auto histogram = [&](const char* name, const char* help,
+                         const Histogram EndpointMetrics::*member,
+                         const std::vector<double>& bounds, double scale) {
+      std::string full = options_.prefix + "_" + name;
+      Family family(&out, full, "histogram", help);
+      std::vector<double> scaled;
+      for (double bound : bounds) {
+        scaled.push_back(bound * scale);
+      }
+      for (const auto& endpoint : endpoints) {
+        const Histogram& values = (*endpoint.metrics).*member;
+        uint64_t total = 0;
+        std::vector<uint64_t> counts = values.CumulativeCounts(scaled, &total);
+        for (size_t i = 0; i < bounds.size(); ++i) {
+          family.Sample("_bucket",
+                        endpoint.labels + ",le=\"" + FormatDouble(bounds[i]) +
+                            "\"",
+                        std::to_string(counts[i]));
+        }
+        family.Sample("_bucket", endpoint.labels + ",le=\"+Inf\"",
+                      std::to_string(total));
+        family.Sample("_sum", endpoint.labels,
+                      FormatDouble(values.sum() / scale));
+        family.Sample("_count", endpoint.labels, std::to_string(total));
+      }
+    };
+
+    const auto& latency = options_.latency_buckets;
+    histogram("dns_duration_seconds", "DNS resolution time.",
+              &EndpointMetrics::dns, latency, 1000);
+    histogram("connect_duration_seconds", "TCP connect time.",
+              &EndpointMetrics::connect, latency, 1000);
+    histogram("tls_duration_seconds", "TLS handshake time.",
+              &EndpointMetrics::tls, latency, 1000);
+    histogram("time_to_first_byte_seconds",
+              "Time from request start to the first response byte.",
+              &EndpointMetrics::ttfb, latency, 1000);
+    histogram("request_duration_seconds",
+              "Time from request start to the end of the response.",
+              &EndpointMetrics::total, latency, 1000);
+    histogram("time_to_first_token_seconds",
+              "Time from request start to the first streamed token.",
+              &EndpointMetrics::ttft, latency, 1000);
+    histogram("inter_token_gap_seconds",
+              "Time between consecutive streamed tokens.",
+              &EndpointMetrics::token_gap, latency, 1000);
+    histogram("generation_tokens_per_second",
+              "Streamed tokens per second after the first token.",
+              &EndpointMetrics::tokens_per_second, options_.rate_buckets, 1);
+    return out;
+  }
+
+  int Listen(int port, const std::string& address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+      throw AgentCppException("Metrics endpoint: already listening");
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+      throw AgentCppException("Metrics endpoint: invalid address " + address);
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      ThrowErrno("socket");
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    socklen_t length = sizeof(addr);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, 16) < 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0 ||
+        pipe(wake_) < 0) {
+      int error = errno;
+      close(fd);
+      errno = error;
+      ThrowErrno("listen on " + address + ":" + std::to_string(port));
+    }
+
+    listen_fd_ = fd;
+    thread_ = std::thread([this] { Serve(); });
+    return ntohs(addr.sin_port);
+  }
+
+  void Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+    char byte = 0;
+    while (write(wake_[1], &byte, 1) < 0 && errno == EINTR) {
+    }
+    thread_.join();
+    close(listen_fd_);
+    close(wake_[0]);
+    close(wake_[1]);
+    listen_fd_ = wake_[0] = wake_[1] = -1;
+  }
+
+ private:
+  std::shared_ptr<MetricsRegistry> registry_;
+  PrometheusOptions options_;
+
+  std::mutex mutex_;  // Listen и Stop
+  int listen_fd_ = -1;
+  int wake_[2] = {-1, -1};  // Pipe остановки потока сервера
+  std::thread thread_;
+
+  void Serve() {
+    while (true) {
+      pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+      if (poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      if (fds[1].revents != 0) {
+        return;
+      }
+      if (fds[0].revents & POLLIN) {
+        int client = accept(listen_fd_, nullptr, nullptr);
+        if (client >= 0) {
+          Handle(client);
+          close(client);
+        }
+      }
+    }
+  }
+
+  void Handle(int fd) {
+    // Медленный клиент не задерживает сервер дольше таймаута
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.size() < kMaxRequestSize) {
+      ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+      if (received < 0 && errno == EINTR) {
+        continue;
+      }
+      if (received <= 0) {
+        return;
+      }
+      request.append(buffer, static_cast<size_t>(received));
+    }
+
+    // Строка запроса: метод, путь, версия
+    std::string line = request.substr(0, request.find("\r\n"));
+    size_t method_end = line.find(' ');
+    size_t path_end = line.find(' ', method_end + 1);
+    std::string method = line.substr(0, method_end);
+    std::string path =
+        method_end == std::string::npos
+            ? std::string()
+            : line.substr(method_end + 1, path_end - method_end - 1);
+    path = path.substr(0, path.find('?'));
+
+    std::string status = "200 OK";
+    std::string type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (method != "GET" && method != "HEAD") {
+      status = "405 Method Not Allowed";
+      type = "text/plain";
+      body = "Method not allowed\n";
+    } else if (path != "/metrics") {
+      status = "404 Not Found";
+      type = "text/plain";
+      body = "Not found\n";
+    } else {
+      body = Scrape();
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " +
+                           type + "\r\nContent-Length: " +
+                           std::to_string(body.size()) +
+                           "\r\nConnection: close\r\n\r\n";
+    if (method != "HEAD") {
+      response += body;
+    }
+    size_t sent = 0;
+    while (sent < response.size()) {
+      ssize_t done = send(fd, response.data() + sent, response.size() - sent,
+                          MSG_NOSIGNAL);
+      if (done < 0 && errno == EINTR) {
+        continue;
+      }
+      if (done <= 0) {
+        return;
+      }
+      sent += static_cast<size_t>(done);
+    }
+  }
+};
+
+PrometheusExporter::PrometheusExporter(
+    std::shared_ptr<MetricsRegistry> registry, PrometheusOptions options)
+    : pimpl_(std::make_unique<Impl>(std::move(registry), std::move(options))) {}
+
+PrometheusExporter::~PrometheusExporter() = default;
+
+std::string PrometheusExporter::Scrape() const { return pimpl_->Scrape(); }
+
+int PrometheusExporter::Listen(int port, const std::string& address) {
+  return pimpl_->Listen(port, address);
+}
+
+void PrometheusExporter::Stop() { pimpl_->Stop(); }
+
+}  // namespace agentixx
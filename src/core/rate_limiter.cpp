@@ -0,0 +1,432 @@
+#include "agentixx/core/rate_limiter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hash.hpp"
+#include "headers.hpp"
+
+namespace agentixx {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool ParseNumber(const std::string* value, double* number) {
+  if (!value || value->empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  *number = std::strtod(value->c_str(), &end);
+  return end != value->c_str();
+}
+
+// Длительность в формате x-ratelimit-reset-*: "20ms", "1.5s", "6m0s",
+// "1h2m3s". Число без единиц - секунды
+bool ParseDuration(const std::string* value, Clock::duration* duration) {
+  if (!value || value->empty()) {
+    return false;
+  }
+  double seconds = 0;
+  const char* cursor = value->c_str();
+  while (*cursor) {
+    char* end = nullptr;
+    double number = std::strtod(cursor, &end);
+    if (end == cursor) {
+      return false;
+    }
+    cursor = end;
+    if (cursor[0] == 'm' && cursor[1] == 's') {
+      seconds += number / 1000;
+      cursor += 2;
+    } else if (*cursor == 'h') {
+      seconds += number * 3600;
+      ++cursor;
+    } else if (*cursor == 'm') {
+      seconds += number * 60;
+      ++cursor;
+    } else {
+      seconds += number;
+      if (*cursor == 's') {
+        ++cursor;
+      } else if (*cursor) {
+        return false;
+      }
+    }
+  }
+  *duration = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(seconds));
+  return true;
+}
+
+// Ведро на limit единиц в минуту, limit == 0 - без ограничения.
+// Емкость и скорость пополнения - limit * utilization
+struct Bucket {
+  double limit = 0;
+  double capacity = 0;
+  double available = 0;
+  Clock::time_point updated;
+
+  void SetLimit(double value, double utilization, Clock::time_point now) {
+    Refill(now);
+    double new_capacity = value * utilization;
+    // Новое ведро начинает полным, известное только уменьшается
+    available = limit > 0 ? std::min(available, new_capacity) : new_capacity;
+    limit = value;
+    capacity = new_capacity;
+    updated = now;
+  }
+
+  void Refill(Clock::time_point now) {
+    if (limit > 0 && now > updated) {
+      std::chrono::duration<double> elapsed = now - updated;
+      available =
+          std::min(capacity, available + capacity * elapsed.count() / 60);
+    }
+    updated = now;
+  }
+
+  // Запрос дороже емкости пропускается из полного ведра, иначе он
+  // никогда не поместится
+  double Cost(double amount) const { return std::min(amount, capacity); }
+
+  bool Fits(double amount) const {
+    return limit <= 0 || available >= Cost(amount);
+  }
+
+  void Take(double amount) {
+    if (limit > 0) {
+      available -= Cost(amount);
+    }
+  }
+
+  Clock::duration Wait(double amount) const {
+    if (Fits(amount)) {
+      return Clock::duration::zero();
+    }
+    std::chrono::duration<double> seconds((Cost(amount) - available) * 60 /
+                                          capacity);
+    return std::chrono::duration_cast<Clock::duration>(seconds);
+  }
+};
+
+}  // namespace
+
+class RateLimiter::Impl {
+ private:
+  // Запрос в очереди ключа
+  struct Waiter {
+    double tokens;
+    std::function<void()> grant;
+  };
+
+  // Состояние одного ключа (base_url + API key)
+  struct Limit {
+    Bucket requests;
+    Bucket tokens;
+    // После 429 или исчерпанного лимита ключ ждет сброса окна
+    Clock::time_point blocked_until;
+    std::deque<Waiter> queue;
+  };
+
+  RateLimitOptions options_;
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::unordered_map<std::string, Limit> limits_;
+  bool stopping_ = false;
+  std::thread thread_;
+  Stats stats_;
+
+  Limit& Get(const std::string& key, Clock::time_point now) {
+    auto it = limits_.find(key);
+    if (it == limits_.end()) {
+      it = limits_.emplace(key, Limit()).first;
+      Limit& limit = it->second;
+      limit.requests.SetLimit(options_.requests_per_minute,
+                              options_.utilization, now);
+      limit.tokens.SetLimit(options_.tokens_per_minute, options_.utilization,
+                            now);
+    }
+    Limit& limit = it->second;
+    limit.requests.Refill(now);
+    limit.tokens.Refill(now);
+    return limit;
+  }
+
+  static bool Admit(Limit& limit, double tokens, Clock::time_point now) {
+    if (now < limit.blocked_until || !limit.requests.Fits(1) ||
+        !limit.tokens.Fits(tokens)) {
+      return false;
+    }
+    limit.requests.Take(1);
+    limit.tokens.Take(tokens);
+    return true;
+  }
+
+  // Когда голова очереди поместится в лимит
+  static Clock::time_point Ready(const Limit& limit, double tokens,
+                                 Clock::time_point now) {
+    Clock::duration wait =
+        std::max(limit.requests.Wait(1), limit.tokens.Wait(tokens));
+    // Не меньше миллисекунды: иначе округление крутит цикл впустую
+    wait = std::max<Clock::duration>(wait, std::chrono::milliseconds(1));
+    return std::max(limit.blocked_until, now + wait);
+  }
+
+  void SyncLimit(Bucket& bucket, double configured, double reported,
+                 Clock::time_point now) {
+    double value = configured > 0 ? std::min(configured, reported) : reported;
+    if (value != bucket.limit) {
+      bucket.SetLimit(value, options_.utilization, now);
+    }
+  }
+
+  void Block(Limit& limit, Clock::time_point until) {
+    limit.blocked_until = std::max(limit.blocked_until, until);
+  }
+
+  void Run() {
+    std::vector<std::function<void()>> grants;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      Clock::time_point now = Clock::now();
+      Clock::time_point wake = Clock::time_point::max();
+      for (auto& entry : limits_) {
+        Limit& limit = entry.second;
+        if (limit.queue.empty()) {
+          continue;
+        }
+        limit.requests.Refill(now);
+        limit.tokens.Refill(now);
+        while (!limit.queue.empty() &&
+               Admit(limit, limit.queue.front().tokens, now)) {
+          grants.push_back(std::move(limit.queue.front().grant));
+          limit.queue.pop_front();
+          --stats_.queued;
+          ++stats_.granted;
+        }
+        if (!limit.queue.empty()) {
+          wake = std::min(wake, Ready(limit, limit.queue.front().tokens, now));
+        }
+      }
+
+      if (!grants.empty()) {
+        lock.unlock();
+        for (auto& grant : grants) {
+          try {
+            grant();
+          } catch (...) {
+            // Исключение из grant не должно остановить очередь
+          }
+        }
+        grants.clear();
+        lock.lock();
+        continue;
+      }
+
+      if (wake == Clock::time_point::max()) {
+        changed_.wait(lock);
+      } else {
+        changed_.wait_until(lock, wake);
+      }
+    }
+  }
+
+ public:
+  explicit Impl(const RateLimitOptions& options) : options_(options) {
+    if (options_.utilization <= 0 || options_.utilization > 1) {
+      options_.utilization = 1;
+    }
+    if (options_.chars_per_token <= 0) {
+      options_.chars_per_token = 4;
+    }
+  }
+
+  // Поток очереди держит ссылку на Impl, поэтому limiter можно отпустить
+  // даже из grant, выполняемого в этом потоке
+  void Start(std::shared_ptr<Impl> self) {
+    thread_ = std::thread([self = std::move(self)] { self->Run(); });
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    changed_.notify_all();
+    if (thread_.get_id() == std::this_thread::get_id()) {
+      thread_.detach();
+    } else {
+      thread_.join();
+    }
+  }
+
+  double EstimateTokens(const std::string& body) const {
+    return body.size() / options_.chars_per_token + options_.completion_tokens;
+  }
+
+  bool TryAcquire(const std::string& key, double tokens) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    Limit& limit = Get(key, now);
+    if (!limit.queue.empty() || !Admit(limit, tokens, now)) {
+      return false;
+    }
+    ++stats_.granted;
+    return true;
+  }
+
+  void Enqueue(const std::string& key, double tokens,
+               std::function<void()> grant) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Clock::time_point now = Clock::now();
+      Limit& limit = Get(key, now);
+      // Очередь не обгоняем, даже если запрос поместился бы в лимит
+      if (!limit.queue.empty() || !Admit(limit, tokens, now)) {
+        limit.queue.push_back({tokens, std::move(grant)});
+        ++stats_.queued;
+        ++stats_.delayed;
+        changed_.notify_one();
+        return;
+      }
+      ++stats_.granted;
+    }
+    grant();
+  }
+
+  void Update(const std::string& key, int status_code,
+              const Headers& headers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    Limit& limit = Get(key, now);
+
+    // Лимит API действует, если он ниже заданного в options_
+    double value = 0;
+    if (ParseNumber(FindHeader(headers, "x-ratelimit-limit-requests"),
+                    &value) &&
+        value > 0) {
+      SyncLimit(limit.requests, options_.requests_per_minute, value, now);
+    }
+    if (ParseNumber(FindHeader(headers, "x-ratelimit-limit-tokens"), &value) &&
+        value > 0) {
+      SyncLimit(limit.tokens, options_.tokens_per_minute, value, now);
+    }
+
+    // Остаток API учитывает запросы других процессов с тем же ключом
+    struct {
+      Bucket* bucket;
+      const char* remaining;
+      const char* reset;
+    } windows[] = {
+        {&limit.requests, "x-ratelimit-remaining-requests",
+         "x-ratelimit-reset-requests"},
+        {&limit.tokens, "x-ratelimit-remaining-tokens",
+         "x-ratelimit-reset-tokens"},
+    };
+    for (const auto& window : windows) {
+      Bucket& bucket = *window.bucket;
+      if (!ParseNumber(FindHeader(headers, window.remaining), &value)) {
+        continue;
+      }
+      if (bucket.limit > 0) {
+        bucket.available = std::min(bucket.available, value);
+      }
+      // reset - время до полного восстановления лимита, а для следующего
+      // запроса достаточно пополнения на одну единицу
+      Clock::duration reset{};
+      if (value < 1 && ParseDuration(FindHeader(headers, window.reset),
+                                     &reset)) {
+        if (bucket.limit > 0) {
+          reset = std::min<Clock::duration>(
+              reset, std::chrono::duration_cast<Clock::duration>(
+                         std::chrono::duration<double>(60 / bucket.limit)));
+        }
+        Block(limit, now + reset);
+      }
+    }
+
+    if (status_code == 429) {
+      ++stats_.throttled;
+      std::chrono::milliseconds wait(1000);
+      ParseRetryAfter(headers, &wait);
+      Block(limit, now + wait);
+    }
+    changed_.notify_one();
+  }
+
+  Stats GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+};
+
+// Реализация публичных методов RateLimiter
+
+RateLimiter::RateLimiter(const RateLimitOptions& options)
+    : pimpl_(std::make_shared<Impl>(options)) {
+  pimpl_->Start(pimpl_);
+}
+
+RateLimiter::~RateLimiter() { pimpl_->Stop(); }
+
+std::string RateLimiter::Key(const std::string& base_url,
+                             const std::string& api_key) {
+  // Ключ API не хранится в limiter открытым текстом
+  char hash[17];
+  std::snprintf(hash, sizeof(hash), "%016llx",
+                static_cast<unsigned long long>(HashBytes(api_key)));
+  return base_url + "#" + hash;
+}
+
+double RateLimiter::EstimateTokens(const std::string& body) const {
+  return pimpl_->EstimateTokens(body);
+}
+
+void RateLimiter::Acquire(const std::string& key, double tokens) {
+  struct Gate {
+    std::mutex mutex;
+    std::condition_variable opened;
+    bool open = false;
+  };
+  auto gate = std::make_shared<Gate>();
+  pimpl_->Enqueue(key, tokens, [gate] {
+    {
+      std::lock_guard<std::mutex> lock(gate->mutex);
+      gate->open = true;
+    }
+    gate->opened.notify_all();
+  });
+
+  std::unique_lock<std::mutex> lock(gate->mutex);
+  gate->opened.wait(lock, [&] { return gate->open; });
+}
+
+bool RateLimiter::TryAcquire(const std::string& key, double tokens) {
+  return pimpl_->TryAcquire(key, tokens);
+}
+
+void RateLimiter::Enqueue(const std::string& key, double tokens,
+                          std::function<void()> grant) {
+  pimpl_->Enqueue(key, tokens, std::move(grant));
+}
+
+void RateLimiter::Update(const std::string& key, int status_code,
+                         const Headers& headers) {
+  pimpl_->Update(key, status_code, headers);
+}
+
+RateLimiter::Stats RateLimiter::GetStats() const {
+  return pimpl_->GetStats();
+}
+
+}  // namespace agentixx
@@ -0,0 +1,83 @@
+#include "retry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "headers.hpp"
+
+namespace agentixx {
+
+namespace {
+
+// Свой генератор на поток: jitter не требует общего состояния
+std::mt19937_64& Random() {
+  thread_local std::mt19937_64 engine(std::random_device{}());
+  return engine;
+}
+
+}  // namespace
+
+RetryTracker::RetryTracker(const RetryPolicy& policy)
+    : policy_(policy), start_(Clock::now()) {}
+
+bool RetryTracker::Next(int status_code,
+                        const std::chrono::milliseconds* retry_after,
+                        std::chrono::milliseconds* delay) {
+  bool retryable = status_code == 0 ? policy_.retry_network_errors
+                                    : policy_.Retryable(status_code);
+  if (!retryable || attempt_ >= policy_.max_attempts) {
+    return false;
+  }
+
+  if (retry_after) {
+    *delay = *retry_after;
+  } else {
+    // Полный jitter: клиенты, получившие ошибку одновременно, не
+    // возвращаются к API одной волной
+    double ceiling =
+        std::min<double>(policy_.max_backoff_ms,
+                         policy_.initial_backoff_ms *
+                             std::pow(policy_.multiplier, attempt_ - 1));
+    std::uniform_real_distribution<double> jitter(0, std::max(ceiling, 0.0));
+    *delay = std::chrono::milliseconds(
+        static_cast<int64_t>(jitter(Random())));
+  }
+
+  if (policy_.deadline_ms > 0 &&
+      Clock::now() + *delay >=
+          start_ + std::chrono::milliseconds(policy_.deadline_ms)) {
+    return false;
+  }
+  ++attempt_;
+  return true;
+}
+
+bool RetryTracker::Next(const std::exception_ptr& error,
+                        std::chrono::milliseconds* delay) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const ApiError& e) {
+    std::chrono::milliseconds retry_after;
+    bool has_retry_after = ParseRetryAfter(e.headers, &retry_after);
+    return Next(e.status_code, has_retry_after ? &retry_after : nullptr,
+                delay);
+  } catch (const NetworkError&) {
+    return Next(0, nullptr, delay);
+  } catch (...) {
+    return false;
+  }
+}
+
+int RetryTracker::AttemptTimeout(int timeout_ms) const {
+  if (policy_.deadline_ms <= 0) {
+    return timeout_ms;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      Clock::now() - start_);
+  int64_t remaining = policy_.deadline_ms - elapsed.count();
+  return static_cast<int>(
+      std::clamp<int64_t>(remaining, 1, std::max(timeout_ms, 1)));
+}
+
+}  // namespace agentixx
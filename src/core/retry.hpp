@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+// Счет попыток одного запроса по RetryPolicy. Не потокобезопасен:
+// попытки запроса идут последовательно
+class RetryTracker {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RetryTracker(const RetryPolicy& policy);
+
+  // Попытка завершилась ответом status_code (0 - NetworkError). true -
+  // нужен повтор через *delay. retry_after - пауза из ответа, если есть
+  bool Next(int status_code, const std::chrono::milliseconds* retry_after,
+            std::chrono::milliseconds* delay);
+  // То же по исключению попытки: ApiError, NetworkError или другое
+  bool Next(const std::exception_ptr& error, std::chrono::milliseconds* delay);
+
+  // Таймаут попытки, сокращенный до оставшегося срока
+  int AttemptTimeout(int timeout_ms) const;
+
+ private:
+  RetryPolicy policy_;
+  Clock::time_point start_;
+  int attempt_ = 1;
+};
+
+}  // namespace agentixx
@@ -0,0 +1,219 @@
+#include "agentixx/core/sse_parser.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "sse_scan.hpp"
+
+namespace agentixx {
+
+namespace {
+
+constexpr std::string_view kBom = "\xEF\xBB\xBF";
+
+// Окно векторного сканирования: список окончаний строк остается
+// небольшим даже для больших пачек данных
+constexpr size_t kScanWindow = 64 * 1024;
+
+}  // namespace
+
+void SseParser::Feed(std::string_view input, const EventHandler& on_event) {
+  // Следующее окончание строки (CR или LF) не раньше pos, npos - строка не
+  // завершена. Кусок сканируется окнами, смещения окна от base
+  size_t scanned = 0;
+  size_t base = 0;
+  size_t next = 0;
+  line_ends_.clear();
+  auto find_line_end = [&](size_t pos) {
+    while (true) {
+      for (; next < line_ends_.size(); ++next) {
+        size_t end = base + line_ends_[next];
+        if (end >= pos) {
+          return end;
+        }
+      }
+      if (scanned == input.size()) {
+        return std::string_view::npos;
+      }
+
+      size_t size = std::min(kScanWindow, input.size() - scanned);
+      line_ends_.clear();
+      next = 0;
+      base = scanned;
+      ScanLineEnds(input.data() + scanned, size, &line_ends_);
+      scanned += size;
+    }
+  };
+
+  // Начало строки за окончанием в позиции end (CRLF, LF или CR)
+  auto skip_line_end = [&](size_t end) {
+    if (input[end] == '\r') {
+      if (end + 1 == input.size()) {
+        pending_cr_ = true;
+      } else if (input[end + 1] == '\n') {
+        return end + 2;
+      }
+    }
+    return end + 1;
+  };
+
+  size_t pos = 0;
+  if (pending_cr_ && !input.empty()) {
+    pending_cr_ = false;
+    if (input[0] == '\n') {
+      pos = 1;
+    }
+  }
+
+  // Дописываем строку, начатую в предыдущем куске
+  if (!carry_.empty()) {
+    size_t end = find_line_end(pos);
+    if (end == std::string_view::npos) {
+      carry_.append(input.data() + pos, input.size() - pos);
+      return;
+    }
+    carry_.append(input.data() + pos, end - pos);
+    ProcessLine(carry_, on_event);
+    Materialize();
+    carry_.clear();
+    pos = skip_line_end(end);
+  }
+
+  while (pos < input.size()) {
+    size_t end = find_line_end(pos);
+    if (end == std::string_view::npos) {
+      carry_.assign(input.data() + pos, input.size() - pos);
+      break;
+    }
+    ProcessLine(input.substr(pos, end - pos), on_event);
+    pos = skip_line_end(end);
+  }
+
+  Materialize();
+}
+
+void SseParser::Reset() {
+  carry_.clear();
+  pending_cr_ = false;
+  started_ = false;
+  data_ = {};
+  data_in_buffer_ = false;
+  data_lines_ = 0;
+  event_type_.clear();
+}
+
+void SseParser::ProcessLine(std::string_view line,
+                            const EventHandler& on_event) {
+  if (!started_) {
+    started_ = true;
+    if (line.substr(0, kBom.size()) == kBom) {
+      line.remove_prefix(kBom.size());
+    }
+  }
+
+  // Пустая строка завершает событие
+  if (line.empty()) {
+    Dispatch(on_event);
+    return;
+  }
+
+  if (IsDataLine(line)) {
+    std::string_view value = line.substr(5);
+    if (!value.empty() && value[0] == ' ') {
+      value.remove_prefix(1);
+    }
+    AppendData(value);
+    return;
+  }
+
+  // Комментарий (часто используется как keep-alive)
+  if (line[0] == ':') {
+    return;
+  }
+
+  size_t colon = line.find(':');
+  if (colon == std::string_view::npos) {
+    ProcessField(line, {});
+    return;
+  }
+
+  std::string_view value = line.substr(colon + 1);
+  if (!value.empty() && value[0] == ' ') {
+    value.remove_prefix(1);
+  }
+  ProcessField(line.substr(0, colon), value);
+}
+
+void SseParser::ProcessField(std::string_view field, std::string_view value) {
+  if (field == "data") {
+    AppendData(value);
+  } else if (field == "event") {
+    event_type_.assign(value);
+  } else if (field == "id") {
+    // id с NUL игнорируется по спецификации
+    if (value.find('\0') == std::string_view::npos) {
+      last_event_id_.assign(value);
+    }
+  } else if (field == "retry") {
+    if (value.empty()) {
+      return;
+    }
+    long retry = 0;
+    for (char c : value) {
+      if (c < '0' || c > '9' ||
+          retry > (std::numeric_limits<long>::max() - 9) / 10) {
+        return;
+      }
+      retry = retry * 10 + (c - '0');
+    }
+    retry_ms_ = retry;
+  }
+  // Остальные поля игнорируются
+}
+
+void SseParser::AppendData(std::string_view value) {
+  if (data_lines_ == 0) {
+    data_ = value;
+    data_in_buffer_ = false;
+  } else {
+    if (!data_in_buffer_) {
+      data_buffer_.assign(data_);
+      data_in_buffer_ = true;
+    }
+    data_buffer_ += '\n';
+    data_buffer_.append(value);
+    data_ = data_buffer_;
+  }
+  ++data_lines_;
+}
+
+void SseParser::Dispatch(const EventHandler& on_event) {
+  // Событие без data: не отправляется, но тип сбрасывается
+  if (data_lines_ == 0) {
+    event_type_.clear();
+    return;
+  }
+
+  SseEvent event;
+  event.type = event_type_.empty() ? std::string_view("message")
+                                   : std::string_view(event_type_);
+  event.data = data_;
+  event.id = last_event_id_;
+
+  data_ = {};
+  data_in_buffer_ = false;
+  data_lines_ = 0;
+
+  on_event(event);
+  event_type_.clear();
+}
+
+void SseParser::Materialize() {
+  if (data_lines_ > 0 && !data_in_buffer_) {
+    data_buffer_.assign(data_);
+    data_in_buffer_ = true;
+    data_ = data_buffer_;
+  }
+}
+
+}  // namespace agentixx
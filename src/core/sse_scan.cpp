@@ -0,0 +1,136 @@
+#include "sse_scan.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AGENTIXX_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace agentixx {
+
+namespace {
+
+#ifdef AGENTIXX_SCAN_X86
+// Смещения установленных битов маски совпадений блока
+inline void EmitMask(uint32_t mask, uint32_t base,
+                     std::vector<uint32_t>* ends) {
+  while (mask != 0) {
+    ends->push_back(base + static_cast<uint32_t>(__builtin_ctz(mask)));
+    mask &= mask - 1;
+  }
+}
+#endif
+
+void ScanTail(const char* data, size_t from, size_t size,
+              std::vector<uint32_t>* ends) {
+  for (size_t i = from; i < size; ++i) {
+    if (data[i] == '\n' || data[i] == '\r') {
+      ends->push_back(static_cast<uint32_t>(i));
+    }
+  }
+}
+
+using ScanFunction = void (*)(const char*, size_t, std::vector<uint32_t>*);
+
+ScanIsa DetectIsa() {
+#ifdef AGENTIXX_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return ScanIsa::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return ScanIsa::kSse2;
+  }
+#endif
+  return ScanIsa::kScalar;
+}
+
+ScanFunction SelectScan(ScanIsa isa) {
+  switch (isa) {
+    case ScanIsa::kAvx2:
+      return ScanLineEndsAvx2;
+    case ScanIsa::kSse2:
+      return ScanLineEndsSse2;
+    case ScanIsa::kScalar:
+      break;
+  }
+  return ScanLineEndsScalar;
+}
+
+}  // namespace
+
+void ScanLineEndsScalar(const char* data, size_t size,
+                        std::vector<uint32_t>* ends) {
+  ScanTail(data, 0, size, ends);
+}
+
+#ifdef AGENTIXX_SCAN_X86
+
+__attribute__((target("sse2"))) void ScanLineEndsSse2(
+    const char* data, size_t size, std::vector<uint32_t>* ends) {
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i hits =
+        _mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr));
+    EmitMask(static_cast<uint32_t>(_mm_movemask_epi8(hits)),
+             static_cast<uint32_t>(i), ends);
+  }
+  ScanTail(data, i, size, ends);
+}
+
+__attribute__((target("avx2"))) void ScanLineEndsAvx2(
+    const char* data, size_t size, std::vector<uint32_t>* ends) {
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(block, lf),
+                                   _mm256_cmpeq_epi8(block, cr));
+    EmitMask(static_cast<uint32_t>(_mm256_movemask_epi8(hits)),
+             static_cast<uint32_t>(i), ends);
+  }
+  ScanTail(data, i, size, ends);
+}
+
+#else
+
+void ScanLineEndsSse2(const char* data, size_t size,
+                      std::vector<uint32_t>* ends) {
+  ScanLineEndsScalar(data, size, ends);
+}
+
+void ScanLineEndsAvx2(const char* data, size_t size,
+                      std::vector<uint32_t>* ends) {
+  ScanLineEndsScalar(data, size, ends);
+}
+
+#endif
+
+bool ScanIsaSupported(ScanIsa isa) {
+  switch (isa) {
+    case ScanIsa::kScalar:
+      return true;
+    case ScanIsa::kSse2:
+      return ActiveScanIsa() != ScanIsa::kScalar;
+    case ScanIsa::kAvx2:
+      return ActiveScanIsa() == ScanIsa::kAvx2;
+  }
+  return false;
+}
+
+ScanIsa ActiveScanIsa() {
+  static const ScanIsa isa = DetectIsa();
+  return isa;
+}
+
+void ScanLineEnds(const char* data, size_t size, std::vector<uint32_t>* ends) {
+  static const ScanFunction scan = SelectScan(ActiveScanIsa());
+  scan(data, size, ends);
+}
+
+}  // namespace agentixx
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace agentixx {
+
+// Векторный поиск окончаний строк SSE потока.
+//
+// Буфер сканируется целиком за один проход: все байты CR и LF находятся
+// сравнением 16 (SSE2) или 32 (AVX2) байт за инструкцию, затем парсер
+// идет по готовому списку смещений. Реализация выбирается один раз по
+// возможностям процессора, на других архитектурах - скалярный цикл.
+
+// Набор инструкций реализации
+enum class ScanIsa { kScalar, kSse2, kAvx2 };
+
+// Дописать в ends смещения (от data) всех байтов CR и LF.
+// Выбранная при запуске реализация
+void ScanLineEnds(const char* data, size_t size, std::vector<uint32_t>* ends);
+
+// Конкретные реализации, для бенчмарков. Вызывать только поддерживаемые
+void ScanLineEndsScalar(const char* data, size_t size,
+                        std::vector<uint32_t>* ends);
+void ScanLineEndsSse2(const char* data, size_t size,
+                      std::vector<uint32_t>* ends);
+void ScanLineEndsAvx2(const char* data, size_t size,
+                      std::vector<uint32_t>* ends);
+
+bool ScanIsaSupported(ScanIsa isa);
+ScanIsa ActiveScanIsa();
+
+// Строка "data:..." - единственное поле на каждом токене, поэтому
+// проверяется одним сравнением до общего разбора поля
+inline bool IsDataLine(std::string_view line) {
+  return line.size() >= 5 && std::memcmp(line.data(), "data:", 5) == 0;
+}
+
+}  // namespace agentixx
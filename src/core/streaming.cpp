@@ -0,0 +1,443 @@
+#include "agentixx/core/streaming.hpp"
+
+#include <algorithm>
+
+#include "chunk_decoder.hpp"
+
+namespace agentixx {
+
+// StreamChunk
+
+namespace {
+
+void ReadString(const Json& object, const char* key, std::string* out) {
+  auto it = object.find(key);
+  if (it != object.end() && it->is_string()) {
+    *out = it->get<std::string>();
+  }
+}
+
+template <typename T>
+void ReadInteger(const Json& object, const char* key, T* out) {
+  auto it = object.find(key);
+  if (it != object.end() && it->is_number_integer()) {
+    *out = it->get<T>();
+  }
+}
+
+}  // namespace
+
+StreamChunk::StreamChunk(const Json& data)
+    : raw_data_(data), has_raw_data_(true) {
+  if (!data.is_object()) {
+    return;
+  }
+
+  auto choices = data.find("choices");
+  if (choices != data.end() && choices->is_array() && !choices->empty() &&
+      choices->front().is_object()) {
+    const Json& choice = choices->front();
+    ReadInteger(choice, "index", &choice_index);
+    ReadString(choice, "text", &content);
+
+    auto reason = choice.find("finish_reason");
+    if (reason != choice.end() && reason->is_string()) {
+      finish_reason = reason->get<std::string>();
+    }
+
+    // Извлекаем контент из delta
+    auto delta = choice.find("delta");
+    if (delta != choice.end() && delta->is_object()) {
+      ReadString(*delta, "content", &content);
+
+      auto calls = delta->find("tool_calls");
+      if (calls != delta->end() && calls->is_array()) {
+        for (const auto& call : *calls) {
+          if (!call.is_object()) {
+            continue;
+          }
+          ToolCallDelta tool_call;
+          ReadInteger(call, "index", &tool_call.index);
+          ReadString(call, "id", &tool_call.id);
+          auto function = call.find("function");
+          if (function != call.end() && function->is_object()) {
+            ReadString(*function, "name", &tool_call.name);
+            ReadString(*function, "arguments", &tool_call.arguments);
+          }
+          tool_calls.push_back(std::move(tool_call));
+        }
+      }
+    }
+  }
+
+  auto usage_it = data.find("usage");
+  if (usage_it != data.end() && usage_it->is_object()) {
+    TokenUsage token_usage;
+    ReadInteger(*usage_it, "prompt_tokens", &token_usage.prompt_tokens);
+    ReadInteger(*usage_it, "completion_tokens",
+                &token_usage.completion_tokens);
+    ReadInteger(*usage_it, "total_tokens", &token_usage.total_tokens);
+    usage = token_usage;
+  }
+}
+
+StreamChunk StreamChunk::FromJson(std::string_view json) {
+  StreamChunk chunk;
+  if (DecodeStreamChunk(json, &chunk)) {
+    chunk.raw_json_.assign(json);
+    return chunk;
+  }
+
+  // Неожиданная структура или некорректный JSON: полный разбор
+  // (заодно дает нормальное сообщение об ошибке)
+  try {
+    return StreamChunk(Json::parse(json.begin(), json.end()));
+  } catch (const Json::parse_error& e) {
+    throw ParseError(e.what());
+  }
+}
+
+size_t StreamChunk::ByteSize() const {
+  size_t size = sizeof(StreamChunk) + content.capacity() +
+                raw_json_.capacity() +
+                tool_calls.capacity() * sizeof(ToolCallDelta);
+  if (finish_reason) {
+    size += finish_reason->capacity();
+  }
+  for (const auto& call : tool_calls) {
+    size += call.id.capacity() + call.name.capacity() +
+            call.arguments.capacity();
+  }
+  return size;
+}
+
+const Json& StreamChunk::raw() const {
+  if (!has_raw_data_) {
+    if (!raw_json_.empty()) {
+      try {
+        raw_data_ = Json::parse(raw_json_);
+      } catch (const Json::parse_error& e) {
+        throw ParseError(e.what());
+      }
+    }
+    has_raw_data_ = true;
+  }
+  return raw_data_;
+}
+
+// StreamChannel
+
+StreamChannel::StreamChannel(size_t capacity)
+    : slots_(std::max<size_t>(capacity, 1)) {}
+
+bool StreamChannel::Push(StreamChunk&& chunk) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load() == slots_.size()) {
+    // Флаг ставится до повторной проверки: consumer, освободивший место
+    // между ними, увидит флаг и вызовет on_space
+    blocked_.store(true);
+    if (tail - head_.load() == slots_.size()) {
+      return false;
+    }
+    blocked_.store(false);
+  }
+
+  slots_[tail % slots_.size()] = std::move(chunk);
+  tail_.store(tail + 1);
+  WakeConsumer();
+  return true;
+}
+
+void StreamChannel::Start(const HttpResponse& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    started_ = true;
+    info_ = info;
+  }
+  ready_.notify_all();
+}
+
+void StreamChannel::SetMetrics(const RequestMetrics& metrics) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  info_.metrics = metrics;
+}
+
+RequestMetrics StreamChannel::metrics() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return info_.metrics;
+}
+
+void StreamChannel::Close(std::exception_ptr error) {
+  std::function<void()> on_space;
+  std::function<void()> on_ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = error;
+    closed_.store(true);
+    // Callback держит producer, сбрасываем его, чтобы разорвать цикл ссылок
+    on_space.swap(on_space_);
+    on_ready.swap(on_ready_);
+  }
+  ready_.notify_all();
+  if (on_ready) {
+    on_ready();
+  }
+}
+
+void StreamChannel::SetOnSpace(std::function<void()> on_space) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!closed_.load() && !cancelled_.load()) {
+    on_space_ = std::move(on_space);
+  }
+}
+
+void StreamChannel::WakeConsumer() {
+  // Пара tail_/waiting_ упорядочена seq_cst: либо consumer увидит новый
+  // chunk при проверке под mutex, либо producer увидит waiting_
+  if (waiting_.load()) {
+    std::function<void()> on_ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.notify_all();
+      if (on_ready_) {
+        on_ready.swap(on_ready_);
+        waiting_.store(false);
+      }
+    }
+    if (on_ready) {
+      on_ready();
+    }
+  }
+}
+
+void StreamChannel::NotifySpace() {
+  std::function<void()> on_space;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_space = on_space_;
+  }
+  if (on_space) {
+    on_space();
+  }
+}
+
+HttpResponse StreamChannel::WaitStarted() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ready_.wait(lock, [this] { return started_ || closed_.load(); });
+  if (!started_ && error_) {
+    std::rethrow_exception(error_);
+  }
+  return info_;
+}
+
+bool StreamChannel::Next(StreamChunk* chunk) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  while (true) {
+    if (head != tail_.load()) {
+      *chunk = std::move(slots_[head % slots_.size()]);
+      head_.store(head + 1);
+      if (blocked_.exchange(false)) {
+        NotifySpace();
+      }
+      return true;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Close вызывается producer после последнего Push, поэтому под mutex
+    // закрытый канал уже не получит новых chunks
+    if (closed_.load()) {
+      if (head != tail_.load()) {
+        continue;
+      }
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+      return false;
+    }
+
+    waiting_.store(true);
+    ready_.wait(lock,
+                [&] { return head != tail_.load() || closed_.load(); });
+    waiting_.store(false);
+  }
+}
+
+StreamChannel::Poll StreamChannel::TryNext(StreamChunk* chunk,
+                                           std::function<void()> on_ready) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  while (true) {
+    if (head != tail_.load()) {
+      *chunk = std::move(slots_[head % slots_.size()]);
+      head_.store(head + 1);
+      if (blocked_.exchange(false)) {
+        NotifySpace();
+      }
+      return Poll::kReady;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_.load()) {
+      if (head != tail_.load()) {
+        continue;
+      }
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+      return Poll::kDone;
+    }
+    if (!on_ready) {
+      return Poll::kPending;
+    }
+
+    // Как в Next: waiting_ ставится до повторной проверки tail_, поэтому
+    // chunk, положенный между ними, producer заметит по флагу
+    on_ready_ = std::move(on_ready);
+    waiting_.store(true);
+    if (head == tail_.load()) {
+      return Poll::kPending;
+    }
+    waiting_.store(false);
+    on_ready_ = nullptr;
+  }
+}
+
+void StreamChannel::Cancel() {
+  std::function<void()> on_space;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_.load() || cancelled_.load()) {
+      return;
+    }
+    cancelled_.store(true);
+    on_space.swap(on_space_);
+    on_ready_ = nullptr;
+  }
+  // Будим producer, если он ждет места в очереди
+  if (on_space) {
+    on_space();
+  }
+}
+
+// StreamingResponse
+
+StreamingResponse::State::~State() {
+  if (channel && !is_complete) {
+    channel->Cancel();
+  }
+}
+
+void StreamingResponse::State::Add(StreamChunk chunk) {
+  if (on_chunk) {
+    on_chunk(chunk);
+  }
+  if (!chunk.is_done) {
+    if (retention.keeps_text()) {
+      accumulated_text += chunk.content;
+    }
+  } else {
+    is_complete = true;
+  }
+
+  ++total;
+  size_t capacity = retention.capacity();
+  if (capacity == 0 || chunks.size() < capacity) {
+    chunks.push_back(std::move(chunk));
+  } else {
+    // Кольцо заполнено: новый chunk замещает самый старый
+    chunks[start] = std::move(chunk);
+    start = (start + 1) % chunks.size();
+  }
+}
+
+void StreamingResponse::State::Finish() {
+  is_complete = true;
+  if (total == 0 || !At(total - 1)->is_done) {
+    StreamChunk done_chunk;
+    done_chunk.is_done = true;
+    Add(std::move(done_chunk));
+  }
+}
+
+bool StreamingResponse::State::Fetch(size_t index) {
+  while (total <= index) {
+    if (is_complete || (!channel && !source)) {
+      return false;
+    }
+
+    StreamChunk chunk;
+    if (channel ? channel->Next(&chunk) : source(&chunk)) {
+      Add(std::move(chunk));
+    } else {
+      Finish();
+    }
+  }
+  return true;
+}
+
+const StreamChunk* StreamingResponse::State::At(size_t index) const {
+  size_t oldest = total - chunks.size();
+  if (index < oldest || index >= total) {
+    return nullptr;
+  }
+  return &chunks[(start + index - oldest) % chunks.size()];
+}
+
+void StreamingResponse::State::Linearize() {
+  if (start != 0) {
+    std::rotate(chunks.begin(), chunks.begin() + start, chunks.end());
+    start = 0;
+  }
+}
+
+StreamingResponse::StreamingResponse() : state_(std::make_shared<State>()) {}
+
+StreamingResponse::StreamingResponse(StreamRetention retention)
+    : StreamingResponse() {
+  state_->retention = retention;
+}
+
+StreamingResponse::StreamingResponse(std::shared_ptr<StreamChannel> channel,
+                                     StreamRetention retention)
+    : StreamingResponse(retention) {
+  state_->channel = std::move(channel);
+}
+
+StreamingResponse::StreamingResponse(std::function<bool(StreamChunk*)> source,
+                                     StreamRetention retention)
+    : StreamingResponse(retention) {
+  state_->source = std::move(source);
+}
+
+RequestMetrics StreamingResponse::metrics() const {
+  if (state_->metrics) {
+    return state_->metrics();
+  }
+  return state_->channel ? state_->channel->metrics() : RequestMetrics{};
+}
+
+std::string StreamingResponse::full_text() const {
+  state_->Drain();
+  return state_->accumulated_text;
+}
+
+const std::vector<StreamChunk>& StreamingResponse::chunks() const {
+  state_->Drain();
+  state_->Linearize();
+  return state_->chunks;
+}
+
+void StreamingResponse::SetRetention(StreamRetention retention) {
+  State& state = *state_;
+  state.Linearize();
+  size_t capacity = retention.capacity();
+  if (capacity > 0 && state.chunks.size() > capacity) {
+    size_t dropped = state.chunks.size() - capacity;
+    state.chunks.erase(state.chunks.begin(), state.chunks.begin() + dropped);
+  }
+  if (!retention.keeps_text()) {
+    std::string().swap(state.accumulated_text);
+  }
+  state.retention = retention;
+}
+
+}  // namespace agentixx
@@ -0,0 +1,296 @@
+#include "agentixx/core/tracing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+#include "agentixx/core/json_writer.hpp"
+
+namespace agentixx {
+
+namespace {
+
+// Текущий span потока
+thread_local TraceContext current_span;
+
+// Сдвиг steady_clock к Unix epoch, снимается один раз
+int64_t EpochOffset() {
+  static const int64_t offset = [] {
+    auto system = std::chrono::system_clock::now().time_since_epoch();
+    auto steady = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(system - steady)
+            .count());
+  }();
+  return offset;
+}
+
+// Случайные идентификаторы: splitmix64 со своим состоянием в каждом потоке
+uint64_t RandomId() {
+  thread_local uint64_t state = [] {
+    std::random_device device;
+    return (uint64_t{device()} << 32) ^ device() ^
+           std::hash<std::thread::id>()(std::this_thread::get_id());
+  }();
+  uint64_t id;
+  do {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    id = z ^ (z >> 31);
+  } while (id == 0);
+  return id;
+}
+
+std::string Hex(uint64_t value) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+OtlpJsonFileSink::OtlpJsonFileSink(const std::string& path,
+                                   const std::string& service_name)
+    : out_(path, std::ios::binary | std::ios::app),
+      service_name_(service_name) {
+  if (!out_) {
+    throw AgentCppException("Failed to open trace file: " + path);
+  }
+}
+
+void OtlpJsonFileSink::Export(const std::vector<SpanRecord>& spans) {
+  if (spans.empty()) {
+    return;
+  }
+  std::string line = Serialize(spans, service_name_);
+  line.push_back('\n');
+  std::lock_guard<std::mutex> lock(mutex_);
+  out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+  out_.flush();
+}
+
+std::string OtlpJsonFileSink::Serialize(const std::vector<SpanRecord>& spans,
+                                        const std::string& service_name) {
+  std::string out;
+  out.reserve(256 + spans.size() * 256);
+
+  // OTLP/JSON: идентификаторы - hex строки, 64-битные числа - строки
+  JsonWriter writer(&out);
+  writer.BeginObject().Key("resourceSpans").BeginArray().BeginObject();
+  writer.Key("resource").BeginObject().Key("attributes").BeginArray();
+  writer.BeginObject().Key("key").String("service.name").Key("value");
+  writer.BeginObject().Key("stringValue").String(service_name).EndObject();
+  writer.EndObject().EndArray().EndObject();
+
+  writer.Key("scopeSpans").BeginArray().BeginObject();
+  writer.Key("scope").BeginObject().Key("name").String("agentixx");
+  writer.EndObject().Key("spans").BeginArray();
+  for (const SpanRecord& span : spans) {
+    writer.BeginObject()
+        .Key("traceId")
+        .String(Hex(span.trace_id_high) + Hex(span.trace_id_low))
+        .Key("spanId")
+        .String(Hex(span.span_id));
+    if (span.parent_id != 0) {
+      writer.Key("parentSpanId").String(Hex(span.parent_id));
+    }
+    writer.Key("name")
+        .String(span.name)
+        .Key("kind")
+        .Int(static_cast<int>(span.kind))
+        .Key("startTimeUnixNano")
+        .String(std::to_string(span.start_ns))
+        .Key("endTimeUnixNano")
+        .String(std::to_string(span.end_ns));
+    if (span.attribute) {
+      writer.Key("attributes").BeginArray().BeginObject();
+      writer.Key("key").String(span.attribute).Key("value").BeginObject();
+      writer.Key("intValue").String(std::to_string(span.attribute_value));
+      writer.EndObject().EndObject().EndArray();
+    }
+    writer.EndObject();
+  }
+  writer.EndArray().EndObject().EndArray();
+  writer.EndObject().EndArray().EndObject();
+  return out;
+}
+
+class Tracer::Impl {
+ public:
+  explicit Impl(TracerOptions options)
+      : options_(std::move(options)),
+        mask_(RoundUpToPowerOfTwo(std::max<size_t>(options_.capacity, 2)) -
+              1),
+        slots_(new Slot[mask_ + 1]) {
+    if (options_.sink && options_.flush_interval.count() > 0) {
+      thread_ = std::thread([this] { Run(); });
+    }
+  }
+
+  ~Impl() {
+    if (thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopping_ = true;
+      }
+      stop_cv_.notify_one();
+      thread_.join();
+    }
+    try {
+      Flush();
+    } catch (...) {
+      // Деструктор не бросает: spans с ошибкой sink теряются
+    }
+  }
+
+  void Record(const SpanRecord& span) {
+    uint64_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[ticket & mask_];
+    // Нечетная версия - слот пишется; читатель пропустит его
+    slot.version.store(ticket * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.span = span;
+    slot.version.store(ticket * 2 + 2, std::memory_order_release);
+  }
+
+  std::vector<SpanRecord> Drain() {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    std::vector<SpanRecord> spans;
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t capacity = mask_ + 1;
+    if (head - tail_ > capacity) {
+      dropped_.fetch_add(head - capacity - tail_, std::memory_order_relaxed);
+      tail_ = head - capacity;
+    }
+    spans.reserve(head - tail_);
+
+    for (; tail_ < head; ++tail_) {
+      const Slot& slot = slots_[tail_ & mask_];
+      uint64_t expected = tail_ * 2 + 2;
+      uint64_t version = slot.version.load(std::memory_order_acquire);
+      if (version < expected) {
+        // Писатель еще не закончил: продолжим со следующего Drain
+        break;
+      }
+      SpanRecord span = slot.span;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version != expected ||
+          slot.version.load(std::memory_order_relaxed) != version) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      spans.push_back(span);
+    }
+    return spans;
+  }
+
+  void Flush() {
+    std::vector<SpanRecord> spans = Drain();
+    if (options_.sink && !spans.empty()) {
+      std::lock_guard<std::mutex> lock(export_mutex_);
+      options_.sink->Export(spans);
+    }
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> version{0};
+    SpanRecord span;
+  };
+
+  TracerOptions options_;
+  const uint64_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  // Писатели на отдельной cache line от читателя
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) uint64_t tail_ = 0;  // Под drain_mutex_
+  std::atomic<uint64_t> dropped_{0};
+  std::mutex drain_mutex_;
+  std::mutex export_mutex_;  // Export не вызывается параллельно
+
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  bool stopping_ = false;
+  std::thread thread_;
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stop_cv_.wait_for(lock, options_.flush_interval,
+                              [this] { return stopping_; })) {
+      lock.unlock();
+      try {
+        Flush();
+      } catch (...) {
+        // Ошибка sink не должна останавливать выгрузку
+      }
+      lock.lock();
+    }
+  }
+};
+
+Tracer::Tracer(TracerOptions options)
+    : pimpl_(std::make_unique<Impl>(std::move(options))) {}
+
+Tracer::~Tracer() = default;
+
+void Tracer::Record(const SpanRecord& span) { pimpl_->Record(span); }
+
+std::vector<SpanRecord> Tracer::Drain() { return pimpl_->Drain(); }
+
+void Tracer::Flush() { pimpl_->Flush(); }
+
+uint64_t Tracer::dropped() const { return pimpl_->dropped(); }
+
+int64_t Tracer::Now() {
+  auto steady = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(steady).count() +
+         EpochOffset();
+}
+
+TraceContext Tracer::Current() { return current_span; }
+
+TraceContext Tracer::Child(const TraceContext& parent) {
+  TraceContext child = parent;
+  if (!child.valid()) {
+    child.trace_id_high = RandomId();
+    child.trace_id_low = RandomId();
+  }
+  child.span_id = RandomId();
+  return child;
+}
+
+void ScopedSpan::Start(const char* name, const TraceContext& parent) {
+  previous_ = current_span;
+  TraceContext context = Tracer::Child(parent);
+  current_span = context;
+
+  span_.name = name;
+  span_.trace_id_high = context.trace_id_high;
+  span_.trace_id_low = context.trace_id_low;
+  span_.span_id = context.span_id;
+  span_.parent_id = parent.valid() ? parent.span_id : 0;
+  span_.start_ns = Tracer::Now();
+}
+
+void ScopedSpan::Finish() {
+  span_.end_ns = Tracer::Now();
+  tracer_->Record(span_);
+  current_span = previous_;
+}
+
+}  // namespace agentixx
@@ -0,0 +1,471 @@
+#include "agentixx/llm/caching_adapter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "agentixx/core/json_writer.hpp"
+#include "request_key.hpp"
+
+namespace agentixx {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Chunks = std::vector<StreamChunk>;
+
+// Накладные расходы записи сверх ключа и ответа: узлы списка и таблицы
+constexpr size_t kEntryOverhead = 128;
+
+// Ответ из кэша. Данные неизменяемы и разделяются между попаданиями
+struct CachedValue {
+  std::shared_ptr<const Json> response;  // Complete/Chat
+  std::shared_ptr<const Chunks> chunks;  // CompleteStream/ChatStream
+};
+
+size_t ByteSize(const Chunks& chunks) {
+  size_t bytes = 0;
+  for (const auto& chunk : chunks) {
+    bytes += chunk.ByteSize();
+  }
+  return bytes;
+}
+
+StreamingResponse Replay(const Chunks& chunks) {
+  StreamingResponse response;
+  for (const auto& chunk : chunks) {
+    response.AddChunk(chunk);
+  }
+  response.finish();
+  return response;
+}
+
+// Значения на диске: 'R' и JSON ответа или 'S' и chunks потока по
+// строке. Chunk пишется в формате chat.completion.chunk из своих полей,
+// при чтении его разбирает тот же декодер, что и живой поток
+constexpr char kResponseTag = 'R';
+constexpr char kStreamTag = 'S';
+constexpr std::string_view kDoneLine = "[DONE]";
+
+void WriteChunk(const StreamChunk& chunk, std::string* out) {
+  if (chunk.done()) {
+    out->append(kDoneLine);
+    out->push_back('\n');
+    return;
+  }
+
+  JsonWriter writer(out);
+  writer.BeginObject().Key("choices").BeginArray().BeginObject();
+  writer.Key("index").Int(chunk.choice_index);
+  writer.Key("delta").BeginObject().Key("content").String(chunk.content);
+  if (!chunk.tool_calls.empty()) {
+    writer.Key("tool_calls").BeginArray();
+    for (const auto& call : chunk.tool_calls) {
+      writer.BeginObject()
+          .Key("index")
+          .Int(call.index)
+          .Key("id")
+          .String(call.id)
+          .Key("function")
+          .BeginObject()
+          .Key("name")
+          .String(call.name)
+          .Key("arguments")
+          .String(call.arguments)
+          .EndObject()
+          .EndObject();
+    }
+    writer.EndArray();
+  }
+  writer.EndObject().Key("finish_reason");
+  if (chunk.finish_reason) {
+    writer.String(*chunk.finish_reason);
+  } else {
+    writer.Null();
+  }
+  writer.EndObject().EndArray();
+  if (chunk.usage) {
+    writer.Key("usage")
+        .BeginObject()
+        .Key("prompt_tokens")
+        .Int(chunk.usage->prompt_tokens)
+        .Key("completion_tokens")
+        .Int(chunk.usage->completion_tokens)
+        .Key("total_tokens")
+        .Int(chunk.usage->total_tokens)
+        .EndObject();
+  }
+  writer.EndObject();
+  out->push_back('\n');
+}
+
+std::string EncodeChunks(const Chunks& chunks) {
+  std::string out(1, kStreamTag);
+  for (const auto& chunk : chunks) {
+    WriteChunk(chunk, &out);
+  }
+  return out;
+}
+
+// Значение с диска и его объем в памяти. Поврежденное значение - промах
+std::optional<std::pair<CachedValue, size_t>> Decode(std::string_view data) {
+  if (data.empty()) {
+    return std::nullopt;
+  }
+  char tag = data.front();
+  data.remove_prefix(1);
+  try {
+    if (tag == kResponseTag) {
+      auto json = std::make_shared<const Json>(
+          Json::parse(data.begin(), data.end()));
+      return std::make_pair(CachedValue{std::move(json), nullptr},
+                            data.size());
+    }
+    if (tag == kStreamTag) {
+      auto chunks = std::make_shared<Chunks>();
+      while (!data.empty()) {
+        size_t end = data.find('\n');
+        std::string_view line = data.substr(0, end);
+        if (line == kDoneLine) {
+          StreamChunk done;
+          done.is_done = true;
+          chunks->push_back(std::move(done));
+        } else {
+          chunks->push_back(StreamChunk::FromJson(line));
+        }
+        data.remove_prefix(end == std::string_view::npos ? data.size()
+                                                         : end + 1);
+      }
+      size_t bytes = ByteSize(*chunks);
+      return std::make_pair(CachedValue{nullptr, std::move(chunks)}, bytes);
+    }
+  } catch (const std::exception&) {
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+class CachingAdapter::Impl : public std::enable_shared_from_this<Impl> {
+ public:
+  explicit Impl(const CacheOptions& options)
+      : ttl_(options.ttl),
+        shards_(std::max<size_t>(options.shards, 1)),
+        disk_(options.disk) {
+    shard_bytes_ = options.max_bytes / shards_.size();
+  }
+
+  std::optional<CachedValue> Find(const RequestKey& key) {
+    Shard& shard = ShardFor(key.hash);
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.index.find(key.hash);
+      if (it != shard.index.end() && it->second->key == key.body) {
+        auto entry = it->second;
+        if (ttl_.count() > 0 && Clock::now() >= entry->expires) {
+          shard.Erase(entry);
+          evictions_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          // Попадание поднимает запись в начало LRU
+          shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+          hits_.fetch_add(1, std::memory_order_relaxed);
+          return entry->value;
+        }
+      }
+    }
+    if (auto found = FindOnDisk(key)) {
+      return found;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  // Записать в память и на диск. encoded - значение в формате диска
+  void Store(RequestKey key, CachedValue value, size_t value_bytes,
+             const std::string& encoded) {
+    if (disk_) {
+      try {
+        disk_->Put(key.body, encoded);
+      } catch (const AgentCppException&) {
+        // Диск - только кэш: ошибка записи не должна ронять запрос
+      }
+    }
+    StoreInMemory(std::move(key), std::move(value), value_bytes);
+  }
+
+  void StoreInMemory(RequestKey key, CachedValue value, size_t value_bytes) {
+    size_t bytes = key.body.capacity() + value_bytes + kEntryOverhead;
+    if (bytes > shard_bytes_) {
+      return;
+    }
+
+    Shard& shard = ShardFor(key.hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Тот же хеш: повтор того же запроса или коллизия, новая запись
+    // замещает старую
+    auto it = shard.index.find(key.hash);
+    if (it != shard.index.end()) {
+      shard.Erase(it->second);
+    }
+    while (shard.bytes + bytes > shard_bytes_) {
+      shard.Erase(std::prev(shard.lru.end()));
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t hash = key.hash;
+    shard.lru.push_front(
+        {std::move(key.body), hash, std::move(value), bytes,
+         Clock::now() + ttl_});
+    shard.index.emplace(hash, shard.lru.begin());
+    shard.bytes += bytes;
+  }
+
+  void StoreResponse(RequestKey key, const Response& response) {
+    if (!response.IsSuccess()) {
+      return;
+    }
+    auto json = std::make_shared<const Json>(response.raw());
+    std::string encoded(1, kResponseTag);
+    encoded += json->dump();
+    size_t bytes = encoded.size();
+    Store(std::move(key), {std::move(json), nullptr}, bytes, encoded);
+  }
+
+  // Запомнить поток, когда его дочитают до конца. Ответ, брошенный раньше
+  // или завершившийся ошибкой, до done() не доходит и не кэшируется
+  StreamingResponse RecordStream(RequestKey key, StreamingResponse response) {
+    if (response.IsComplete()) {
+      // Буферизованный ответ адаптера без живого канала
+      if (response.retention().mode == StreamRetention::Mode::kAll) {
+        auto chunks = std::make_shared<const Chunks>(response.chunks());
+        Store(std::move(key), {nullptr, chunks}, ByteSize(*chunks),
+              EncodeChunks(*chunks));
+      }
+      return response;
+    }
+
+    struct Recorder {
+      std::weak_ptr<Impl> impl;
+      RequestKey key;
+      std::shared_ptr<Chunks> chunks = std::make_shared<Chunks>();
+      size_t bytes = 0;
+    };
+    auto recorder = std::make_shared<Recorder>();
+    recorder->impl = weak_from_this();
+    recorder->key = std::move(key);
+    response.SetOnChunk([recorder](const StreamChunk& chunk) {
+      if (!recorder->chunks) {
+        return;
+      }
+      recorder->chunks->push_back(chunk);
+      recorder->bytes += chunk.ByteSize();
+      if (chunk.done()) {
+        if (auto impl = recorder->impl.lock()) {
+          std::string encoded = EncodeChunks(*recorder->chunks);
+          impl->Store(std::move(recorder->key),
+                      {nullptr, std::move(recorder->chunks)},
+                      recorder->bytes, encoded);
+        }
+        recorder->chunks.reset();
+      }
+    });
+    return response;
+  }
+
+  CacheStats Stats() {
+    CacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.disk_hits = disk_hits_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      stats.entries += shard.lru.size();
+      stats.bytes += shard.bytes;
+    }
+    return stats;
+  }
+
+  void Clear() {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.lru.clear();
+      shard.index.clear();
+      shard.bytes = 0;
+    }
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    uint64_t hash;
+    CachedValue value;
+    size_t bytes;
+    Clock::time_point expires;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::list<Entry> lru;  // В начале - последние использованные
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+
+    void Erase(std::list<Entry>::iterator entry) {
+      bytes -= entry->bytes;
+      index.erase(entry->hash);
+      lru.erase(entry);
+    }
+  };
+
+  std::chrono::milliseconds ttl_;
+  size_t shard_bytes_;
+  std::vector<Shard> shards_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> disk_hits_{0};
+  std::shared_ptr<DiskCache> disk_;
+  std::atomic<uint64_t> evictions_{0};
+
+  // Промах в памяти: найденное на диске поднимается в память
+  std::optional<CachedValue> FindOnDisk(const RequestKey& key) {
+    if (!disk_) {
+      return std::nullopt;
+    }
+    std::optional<std::string> data;
+    try {
+      data = disk_->Get(key.body);
+    } catch (const AgentCppException&) {
+      return std::nullopt;
+    }
+    if (!data) {
+      return std::nullopt;
+    }
+    auto decoded = Decode(*data);
+    if (!decoded) {
+      return std::nullopt;
+    }
+    StoreInMemory(key, decoded->first, decoded->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    disk_hits_.fetch_add(1, std::memory_order_relaxed);
+    return decoded->first;
+  }
+
+  Shard& ShardFor(uint64_t hash) {
+    // Старшие биты: младшие уже выбирают корзину unordered_map
+    return shards_[(hash >> 32) % shards_.size()];
+  }
+};
+
+CachingAdapter::CachingAdapter(LLMInterface& inner, CacheOptions options)
+    : inner_(inner), impl_(std::make_shared<Impl>(options)) {}
+
+CachingAdapter::CachingAdapter(std::unique_ptr<LLMInterface> inner,
+                               CacheOptions options)
+    : owned_(std::move(inner)),
+      inner_(*owned_),
+      impl_(std::make_shared<Impl>(options)) {}
+
+CachingAdapter::~CachingAdapter() = default;
+
+Response CachingAdapter::Complete(const std::string& prompt) {
+  RequestKey key = CompletionKey(ModelName(), prompt, false);
+  if (auto cached = impl_->Find(key)) {
+    return Response(*cached->response);
+  }
+  Response response = inner_.Complete(prompt);
+  impl_->StoreResponse(std::move(key), response);
+  return response;
+}
+
+Response CachingAdapter::Chat(const std::vector<Message>& messages) {
+  RequestKey key = ChatKey(ModelName(), messages, false);
+  if (auto cached = impl_->Find(key)) {
+    return Response(*cached->response);
+  }
+  Response response = inner_.Chat(messages);
+  impl_->StoreResponse(std::move(key), response);
+  return response;
+}
+
+StreamingResponse CachingAdapter::CompleteStream(const std::string& prompt) {
+  RequestKey key = CompletionKey(ModelName(), prompt, true);
+  if (auto cached = impl_->Find(key)) {
+    return Replay(*cached->chunks);
+  }
+  return impl_->RecordStream(std::move(key), inner_.CompleteStream(prompt));
+}
+
+StreamingResponse CachingAdapter::ChatStream(
+    const std::vector<Message>& messages) {
+  RequestKey key = ChatKey(ModelName(), messages, true);
+  if (auto cached = impl_->Find(key)) {
+    return Replay(*cached->chunks);
+  }
+  return impl_->RecordStream(std::move(key), inner_.ChatStream(messages));
+}
+
+std::vector<BatchResult> CachingAdapter::ChatBatch(
+    const std::vector<std::vector<Message>>& batch,
+    const BatchOptions& options) {
+  std::string model = ModelName();
+  std::vector<BatchResult> results(batch.size());
+  std::vector<size_t> missing;
+  std::vector<RequestKey> keys;
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    results[i].index = i;
+    RequestKey key = ChatKey(model, batch[i], false, &options);
+    if (auto cached = impl_->Find(key)) {
+      results[i].response = Response(*cached->response);
+      if (options.on_result) {
+        options.on_result(results[i]);
+      }
+    } else {
+      missing.push_back(i);
+      keys.push_back(std::move(key));
+    }
+  }
+  if (missing.empty()) {
+    return results;
+  }
+
+  std::vector<std::vector<Message>> rest;
+  rest.reserve(missing.size());
+  for (size_t index : missing) {
+    rest.push_back(batch[index]);
+  }
+
+  // Индексы подпакета переводятся в индексы исходного пакета
+  BatchOptions rest_options = options;
+  rest_options.on_result = [&](const BatchResult& result) {
+    BatchResult& slot = results[missing[result.index]];
+    slot = result;
+    slot.index = missing[result.index];
+    if (result.ok()) {
+      impl_->StoreResponse(std::move(keys[result.index]), result.response);
+    }
+    if (options.on_result) {
+      options.on_result(slot);
+    }
+  };
+  std::vector<BatchResult> rest_results = inner_.ChatBatch(rest, rest_options);
+  for (auto& result : rest_results) {
+    size_t index = missing[result.index];
+    results[index] = std::move(result);
+    results[index].index = index;
+  }
+  return results;
+}
+
+std::string CachingAdapter::ModelName() const { return inner_.ModelName(); }
+
+CacheStats CachingAdapter::stats() const { return impl_->Stats(); }
+
+void CachingAdapter::Clear() { impl_->Clear(); }
+
+}  // namespace agentixx
@@ -0,0 +1,383 @@
+#include "agentixx/llm/coalescing_adapter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include "request_key.hpp"
+
+namespace agentixx {
+
+namespace {
+
+// Общий поток одного запроса. upstream читает тот подписчик, которому
+// следующий chunk нужен первым, остальные берут его из chunks. Chunks,
+// прочитанные всеми подписчиками, удаляются, если политика хранения не
+// kAll: тогда память потока не зависит от длины генерации
+struct Broadcast {
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool started = false;  // Ответ API получен или запрос упал
+  bool reading = false;  // Кто-то из подписчиков ждет chunk из upstream
+  bool finished = false;
+  std::exception_ptr error;
+  std::optional<StreamingResponse> upstream;
+  std::optional<StreamingResponse::iterator> next;
+  StreamRetention retention;  // Политика хранения для подписчиков
+  std::deque<StreamChunk> chunks;
+  size_t base = 0;  // Номер chunks.front() в потоке
+  // Позиции подписчиков: сколько chunks каждый прочитал
+  std::vector<const size_t*> positions;
+  // Убрать запрос из таблицы запросов в полете
+  std::function<void()> on_finish;
+
+  ~Broadcast() {
+    if (on_finish) {
+      on_finish();
+    }
+  }
+
+  void Finish(std::unique_lock<std::mutex>& lock,
+              std::exception_ptr stream_error) {
+    finished = true;
+    error = stream_error;
+    std::function<void()> callback = std::move(on_finish);
+    on_finish = nullptr;
+    lock.unlock();
+    changed.notify_all();
+    if (callback) {
+      callback();
+    }
+    lock.lock();
+  }
+
+  // Новый подписчик получит поток с начала, только пока оно в буфере.
+  // Вызывается под mutex
+  bool Joinable() const { return base == 0; }
+
+  void Join(const size_t* position) { positions.push_back(position); }
+
+  void Leave(const size_t* position) {
+    std::lock_guard<std::mutex> lock(mutex);
+    positions.erase(std::find(positions.begin(), positions.end(), position));
+    Trim();
+  }
+
+  // Удалить chunks, которые прочитали все подписчики. Вызывается под mutex
+  void Trim() {
+    if (retention.mode == StreamRetention::Mode::kAll) {
+      return;
+    }
+    size_t read = base + chunks.size();
+    for (const size_t* position : positions) {
+      read = std::min(read, *position);
+    }
+    while (base < read) {
+      chunks.pop_front();
+      ++base;
+    }
+  }
+
+  // Следующий chunk для подписчика, который прочитал position chunks
+  bool Read(size_t* position, StreamChunk* chunk) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      if (*position < base + chunks.size()) {
+        *chunk = chunks[(*position)++ - base];
+        Trim();
+        return true;
+      }
+      if (finished) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+        return false;
+      }
+      if (reading) {
+        changed.wait(lock);
+        continue;
+      }
+
+      // Читаем из API без блокировки, остальные подписчики ждут на changed
+      reading = true;
+      lock.unlock();
+      std::optional<StreamChunk> received;
+      std::exception_ptr read_error;
+      try {
+        if (*next != upstream->end()) {
+          received = **next;
+          ++*next;
+        }
+      } catch (...) {
+        read_error = std::current_exception();
+      }
+      lock.lock();
+      reading = false;
+
+      if (received) {
+        bool done = received->done();
+        chunks.push_back(std::move(*received));
+        if (done) {
+          Finish(lock, nullptr);
+        } else {
+          changed.notify_all();
+        }
+      } else {
+        Finish(lock, read_error);
+      }
+    }
+  }
+};
+
+// Подписка на Broadcast: позиция читателя, снимается вместе с его
+// StreamingResponse
+struct Subscriber {
+  std::shared_ptr<Broadcast> flight;
+  size_t position = 0;
+
+  // Регистрация под flight->mutex
+  explicit Subscriber(std::shared_ptr<Broadcast> broadcast)
+      : flight(std::move(broadcast)) {
+    flight->Join(&position);
+  }
+  ~Subscriber() { flight->Leave(&position); }
+
+  Subscriber(const Subscriber&) = delete;
+  Subscriber& operator=(const Subscriber&) = delete;
+};
+
+// Chat запрос в полете: первый вызов выполняет его, остальные ждут
+struct PendingCall {
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+  Response response;
+  std::exception_ptr error;
+};
+
+}  // namespace
+
+class CoalescingAdapter::Impl : public std::enable_shared_from_this<Impl> {
+ public:
+  Response Call(const RequestKey& key, const std::function<Response()>& call) {
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<PendingCall> pending;
+    bool leader = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::shared_ptr<PendingCall>& slot = calls_[key];
+      if (!slot) {
+        slot = std::make_shared<PendingCall>();
+        leader = true;
+      }
+      pending = slot;
+    }
+
+    if (!leader) {
+      coalesced_.fetch_add(1, std::memory_order_relaxed);
+      std::unique_lock<std::mutex> lock(pending->mutex);
+      pending->finished.wait(lock, [&] { return pending->done; });
+      if (pending->error) {
+        std::rethrow_exception(pending->error);
+      }
+      return pending->response;
+    }
+
+    Response response;
+    std::exception_ptr error;
+    try {
+      response = call();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      calls_.erase(key);
+    }
+    {
+      std::lock_guard<std::mutex> lock(pending->mutex);
+      pending->response = response;
+      pending->error = error;
+      pending->done = true;
+    }
+    pending->finished.notify_all();
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return response;
+  }
+
+  StreamingResponse Stream(const RequestKey& key,
+                           const std::function<StreamingResponse()>& open) {
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    // Объявлены до блокировки: деструктор Broadcast берет mutex_, поэтому
+    // последняя ссылка не должна освобождаться под ним
+    std::shared_ptr<Broadcast> running;
+    std::shared_ptr<Subscriber> subscriber;
+    bool leader = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = streams_.find(key);
+      if (it != streams_.end()) {
+        running = it->second.lock();
+      }
+      if (running) {
+        // Начало потока уже удалено из буфера: опоздавший идет в API сам
+        std::lock_guard<std::mutex> flight_lock(running->mutex);
+        if (running->Joinable()) {
+          subscriber = std::make_shared<Subscriber>(running);
+        }
+      }
+      if (!subscriber) {
+        auto flight = std::make_shared<Broadcast>();
+        flight->on_finish = [self = weak_from_this(), key,
+                             raw = flight.get()] {
+          if (auto impl = self.lock()) {
+            impl->Forget(key, raw);
+          }
+        };
+        streams_[key] = flight;
+        leader = true;
+        std::lock_guard<std::mutex> flight_lock(flight->mutex);
+        subscriber = std::make_shared<Subscriber>(flight);
+      }
+    }
+
+    if (leader) {
+      Open(*subscriber->flight, open);
+    } else {
+      coalesced_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return Subscribe(std::move(subscriber));
+  }
+
+  CoalescingStats Stats() const {
+    CoalescingStats stats;
+    stats.requests = requests_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<RequestKey, std::shared_ptr<PendingCall>, RequestKeyHash>
+      calls_;
+  std::unordered_map<RequestKey, std::weak_ptr<Broadcast>, RequestKeyHash>
+      streams_;
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<uint64_t> coalesced_{0};
+
+  void Open(Broadcast& flight,
+            const std::function<StreamingResponse()>& open) {
+    std::optional<StreamingResponse> upstream;
+    std::exception_ptr error;
+    try {
+      upstream.emplace(open());
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(flight.mutex);
+    flight.started = true;
+    if (error) {
+      flight.Finish(lock, error);
+      std::rethrow_exception(error);
+    }
+    // Подписчики хранят chunks по политике обернутого адаптера, а
+    // upstream - только текущий: весь поток уже есть в flight.chunks
+    flight.retention = upstream->retention();
+    upstream->SetRetention(StreamRetention::None());
+    flight.upstream = std::move(upstream);
+    flight.next.emplace(flight.upstream->begin());
+    lock.unlock();
+    flight.changed.notify_all();
+  }
+
+  StreamingResponse Subscribe(std::shared_ptr<Subscriber> subscriber) {
+    Broadcast* flight = subscriber->flight.get();
+    {
+      std::unique_lock<std::mutex> lock(flight->mutex);
+      flight->changed.wait(lock, [&] { return flight->started; });
+      if (!flight->upstream) {
+        std::rethrow_exception(flight->error);
+      }
+    }
+
+    StreamRetention retention = flight->retention;
+    std::string protocol = flight->upstream->protocol();
+    StreamingResponse response(
+        [subscriber](StreamChunk* chunk) {
+          return subscriber->flight->Read(&subscriber->position, chunk);
+        },
+        retention);
+    response.SetProtocol(protocol);
+    return response;
+  }
+
+  void Forget(const RequestKey& key, const Broadcast* flight) {
+    std::shared_ptr<Broadcast> current;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(key);
+    if (it == streams_.end()) {
+      return;
+    }
+    current = it->second.lock();
+    // Запись уже может принадлежать новому запросу с тем же ключом
+    if (!current || current.get() == flight) {
+      streams_.erase(it);
+    }
+  }
+};
+
+CoalescingAdapter::CoalescingAdapter(LLMInterface& inner)
+    : inner_(inner), impl_(std::make_shared<Impl>()) {}
+
+CoalescingAdapter::CoalescingAdapter(std::unique_ptr<LLMInterface> inner)
+    : owned_(std::move(inner)),
+      inner_(*owned_),
+      impl_(std::make_shared<Impl>()) {}
+
+CoalescingAdapter::~CoalescingAdapter() = default;
+
+Response CoalescingAdapter::Complete(const std::string& prompt) {
+  return impl_->Call(CompletionKey(ModelName(), prompt, false),
+                     [&] { return inner_.Complete(prompt); });
+}
+
+Response CoalescingAdapter::Chat(const std::vector<Message>& messages) {
+  return impl_->Call(ChatKey(ModelName(), messages, false),
+                     [&] { return inner_.Chat(messages); });
+}
+
+StreamingResponse CoalescingAdapter::CompleteStream(
+    const std::string& prompt) {
+  return impl_->Stream(CompletionKey(ModelName(), prompt, true),
+                       [&] { return inner_.CompleteStream(prompt); });
+}
+
+StreamingResponse CoalescingAdapter::ChatStream(
+    const std::vector<Message>& messages) {
+  return impl_->Stream(ChatKey(ModelName(), messages, true),
+                       [&] { return inner_.ChatStream(messages); });
+}
+
+std::vector<BatchResult> CoalescingAdapter::ChatBatch(
+    const std::vector<std::vector<Message>>& batch,
+    const BatchOptions& options) {
+  return inner_.ChatBatch(batch, options);
+}
+
+std::string CoalescingAdapter::ModelName() const {
+  return inner_.ModelName();
+}
+
+CoalescingStats CoalescingAdapter::stats() const { return impl_->Stats(); }
+
+}  // namespace agentixx
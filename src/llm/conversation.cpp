@@ -0,0 +1,51 @@
+#include "agentixx/llm/conversation.hpp"
+
+#include <utility>
+
+#include "agentixx/core/json_writer.hpp"
+
+namespace agentixx {
+
+Conversation::Conversation() : json_("[]") {}
+
+Conversation Conversation::FromMessages(
+    const std::vector<Message>& messages) {
+  Conversation conversation;
+  conversation.messages_.reserve(messages.size());
+  conversation.offsets_.reserve(messages.size());
+  for (const auto& message : messages) {
+    conversation.Add(message);
+  }
+  return conversation;
+}
+
+void Conversation::Add(Message message) {
+  // Снимаем закрывающую скобку, дописываем элемент и закрываем снова
+  json_.pop_back();
+  offsets_.push_back(json_.size());
+  if (!messages_.empty()) {
+    json_.push_back(',');
+  }
+
+  JsonWriter writer(&json_);
+  message.WriteJson(writer);
+  json_.push_back(']');
+
+  messages_.push_back(std::move(message));
+}
+
+void Conversation::Add(const std::string& role, const std::string& content) {
+  Add(Message(role, content));
+}
+
+void Conversation::Truncate(size_t count) {
+  if (count >= messages_.size()) {
+    return;
+  }
+  json_.resize(offsets_[count]);
+  json_.push_back(']');
+  messages_.resize(count);
+  offsets_.resize(count);
+}
+
+}  // namespace agentixx
@@ -0,0 +1,594 @@
+#include "agentixx/llm/disk_cache.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "../core/hash.hpp"
+#include "agentixx/core/types.hpp"
+
+namespace agentixx {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr uint64_t kIndexMagic = 0x3158444958495841ull;  // "AXIXIDX1"
+constexpr uint32_t kIndexVersion = 1;
+constexpr uint32_t kRecordMagic = 0x43455241;  // "AREC"
+constexpr uint64_t kInitialSlots = 1 << 16;
+constexpr size_t kCopyBuffer = 1 << 20;
+
+// Заголовок файла index. Поля, которые писатель меняет на месте, читаются
+// и пишутся атомарно: файл разделяют процессы
+struct IndexHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t retired;  // 1 - файл заменен новым, читателям переоткрыть
+  uint64_t generation;  // Номер журнала data.<generation>.log
+  uint64_t capacity;    // Слотов, степень двойки
+  uint64_t count;
+  uint64_t live_bytes;
+  uint64_t reserved[2];
+};
+static_assert(sizeof(IndexHeader) == 64, "IndexHeader layout");
+
+// Слот индекса. hash == 0 - пустой слот, поэтому хеш ключа 0 заменяется 1.
+// Слот публикуется записью hash после offset
+struct Slot {
+  uint64_t hash;
+  uint64_t offset;
+};
+
+// Заголовок записи журнала, за ним key_size байт ключа и value_size байт
+// значения
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t checksum;   // Младшие биты хеша ключа и значения
+  int64_t expires_ms;  // Unix время в мс, 0 - бессрочно
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader layout");
+
+template <typename T>
+std::atomic<T>& Atomic(T& value) {
+  static_assert(sizeof(std::atomic<T>) == sizeof(T) &&
+                    std::atomic<T>::is_always_lock_free,
+                "Mapped atomics must be lock-free");
+  return *reinterpret_cast<std::atomic<T>*>(&value);
+}
+
+uint64_t KeyHash(std::string_view key) {
+  uint64_t hash = HashBytes(key);
+  return hash != 0 ? hash : 1;
+}
+
+uint32_t Checksum(std::string_view key, std::string_view value) {
+  return static_cast<uint32_t>(HashBytes(value, HashBytes(key)));
+}
+
+uint64_t RecordSize(const RecordHeader& header) {
+  return sizeof(RecordHeader) + uint64_t{header.key_size} + header.value_size;
+}
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+[[noreturn]] void ThrowErrno(const std::string& what,
+                             const std::string& path) {
+  throw AgentCppException("Disk cache: " + what + " " + path + ": " +
+                          std::strerror(errno));
+}
+
+bool ReadAt(int fd, void* data, size_t size, uint64_t offset) {
+  char* out = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t done = pread(fd, out, size, static_cast<off_t>(offset));
+    if (done < 0 && errno == EINTR) {
+      continue;
+    }
+    if (done <= 0) {
+      return false;
+    }
+    out += done;
+    size -= static_cast<size_t>(done);
+    offset += static_cast<uint64_t>(done);
+  }
+  return true;
+}
+
+bool WriteAt(int fd, const void* data, size_t size, uint64_t offset) {
+  const char* in = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t done = pwrite(fd, in, size, static_cast<off_t>(offset));
+    if (done < 0 && errno == EINTR) {
+      continue;
+    }
+    if (done <= 0) {
+      return false;
+    }
+    in += done;
+    size -= static_cast<size_t>(done);
+    offset += static_cast<uint64_t>(done);
+  }
+  return true;
+}
+
+uint64_t FileSize(int fd) {
+  struct stat st;
+  return fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
+
+// Открытые index и журнал одного поколения. Снимок неизменен: после
+// подмены файлов старый снимок дочитывают те, кто его уже взял
+struct Files {
+  int index_fd = -1;
+  int log_fd = -1;
+  void* map = MAP_FAILED;
+  size_t map_size = 0;
+  IndexHeader* header = nullptr;
+  Slot* slots = nullptr;
+  uint64_t mask = 0;
+
+  Files() = default;
+  Files(const Files&) = delete;
+  Files& operator=(const Files&) = delete;
+  ~Files() {
+    if (map != MAP_FAILED) {
+      munmap(map, map_size);
+    }
+    if (index_fd >= 0) {
+      close(index_fd);
+    }
+    if (log_fd >= 0) {
+      close(log_fd);
+    }
+  }
+
+  bool retired() const {
+    return Atomic(header->retired).load(std::memory_order_acquire) != 0;
+  }
+};
+
+// Эксклюзивная блокировка писателя на файле lock
+class FileLock {
+ public:
+  explicit FileLock(int fd) : fd_(fd) {
+    while (flock(fd_, LOCK_EX) != 0 && errno == EINTR) {
+    }
+  }
+  ~FileLock() { flock(fd_, LOCK_UN); }
+
+ private:
+  int fd_;
+};
+
+}  // namespace
+
+class DiskCache::Impl {
+ public:
+  Impl(const std::string& directory, const DiskCacheOptions& options)
+      : directory_(directory), options_(options) {
+    if (options_.read_only) {
+      files_ = Open();
+      return;
+    }
+
+    std::error_code error;
+    fs::create_directories(directory_, error);
+    std::string lock_path = Path("lock");
+    lock_fd_ = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd_ < 0) {
+      ThrowErrno("cannot open", lock_path);
+    }
+    FileLock lock(lock_fd_);
+    files_ = Open();
+    if (!files_) {
+      Create();
+      files_ = Open();
+      if (!files_) {
+        ThrowErrno("cannot open", Path("index"));
+      }
+    }
+  }
+
+  ~Impl() {
+    files_.reset();
+    if (lock_fd_ >= 0) {
+      close(lock_fd_);
+    }
+  }
+
+  std::optional<std::string> Get(std::string_view key) {
+    std::shared_ptr<Files> files = Current();
+    if (!files) {
+      return std::nullopt;
+    }
+
+    uint64_t hash = KeyHash(key);
+    for (uint64_t i = 0; i <= files->mask; ++i) {
+      Slot& slot = files->slots[(hash + i) & files->mask];
+      uint64_t slot_hash = Atomic(slot.hash).load(std::memory_order_acquire);
+      if (slot_hash == 0) {
+        return std::nullopt;
+      }
+      if (slot_hash == hash) {
+        uint64_t offset = Atomic(slot.offset).load(std::memory_order_acquire);
+        return ReadValue(*files, offset, key);
+      }
+    }
+    return std::nullopt;
+  }
+
+  void Put(std::string_view key, std::string_view value) {
+    if (options_.read_only) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    FileLock lock(lock_fd_);
+    std::shared_ptr<Files> files = Refresh();
+    IndexHeader& header = *files->header;
+
+    uint64_t count = Atomic(header.count).load(std::memory_order_relaxed);
+    if ((count + 1) * 10 > header.capacity * 7) {
+      files = Rebuild(*files, header.capacity * 2, false);
+    }
+
+    RecordHeader record{};
+    record.magic = kRecordMagic;
+    record.key_size = static_cast<uint32_t>(key.size());
+    record.value_size = static_cast<uint32_t>(value.size());
+    record.checksum = Checksum(key, value);
+    if (options_.ttl.count() > 0) {
+      record.expires_ms =
+          NowMs() +
+          std::chrono::duration_cast<std::chrono::milliseconds>(options_.ttl)
+              .count();
+    }
+
+    std::string bytes;
+    bytes.reserve(RecordSize(record));
+    bytes.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    bytes.append(key);
+    bytes.append(value);
+
+    // Сначала запись в журнал, потом слот: читатель, увидевший слот,
+    // найдет запись целиком
+    uint64_t offset = FileSize(files->log_fd);
+    if (!WriteAt(files->log_fd, bytes.data(), bytes.size(), offset)) {
+      ThrowErrno("cannot append to", LogPath(files->header->generation));
+    }
+    Insert(*files, KeyHash(key), offset, bytes.size());
+
+    uint64_t log_bytes = offset + bytes.size();
+    uint64_t live =
+        Atomic(files->header->live_bytes).load(std::memory_order_relaxed);
+    if (options_.auto_compact_bytes > 0 &&
+        log_bytes > options_.auto_compact_bytes && log_bytes > 2 * live) {
+      Rebuild(*files, files->header->capacity, true);
+    }
+  }
+
+  void Compact() {
+    if (options_.read_only) {
+      return;
+    }
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    FileLock lock(lock_fd_);
+    std::shared_ptr<Files> files = Refresh();
+    Rebuild(*files, files->header->capacity, true);
+  }
+
+  DiskCacheStats Stats() {
+    DiskCacheStats stats;
+    std::shared_ptr<Files> files = Current();
+    if (files) {
+      IndexHeader& header = *files->header;
+      stats.entries = Atomic(header.count).load(std::memory_order_relaxed);
+      stats.live_bytes =
+          Atomic(header.live_bytes).load(std::memory_order_relaxed);
+      stats.log_bytes = FileSize(files->log_fd);
+      stats.generation = header.generation;
+    }
+    return stats;
+  }
+
+ private:
+  std::string directory_;
+  DiskCacheOptions options_;
+  int lock_fd_ = -1;
+
+  std::mutex files_mutex_;
+  std::shared_ptr<Files> files_;
+  std::mutex write_mutex_;  // Писатели этого процесса, flock - между ними
+
+  std::string Path(const std::string& name) const {
+    return (fs::path(directory_) / name).string();
+  }
+  std::string LogPath(uint64_t generation) const {
+    return Path("data." + std::to_string(generation) + ".log");
+  }
+
+  // Текущий снимок файлов, переоткрывается, если другой писатель их
+  // заменил
+  std::shared_ptr<Files> Current() {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    if (!files_ || files_->retired()) {
+      if (auto files = Open()) {
+        files_ = std::move(files);
+      }
+    }
+    return files_;
+  }
+
+  // То же под блокировкой писателя, когда файлы гарантированно есть
+  std::shared_ptr<Files> Refresh() {
+    std::shared_ptr<Files> files = Current();
+    if (!files) {
+      ThrowErrno("cannot open", Path("index"));
+    }
+    return files;
+  }
+
+  std::shared_ptr<Files> Open() const {
+    // Сжатие в другом процессе может удалить журнал между открытием
+    // index и журнала, тогда index уже заменен и открывается заново
+    for (int attempt = 0; attempt < 3; ++attempt) {
+      auto files = std::make_shared<Files>();
+      int flags = options_.read_only ? O_RDONLY : O_RDWR;
+      files->index_fd = open(Path("index").c_str(), flags | O_CLOEXEC);
+      if (files->index_fd < 0) {
+        return nullptr;
+      }
+
+      uint64_t size = FileSize(files->index_fd);
+      if (size < sizeof(IndexHeader)) {
+        return nullptr;
+      }
+      int protection = PROT_READ | (options_.read_only ? 0 : PROT_WRITE);
+      files->map_size = static_cast<size_t>(size);
+      files->map = mmap(nullptr, files->map_size, protection, MAP_SHARED,
+                        files->index_fd, 0);
+      if (files->map == MAP_FAILED) {
+        return nullptr;
+      }
+
+      files->header = static_cast<IndexHeader*>(files->map);
+      const IndexHeader& header = *files->header;
+      if (header.magic != kIndexMagic || header.version != kIndexVersion ||
+          header.capacity == 0 ||
+          (header.capacity & (header.capacity - 1)) != 0 ||
+          size < sizeof(IndexHeader) + header.capacity * sizeof(Slot)) {
+        throw AgentCppException("Disk cache: corrupted index in " +
+                                directory_);
+      }
+      files->slots = reinterpret_cast<Slot*>(files->header + 1);
+      files->mask = header.capacity - 1;
+
+      files->log_fd =
+          open(LogPath(header.generation).c_str(), flags | O_CLOEXEC);
+      if (files->log_fd >= 0) {
+        return files;
+      }
+    }
+    return nullptr;
+  }
+
+  // Пустой кэш: пустой журнал и index. Вызывается под блокировкой
+  void Create() {
+    std::string log_path = LogPath(1);
+    int log_fd =
+        open(log_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (log_fd < 0) {
+      ThrowErrno("cannot create", log_path);
+    }
+    close(log_fd);
+    WriteIndex(1, kInitialSlots, {});
+  }
+
+  struct IndexEntry {
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // Записать новый index во временный файл и подменить им текущий
+  void WriteIndex(uint64_t generation, uint64_t capacity,
+                  const std::vector<IndexEntry>& entries) {
+    std::string temp_path = Path("index.tmp");
+    int fd =
+        open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      ThrowErrno("cannot create", temp_path);
+    }
+
+    std::vector<Slot> slots(capacity, Slot{0, 0});
+    uint64_t live_bytes = 0;
+    for (const auto& entry : entries) {
+      uint64_t i = entry.hash & (capacity - 1);
+      while (slots[i].hash != 0) {
+        i = (i + 1) & (capacity - 1);
+      }
+      slots[i] = {entry.hash, entry.offset};
+      live_bytes += entry.size;
+    }
+
+    IndexHeader header{};
+    header.magic = kIndexMagic;
+    header.version = kIndexVersion;
+    header.generation = generation;
+    header.capacity = capacity;
+    header.count = entries.size();
+    header.live_bytes = live_bytes;
+
+    bool written =
+        WriteAt(fd, &header, sizeof(header), 0) &&
+        WriteAt(fd, slots.data(), slots.size() * sizeof(Slot), sizeof(header));
+    close(fd);
+    if (!written) {
+      ThrowErrno("cannot write", temp_path);
+    }
+    if (rename(temp_path.c_str(), Path("index").c_str()) != 0) {
+      ThrowErrno("cannot replace", Path("index"));
+    }
+  }
+
+  // Новый index на capacity слотов. При compact живые записи переносятся
+  // в журнал следующего поколения, замененные и истекшие отбрасываются.
+  // Вызывается под блокировкой писателя
+  std::shared_ptr<Files> Rebuild(Files& old, uint64_t capacity,
+                                 bool compact) {
+    uint64_t generation = old.header->generation + (compact ? 1 : 0);
+    std::string log_path = LogPath(generation);
+    int log_fd = -1;
+    if (compact) {
+      log_fd = open(log_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    0644);
+      if (log_fd < 0) {
+        ThrowErrno("cannot create", log_path);
+      }
+    }
+
+    std::vector<IndexEntry> entries;
+    std::vector<char> buffer;
+    uint64_t log_end = 0;
+    int64_t now = NowMs();
+    for (uint64_t i = 0; i <= old.mask; ++i) {
+      const Slot& slot = old.slots[i];
+      if (slot.hash == 0) {
+        continue;
+      }
+      RecordHeader record;
+      if (!ReadAt(old.log_fd, &record, sizeof(record), slot.offset) ||
+          record.magic != kRecordMagic) {
+        continue;
+      }
+      uint64_t size = RecordSize(record);
+      if (!compact) {
+        entries.push_back({slot.hash, slot.offset, size});
+        continue;
+      }
+      if (record.expires_ms != 0 && record.expires_ms <= now) {
+        continue;
+      }
+      buffer.resize(static_cast<size_t>(size));
+      if (!ReadAt(old.log_fd, buffer.data(), buffer.size(), slot.offset)) {
+        continue;
+      }
+      if (!WriteAt(log_fd, buffer.data(), buffer.size(), log_end)) {
+        close(log_fd);
+        ThrowErrno("cannot write", log_path);
+      }
+      entries.push_back({slot.hash, log_end, size});
+      log_end += size;
+      if (buffer.capacity() > kCopyBuffer) {
+        std::vector<char>().swap(buffer);
+      }
+    }
+    if (log_fd >= 0) {
+      close(log_fd);
+    }
+
+    WriteIndex(generation, capacity, entries);
+    Atomic(old.header->retired).store(1, std::memory_order_release);
+    if (compact) {
+      // Читатели с открытым старым журналом дочитают его, файл удалится
+      // после закрытия последнего дескриптора
+      unlink(LogPath(old.header->generation).c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    files_ = Open();
+    if (!files_) {
+      ThrowErrno("cannot open", Path("index"));
+    }
+    return files_;
+  }
+
+  void Insert(Files& files, uint64_t hash, uint64_t offset, uint64_t size) {
+    IndexHeader& header = *files.header;
+    for (uint64_t i = 0; i <= files.mask; ++i) {
+      Slot& slot = files.slots[(hash + i) & files.mask];
+      uint64_t slot_hash = Atomic(slot.hash).load(std::memory_order_relaxed);
+      if (slot_hash == hash) {
+        // Тот же ключ или коллизия хеша: новая запись замещает старую,
+        // старая становится мертвой
+        uint64_t old_offset =
+            Atomic(slot.offset).load(std::memory_order_relaxed);
+        RecordHeader old;
+        if (ReadAt(files.log_fd, &old, sizeof(old), old_offset)) {
+          Atomic(header.live_bytes)
+              .fetch_sub(RecordSize(old), std::memory_order_relaxed);
+        }
+        Atomic(slot.offset).store(offset, std::memory_order_release);
+        break;
+      }
+      if (slot_hash == 0) {
+        Atomic(slot.offset).store(offset, std::memory_order_relaxed);
+        Atomic(slot.hash).store(hash, std::memory_order_release);
+        Atomic(header.count).fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+    }
+    Atomic(header.live_bytes).fetch_add(size, std::memory_order_relaxed);
+  }
+
+  std::optional<std::string> ReadValue(const Files& files, uint64_t offset,
+                                       std::string_view key) const {
+    RecordHeader record;
+    if (!ReadAt(files.log_fd, &record, sizeof(record), offset) ||
+        record.magic != kRecordMagic || record.key_size != key.size()) {
+      return std::nullopt;
+    }
+    if (record.expires_ms != 0 && record.expires_ms <= NowMs()) {
+      return std::nullopt;
+    }
+
+    std::string data(record.key_size + size_t{record.value_size}, '\0');
+    if (!ReadAt(files.log_fd, data.data(), data.size(),
+                offset + sizeof(record))) {
+      return std::nullopt;
+    }
+    std::string_view stored_key(data.data(), record.key_size);
+    std::string_view value(data.data() + record.key_size, record.value_size);
+    if (stored_key != key || Checksum(stored_key, value) != record.checksum) {
+      return std::nullopt;
+    }
+    data.erase(0, record.key_size);
+    return data;
+  }
+};
+
+DiskCache::DiskCache(const std::string& directory, DiskCacheOptions options)
+    : directory_(directory),
+      pimpl_(std::make_unique<Impl>(directory, options)) {}
+
+DiskCache::~DiskCache() = default;
+
+std::optional<std::string> DiskCache::Get(std::string_view key) {
+  return pimpl_->Get(key);
+}
+
+void DiskCache::Put(std::string_view key, std::string_view value) {
+  pimpl_->Put(key, value);
+}
+
+void DiskCache::Compact() { pimpl_->Compact(); }
+
+DiskCacheStats DiskCache::stats() { return pimpl_->Stats(); }
+
+}  // namespace agentixx
@@ -0,0 +1,369 @@
+#include "agentixx/llm/jsonl_runner.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "agentixx/core/json_writer.hpp"
+
+namespace agentixx {
+
+namespace {
+
+constexpr size_t kReadSize = 1 << 20;
+
+// Чтение строк файла кусками по kReadSize. Строка действительна до
+// следующего вызова Next
+class LineReader {
+ public:
+  LineReader(std::ifstream& in, uint64_t offset)
+      : in_(in), buffer_(kReadSize), offset_(offset) {}
+
+  bool Next(std::string_view* line) {
+    while (true) {
+      const char* start = buffer_.data() + begin_;
+      const void* newline = std::memchr(start, '\n', end_ - begin_);
+      if (newline) {
+        size_t length = static_cast<const char*>(newline) - start;
+        Take(line, length, length + 1);
+        return true;
+      }
+      if (eof_) {
+        if (begin_ == end_) {
+          return false;
+        }
+        Take(line, end_ - begin_, end_ - begin_);
+        return true;
+      }
+      Fill();
+    }
+  }
+
+  // Смещение во входе сразу за последней отданной строкой
+  uint64_t offset() const { return offset_; }
+
+ private:
+  std::ifstream& in_;
+  std::vector<char> buffer_;
+  size_t begin_ = 0;
+  size_t end_ = 0;
+  uint64_t offset_;
+  bool eof_ = false;
+
+  void Take(std::string_view* line, size_t length, size_t consumed) {
+    *line = std::string_view(buffer_.data() + begin_, length);
+    if (!line->empty() && line->back() == '\r') {
+      line->remove_suffix(1);
+    }
+    begin_ += consumed;
+    offset_ += consumed;
+  }
+
+  void Fill() {
+    // Незавершенная строка переносится в начало буфера. Строка длиннее
+    // буфера увеличивает его
+    if (begin_ > 0) {
+      std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+      end_ -= begin_;
+      begin_ = 0;
+    }
+    if (buffer_.size() - end_ < kReadSize / 2) {
+      buffer_.resize(buffer_.size() * 2);
+    }
+    in_.read(buffer_.data() + end_, buffer_.size() - end_);
+    end_ += static_cast<size_t>(in_.gcount());
+    if (in_.eof()) {
+      eof_ = true;
+    } else if (in_.fail()) {
+      throw AgentCppException("Failed to read JSONL input");
+    }
+  }
+};
+
+struct Checkpoint {
+  uint64_t input_offset = 0;
+  uint64_t output_size = 0;
+  uint64_t lines = 0;
+  uint64_t succeeded = 0;
+  uint64_t failed = 0;
+};
+
+bool ReadCheckpoint(const std::string& path, Checkpoint* checkpoint) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  in >> checkpoint->input_offset >> checkpoint->output_size >>
+      checkpoint->lines >> checkpoint->succeeded >> checkpoint->failed;
+  if (!in) {
+    throw AgentCppException("Malformed checkpoint file: " + path);
+  }
+  return true;
+}
+
+// Запись через временный файл и rename, чтобы сбой не оставил
+// наполовину записанный checkpoint
+void WriteCheckpoint(const std::string& path, const Checkpoint& checkpoint) {
+  std::string temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::trunc);
+    out << checkpoint.input_offset << ' ' << checkpoint.output_size << ' '
+        << checkpoint.lines << ' ' << checkpoint.succeeded << ' '
+        << checkpoint.failed << '\n';
+    out.flush();
+    if (!out) {
+      throw AgentCppException("Failed to write checkpoint: " + temp_path);
+    }
+  }
+  std::filesystem::rename(temp_path, path);
+}
+
+// Строка входа окна
+struct Item {
+  uint64_t line = 0;
+  std::string id;     // JSON значение id, пустое - номер строки
+  std::string error;  // Ошибка разбора строки, запрос не отправлялся
+  size_t request = std::numeric_limits<size_t>::max();
+};
+
+// Разобрать строку входа в сообщения запроса
+void ParseLine(std::string_view line, Item* item,
+               std::vector<Message>* messages) {
+  Json json;
+  try {
+    json = Json::parse(line);
+  } catch (const nlohmann::json::parse_error& e) {
+    item->error = "Invalid JSON: " + std::string(e.what());
+    return;
+  }
+  if (!json.is_object()) {
+    item->error = "Line is not a JSON object";
+    return;
+  }
+
+  for (const char* key : {"id", "custom_id"}) {
+    auto id = json.find(key);
+    if (id != json.end()) {
+      item->id = id->dump();
+      break;
+    }
+  }
+
+  const Json* list = nullptr;
+  if (json.contains("messages")) {
+    list = &json["messages"];
+  } else if (json.contains("body") && json["body"].is_object() &&
+             json["body"].contains("messages")) {
+    list = &json["body"]["messages"];
+  }
+  if (!list || !list->is_array()) {
+    item->error = "Missing \"messages\" array";
+    return;
+  }
+
+  try {
+    for (const auto& message : *list) {
+      messages->emplace_back(message.at("role").get<std::string>(),
+                             message.at("content").get<std::string>());
+    }
+  } catch (const nlohmann::json::exception& e) {
+    messages->clear();
+    item->error = "Invalid message: " + std::string(e.what());
+  }
+}
+
+std::string ErrorMessage(const std::exception_ptr& error) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::exception& e) {
+    return e.what();
+  } catch (...) {
+    return "Unknown error";
+  }
+}
+
+}  // namespace
+
+JsonlRunner::JsonlRunner(LLMInterface& llm, JsonlRunOptions options)
+    : llm_(llm), options_(std::move(options)) {
+  if (options_.max_in_flight == 0) {
+    options_.max_in_flight = 1;
+  }
+  if (options_.window == 0) {
+    options_.window = options_.max_in_flight * 8;
+  }
+}
+
+JsonlProgress JsonlRunner::Run(const std::string& input_path,
+                               const std::string& output_path) {
+  namespace fs = std::filesystem;
+  using Clock = std::chrono::steady_clock;
+
+  Checkpoint checkpoint;
+  bool resumed = !options_.checkpoint_path.empty() &&
+                 ReadCheckpoint(options_.checkpoint_path, &checkpoint);
+
+  std::ifstream in(input_path, std::ios::binary);
+  if (!in) {
+    throw AgentCppException("Cannot open JSONL input: " + input_path);
+  }
+  uint64_t input_size = fs::file_size(input_path);
+  if (checkpoint.input_offset > input_size) {
+    throw AgentCppException("Checkpoint is past the end of " + input_path);
+  }
+  in.seekg(static_cast<std::streamoff>(checkpoint.input_offset));
+
+  // Результаты после checkpoint не подтверждены и будут получены заново
+  std::error_code error;
+  uint64_t output_size = fs::file_size(output_path, error);
+  if (error) {
+    output_size = 0;
+  }
+  if (resumed) {
+    if (output_size < checkpoint.output_size) {
+      throw AgentCppException("JSONL output is shorter than its checkpoint: " +
+                              output_path);
+    }
+    if (output_size > checkpoint.output_size) {
+      fs::resize_file(output_path, checkpoint.output_size);
+    }
+    output_size = checkpoint.output_size;
+  }
+  std::ofstream out(output_path, std::ios::binary | std::ios::app);
+  if (!out) {
+    throw AgentCppException("Cannot open JSONL output: " + output_path);
+  }
+
+  JsonlProgress progress;
+  progress.lines = checkpoint.lines;
+  progress.succeeded = checkpoint.succeeded;
+  progress.failed = checkpoint.failed;
+  progress.input_offset = checkpoint.input_offset;
+  progress.input_size = input_size;
+
+  const uint64_t start_lines = progress.lines;
+  const uint64_t start_offset = progress.input_offset;
+  const auto start = Clock::now();
+  auto last_report = start;
+  auto report = [&](bool force) {
+    auto now = Clock::now();
+    if (!force && (!options_.on_progress ||
+                   now - last_report < std::chrono::milliseconds(
+                                           options_.progress_interval_ms))) {
+      return;
+    }
+    last_report = now;
+    progress.elapsed_seconds =
+        std::chrono::duration<double>(now - start).count();
+    if (progress.elapsed_seconds > 0) {
+      progress.lines_per_second =
+          (progress.lines - start_lines) / progress.elapsed_seconds;
+      progress.bytes_per_second =
+          (progress.input_offset - start_offset) / progress.elapsed_seconds;
+    }
+    if (options_.on_progress) {
+      options_.on_progress(progress);
+    }
+  };
+
+  BatchOptions batch_options;
+  batch_options.max_in_flight = options_.max_in_flight;
+  batch_options.temperature = options_.temperature;
+  batch_options.max_tokens = options_.max_tokens;
+  batch_options.on_result = [&](const BatchResult& result) {
+    ++(result.ok() ? progress.succeeded : progress.failed);
+    ++progress.lines;
+    report(false);
+  };
+
+  LineReader reader(in, checkpoint.input_offset);
+  std::vector<Item> items;
+  std::vector<std::vector<Message>> requests;
+  std::string buffer;
+  std::string_view line;
+  bool more = true;
+
+  while (more) {
+    items.clear();
+    requests.clear();
+    while (items.size() < options_.window && (more = reader.Next(&line))) {
+      if (line.find_first_not_of(" \t") == std::string_view::npos) {
+        continue;
+      }
+      Item& item = items.emplace_back();
+      item.line = progress.lines + items.size();
+      std::vector<Message> messages;
+      ParseLine(line, &item, &messages);
+      if (item.error.empty()) {
+        item.request = requests.size();
+        requests.push_back(std::move(messages));
+      }
+    }
+    if (items.empty()) {
+      break;
+    }
+
+    // Строки с ошибкой формата учитываются сразу, без запроса
+    for (const auto& item : items) {
+      if (!item.error.empty()) {
+        ++progress.failed;
+        ++progress.lines;
+      }
+    }
+    std::vector<BatchResult> results = llm_.ChatBatch(requests, batch_options);
+
+    buffer.clear();
+    for (const auto& item : items) {
+      JsonWriter writer(&buffer);
+      writer.BeginObject().Key("id");
+      if (item.id.empty()) {
+        writer.Int(static_cast<int64_t>(item.line));
+      } else {
+        writer.Raw(item.id);
+      }
+      writer.Key("line").Int(static_cast<int64_t>(item.line));
+
+      if (!item.error.empty()) {
+        writer.Key("error").String(item.error);
+      } else if (!results[item.request].ok()) {
+        writer.Key("error").String(ErrorMessage(results[item.request].error));
+      } else {
+        const Response& response = results[item.request].response;
+        writer.Key("content").String(response.text());
+        writer.Key("response").Raw(response.raw().dump());
+      }
+      writer.EndObject();
+      buffer.push_back('\n');
+    }
+
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+    if (!out) {
+      throw AgentCppException("Failed to write JSONL output: " + output_path);
+    }
+    output_size += buffer.size();
+    progress.input_offset = reader.offset();
+
+    if (!options_.checkpoint_path.empty()) {
+      checkpoint.input_offset = progress.input_offset;
+      checkpoint.output_size = output_size;
+      checkpoint.lines = progress.lines;
+      checkpoint.succeeded = progress.succeeded;
+      checkpoint.failed = progress.failed;
+      WriteCheckpoint(options_.checkpoint_path, checkpoint);
+    }
+    report(false);
+  }
+
+  progress.input_offset = reader.offset();
+  report(true);
+  return progress;
+}
+
+}  // namespace agentixx
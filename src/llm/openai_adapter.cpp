@@ -1,10 +1,47 @@
 #include "agentixx/llm/openai_adapter.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <sstream>
 
+#include "agentixx/core/metrics.hpp"
+#include "agentixx/core/tracing.hpp"
+
 namespace agentixx {
 
+namespace {
+
+// Тело chat запроса. write_messages пишет значение поля "messages",
+// messages_size - ожидаемый размер этого значения
+template <typename WriteMessages>
+std::string WriteChatBody(const std::string& model, size_t messages_size,
+                          WriteMessages&& write_messages,
+                          const double* temperature, int max_tokens,
+                          bool stream) {
+  std::string body;
+  body.reserve(messages_size + model.size() + 96);
+
+  JsonWriter writer(&body);
+  writer.BeginObject().Key("model").String(model).Key("messages");
+  write_messages(writer);
+  if (temperature) {
+    writer.Key("temperature").Double(*temperature);
+  }
+  if (max_tokens > 0) {
+    writer.Key("max_tokens").Int(max_tokens);
+  }
+  if (stream) {
+    writer.Key("stream").Bool(true);
+  }
+  writer.EndObject();
+
+  return body;
+}
+
+}  // namespace
+
 OpenAIAdapter::OpenAIAdapter(const Config& config, const std::string& model)
     : config_(config), model_(model) {
   if (config_.api_key.empty()) {
@@ -13,6 +50,19 @@ OpenAIAdapter::OpenAIAdapter(const Config& config, const std::string& model)
 
   // Создаем HTTP клиент
   http_client_ = std::make_unique<HttpClient>(config_);
+  BindMetrics();
+}
+
+void OpenAIAdapter::SetModel(const std::string& model) {
+  model_ = model;
+  BindMetrics();
+}
+
+void OpenAIAdapter::BindMetrics() {
+  if (config_.metrics) {
+    metrics_ = config_.metrics->Endpoint(model_, config_.base_url);
+    http_client_->SetMetrics(metrics_);
+  }
 }
 
 Headers OpenAIAdapter::BuildHeaders() const {
@@ -33,36 +83,68 @@ Headers OpenAIAdapter::BuildHeaders() const {
 
 std::string OpenAIAdapter::BuildCompletionRequest(const std::string& prompt,
                                                   bool stream) const {
-  Json request = {{"model", model_},
-                  {"prompt", prompt},
-                  {"max_tokens", 150},
-                  {"temperature", 0.7}};
-
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.build_request");
+  std::string body;
+  body.reserve(prompt.size() + model_.size() + 96);
+
+  JsonWriter writer(&body);
+  writer.BeginObject()
+      .Key("model")
+      .String(model_)
+      .Key("prompt")
+      .String(prompt)
+      .Key("max_tokens")
+      .Int(150)
+      .Key("temperature")
+      .Double(0.7);
   if (stream) {
-    request["stream"] = true;
+    writer.Key("stream").Bool(true);
   }
+  writer.EndObject();
 
-  return request.dump();
+  return body;
 }
 
 std::string OpenAIAdapter::BuildChatRequest(
     const std::vector<Message>& messages, bool stream) const {
-  Json request = {{"model", model_}, {"messages", Json::array()}};
+  return BuildChatBody(messages, nullptr, -1, stream);
+}
 
-  // Конвертируем сообщения в JSON
+std::string OpenAIAdapter::BuildChatBody(const std::vector<Message>& messages,
+                                         const double* temperature,
+                                         int max_tokens, bool stream) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.build_request");
+  // Размер с запасом на экранирование, чтобы буфер не перевыделялся
+  size_t size = 0;
   for (const auto& msg : messages) {
-    request["messages"].push_back(msg.ToJson());
-  }
-
-  if (stream) {
-    request["stream"] = true;
+    size += msg.role.size() + msg.content.size() + 32;
   }
+  return WriteChatBody(
+      model_, size + size / 8,
+      [&](JsonWriter& writer) {
+        writer.BeginArray();
+        for (const auto& msg : messages) {
+          msg.WriteJson(writer);
+        }
+        writer.EndArray();
+      },
+      temperature, max_tokens, stream);
+}
 
-  return request.dump();
+std::string OpenAIAdapter::BuildChatBody(const Conversation& conversation,
+                                         const double* temperature,
+                                         int max_tokens, bool stream) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.build_request");
+  std::string_view messages = conversation.messages_json();
+  return WriteChatBody(
+      model_, messages.size(),
+      [&](JsonWriter& writer) { writer.Raw(messages); }, temperature,
+      max_tokens, stream);
 }
 
 Response OpenAIAdapter::ParseOpenaiResponse(
     const HttpResponse& http_response) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.parse_response");
   if (!http_response.IsSuccess()) {
     try {
       Json error_json = Json::parse(http_response.body);
@@ -81,8 +163,15 @@ Response OpenAIAdapter::ParseOpenaiResponse(
   }
 
   try {
-    Json response_json = Json::parse(http_response.body);
-    return Response(response_json);
+    Response response(Json::parse(http_response.body));
+    response.SetMetrics(http_response.metrics);
+    // Токены потоков считает HttpClient по usage последнего chunk
+    auto usage = response.raw().find("usage");
+    if (metrics_ && usage != response.raw().end() && usage->is_object()) {
+      metrics_->prompt_tokens.Add(usage->value("prompt_tokens", 0L));
+      metrics_->completion_tokens.Add(usage->value("completion_tokens", 0L));
+    }
+    return response;
   } catch (const nlohmann::json::parse_error& e) {
     throw ParseError("Failed to parse OpenAI response: " +
                      std::string(e.what()));
@@ -90,6 +179,7 @@ Response OpenAIAdapter::ParseOpenaiResponse(
 }
 
 Response OpenAIAdapter::Complete(const std::string& prompt) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.complete");
   std::string url = config_.base_url + "/completions";
   std::string body = BuildCompletionRequest(prompt, false);
   Headers headers = BuildHeaders();
@@ -99,6 +189,7 @@ Response OpenAIAdapter::Complete(const std::string& prompt) {
 }
 
 Response OpenAIAdapter::Chat(const std::vector<Message>& messages) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat");
   std::string url = config_.base_url + "/chat/completions";
   std::string body = BuildChatRequest(messages, false);
   Headers headers = BuildHeaders();
@@ -107,24 +198,36 @@ Response OpenAIAdapter::Chat(const std::vector<Message>& messages) {
   return ParseOpenaiResponse(http_response);
 }
 
+Response OpenAIAdapter::Chat(const Conversation& conversation) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat");
+  std::string url = config_.base_url + "/chat/completions";
+  std::string body = BuildChatBody(conversation, nullptr, -1, false);
+  Headers headers = BuildHeaders();
+
+  HttpResponse http_response = http_client_->post(url, body, headers);
+  return ParseOpenaiResponse(http_response);
+}
+
 Response OpenAIAdapter::ChatWithOptions(const std::vector<Message>& messages,
                                         double temperature,
                                         int max_tokens) const {
-  Json request = {{"model", model_},
-                  {"messages", Json::array()},
-                  {"temperature", temperature}};
-
-  if (max_tokens > 0) {
-    request["max_tokens"] = max_tokens;
-  }
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat");
+  std::string url = config_.base_url + "/chat/completions";
+  std::string body =
+      BuildChatRequestWithOptions(messages, temperature, max_tokens, false);
+  Headers headers = BuildHeaders();
 
-  // Конвертируем сообщения в JSON
-  for (const auto& msg : messages) {
-    request["messages"].push_back(msg.ToJson());
-  }
+  HttpResponse http_response = http_client_->post(url, body, headers);
+  return ParseOpenaiResponse(http_response);
+}
 
+Response OpenAIAdapter::ChatWithOptions(const Conversation& conversation,
+                                        double temperature,
+                                        int max_tokens) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat");
   std::string url = config_.base_url + "/chat/completions";
-  std::string body = request.dump();
+  std::string body =
+      BuildChatBody(conversation, &temperature, max_tokens, false);
   Headers headers = BuildHeaders();
 
   HttpResponse http_response = http_client_->post(url, body, headers);
@@ -134,27 +237,11 @@ Response OpenAIAdapter::ChatWithOptions(const std::vector<Message>& messages,
 std::string OpenAIAdapter::BuildChatRequestWithOptions(
     const std::vector<Message>& messages, double temperature, int max_tokens,
     bool stream) const {
-  Json request = {{"model", model_},
-                  {"messages", Json::array()},
-                  {"temperature", temperature}};
-
-  if (max_tokens > 0) {
-    request["max_tokens"] = max_tokens;
-  }
-
-  if (stream) {
-    request["stream"] = true;
-  }
-
-  // Конвертируем сообщения в JSON
-  for (const auto& msg : messages) {
-    request["messages"].push_back(msg.ToJson());
-  }
-
-  return request.dump();
+  return BuildChatBody(messages, &temperature, max_tokens, stream);
 }
 
 StreamingResponse OpenAIAdapter::CompleteStream(const std::string& prompt) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.complete_stream");
   std::string url = config_.base_url + "/completions";
   std::string body = BuildCompletionRequest(prompt, true);
   Headers headers = BuildHeaders();
@@ -164,6 +251,7 @@ StreamingResponse OpenAIAdapter::CompleteStream(const std::string& prompt) {
 
 StreamingResponse OpenAIAdapter::ChatStream(
     const std::vector<Message>& messages) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat_stream");
   std::string url = config_.base_url + "/chat/completions";
   std::string body = BuildChatRequest(messages, true);
   Headers headers = BuildHeaders();
@@ -171,9 +259,20 @@ StreamingResponse OpenAIAdapter::ChatStream(
   return http_client_->PostStream(url, body, headers);
 }
 
+StreamingResponse OpenAIAdapter::ChatStream(
+    const Conversation& conversation) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat_stream");
+  std::string url = config_.base_url + "/chat/completions";
+  std::string body = BuildChatBody(conversation, nullptr, -1, true);
+  Headers headers = BuildHeaders();
+
+  return http_client_->PostStream(url, body, headers);
+}
+
 StreamingResponse OpenAIAdapter::ChatStreamWithOptions(
     const std::vector<Message>& messages, double temperature,
     int max_tokens) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat_stream");
   std::string url = config_.base_url + "/chat/completions";
   std::string body =
       BuildChatRequestWithOptions(messages, temperature, max_tokens, true);
@@ -182,16 +281,121 @@ StreamingResponse OpenAIAdapter::ChatStreamWithOptions(
   return http_client_->PostStream(url, body, headers);
 }
 
+StreamingResponse OpenAIAdapter::ChatStreamWithOptions(
+    const Conversation& conversation, double temperature,
+    int max_tokens) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat_stream");
+  std::string url = config_.base_url + "/chat/completions";
+  std::string body =
+      BuildChatBody(conversation, &temperature, max_tokens, true);
+  Headers headers = BuildHeaders();
+
+  return http_client_->PostStream(url, body, headers);
+}
+
+std::vector<BatchResult> OpenAIAdapter::ChatBatch(
+    const std::vector<std::vector<Message>>& batch,
+    const BatchOptions& options) {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat_batch");
+  // Завершенные запросы из I/O потока. Состояние разделяемое: если
+  // on_result бросит исключение, оставшиеся в полете запросы допишут сюда
+  struct Completions {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<size_t, HttpResponse>> responses;
+    std::deque<std::pair<size_t, std::exception_ptr>> errors;
+  };
+  auto completions = std::make_shared<Completions>();
+
+  std::string url = config_.base_url + "/chat/completions";
+  Headers headers = BuildHeaders();
+  const double* temperature =
+      options.temperature ? &*options.temperature : nullptr;
+  size_t max_in_flight = options.max_in_flight > 0 ? options.max_in_flight : 1;
+
+  std::vector<BatchResult> results(batch.size());
+  size_t next = 0;
+  size_t in_flight = 0;
+
+  auto finish = [&](BatchResult& result) {
+    --in_flight;
+    if (options.on_result) {
+      options.on_result(result);
+    }
+  };
+
+  while (next < batch.size() || in_flight > 0) {
+    // Тело собирается перед отправкой: в памяти только запросы в полете
+    while (next < batch.size() && in_flight < max_in_flight) {
+      size_t index = next++;
+      results[index].index = index;
+      ++in_flight;
+      try {
+        http_client_->PostAsync(
+            url, BuildChatBody(batch[index], temperature, options.max_tokens,
+                               false),
+            headers,
+            [completions, index](HttpResponse response) {
+              std::lock_guard<std::mutex> lock(completions->mutex);
+              completions->responses.emplace_back(index, std::move(response));
+              completions->cv.notify_one();
+            },
+            [completions, index](std::exception_ptr error) {
+              std::lock_guard<std::mutex> lock(completions->mutex);
+              completions->errors.emplace_back(index, std::move(error));
+              completions->cv.notify_one();
+            });
+      } catch (...) {
+        results[index].error = std::current_exception();
+        finish(results[index]);
+      }
+    }
+    if (in_flight == 0) {
+      continue;
+    }
+
+    std::deque<std::pair<size_t, HttpResponse>> responses;
+    std::deque<std::pair<size_t, std::exception_ptr>> errors;
+    {
+      std::unique_lock<std::mutex> lock(completions->mutex);
+      completions->cv.wait(lock, [&] {
+        return !completions->responses.empty() ||
+               !completions->errors.empty();
+      });
+      responses.swap(completions->responses);
+      errors.swap(completions->errors);
+    }
+
+    for (auto& [index, error] : errors) {
+      results[index].error = std::move(error);
+      finish(results[index]);
+    }
+    for (auto& [index, response] : responses) {
+      try {
+        results[index].response = ParseOpenaiResponse(response);
+      } catch (...) {
+        results[index].error = std::current_exception();
+      }
+      finish(results[index]);
+    }
+  }
+
+  return results;
+}
+
 void OpenAIAdapter::ChatStreamRealtime(const std::vector<Message>& messages,
                                        StreamCallback on_chunk,
                                        std::function<void()> on_complete,
                                        StreamErrorCallback on_error) const {
+  AGENTIXX_TRACE_SPAN(config_.tracer.get(), "openai.chat_stream");
   std::string url = config_.base_url + "/chat/completions";
   std::string body = BuildChatRequest(messages, true);
   Headers headers = BuildHeaders();
 
-  http_client_->PostStreamAsync(url, body, headers, on_chunk, on_complete,
-                                on_error);
+  // Ждем завершения: ChatStreamRealtime остается блокирующим вызовом
+  http_client_
+      ->PostStreamAsync(url, body, headers, on_chunk, on_complete, on_error)
+      .get();
 }
 
 }  // namespace agentixx
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "agentixx/llm/openai_adapter.hpp"
+
+namespace agentixx {
+
+namespace {
+
+// co_await HTTP запроса через EventLoop клиента. Корутина продолжается
+// в I/O потоке, когда запрос завершен
+class HttpAwaiter {
+ public:
+  HttpAwaiter(HttpClient& client, std::string url, std::string body,
+              Headers headers)
+      : client_(client),
+        url_(std::move(url)),
+        body_(std::move(body)),
+        headers_(std::move(headers)) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  // Исключение из PostAsync (цикл остановлен) выбрасывается в корутине
+  void await_suspend(std::coroutine_handle<> awaiting) {
+    client_.PostAsync(
+        url_, body_, headers_,
+        [this, awaiting](HttpResponse response) {
+          response_ = std::move(response);
+          awaiting.resume();
+        },
+        [this, awaiting](std::exception_ptr error) {
+          error_ = std::move(error);
+          awaiting.resume();
+        });
+  }
+
+  HttpResponse await_resume() {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    return std::move(response_);
+  }
+
+ private:
+  HttpClient& client_;
+  std::string url_;
+  std::string body_;
+  Headers headers_;
+  HttpResponse response_;
+  std::exception_ptr error_;
+};
+
+}  // namespace
+
+Task<Response> OpenAIAdapter::PostTask(std::string url,
+                                       std::string body) const {
+  HttpResponse response = co_await HttpAwaiter(
+      *http_client_, std::move(url), std::move(body), BuildHeaders());
+  co_return ParseOpenaiResponse(response);
+}
+
+Task<Response> OpenAIAdapter::CompleteAsync(const std::string& prompt) const {
+  return PostTask(config_.base_url + "/completions",
+                  BuildCompletionRequest(prompt, false));
+}
+
+Task<Response> OpenAIAdapter::ChatAsync(
+    const std::vector<Message>& messages) const {
+  return PostTask(config_.base_url + "/chat/completions",
+                  BuildChatRequest(messages, false));
+}
+
+Task<Response> OpenAIAdapter::ChatAsync(
+    const Conversation& conversation) const {
+  return PostTask(config_.base_url + "/chat/completions",
+                  BuildChatBody(conversation, nullptr, -1, false));
+}
+
+AsyncStream OpenAIAdapter::ChatStreamAsync(
+    const std::vector<Message>& messages) const {
+  return AsyncStream(
+      http_client_->OpenStream(config_.base_url + "/chat/completions",
+                               BuildChatRequest(messages, true),
+                               BuildHeaders()));
+}
+
+AsyncStream OpenAIAdapter::ChatStreamAsync(
+    const Conversation& conversation) const {
+  return AsyncStream(http_client_->OpenStream(
+      config_.base_url + "/chat/completions",
+      BuildChatBody(conversation, nullptr, -1, true), BuildHeaders()));
+}
+
+}  // namespace agentixx
@@ -0,0 +1,46 @@
+#include "request_key.hpp"
+
+#include "../core/hash.hpp"
+#include "agentixx/core/json_writer.hpp"
+
+namespace agentixx {
+
+RequestKey ChatKey(const std::string& model,
+                   const std::vector<Message>& messages, bool stream,
+                   const BatchOptions* options) {
+  RequestKey key;
+  JsonWriter writer(&key.body);
+  writer.BeginObject().Key("model").String(model);
+  writer.Key("messages").BeginArray();
+  for (const auto& message : messages) {
+    message.WriteJson(writer);
+  }
+  writer.EndArray();
+  if (options && options->temperature) {
+    writer.Key("temperature").Double(*options->temperature);
+  }
+  if (options && options->max_tokens > 0) {
+    writer.Key("max_tokens").Int(options->max_tokens);
+  }
+  writer.Key("stream").Bool(stream).EndObject();
+  key.hash = HashBytes(key.body);
+  return key;
+}
+
+RequestKey CompletionKey(const std::string& model, const std::string& prompt,
+                         bool stream) {
+  RequestKey key;
+  JsonWriter writer(&key.body);
+  writer.BeginObject()
+      .Key("model")
+      .String(model)
+      .Key("prompt")
+      .String(prompt)
+      .Key("stream")
+      .Bool(stream)
+      .EndObject();
+  key.hash = HashBytes(key.body);
+  return key;
+}
+
+}  // namespace agentixx
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "agentixx/llm/llm_interface.hpp"
+
+namespace agentixx {
+
+// Канонический запрос для кэша и объединения одинаковых запросов: тот же
+// JSON, что уходит в API, без полей адаптера, и его хеш. Параметры
+// генерации пишутся только когда заданы, поэтому Chat и ChatBatch без
+// параметров дают один ключ
+struct RequestKey {
+  std::string body;
+  uint64_t hash = 0;
+
+  bool operator==(const RequestKey& other) const {
+    return hash == other.hash && body == other.body;
+  }
+};
+
+struct RequestKeyHash {
+  size_t operator()(const RequestKey& key) const {
+    return static_cast<size_t>(key.hash);
+  }
+};
+
+RequestKey ChatKey(const std::string& model,
+                   const std::vector<Message>& messages, bool stream,
+                   const BatchOptions* options = nullptr);
+
+RequestKey CompletionKey(const std::string& model, const std::string& prompt,
+                         bool stream);
+
+}  // namespace agentixx
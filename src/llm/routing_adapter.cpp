@@ -0,0 +1,398 @@
+#include "agentixx/llm/routing_adapter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace agentixx {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Circuit = RoutingBackendStats::Circuit;
+
+// Задержки Complete/Chat и открытия потоков считаются отдельно: поток
+// открывается к первому chunk, намного раньше полного ответа
+enum Kind { kCall = 0, kStream = 1 };
+
+// Чем закончился запрос к backend
+enum class Outcome {
+  kSuccess,   // Ответ получен, задержка идет в EWMA
+  kRejected,  // Backend ответил ошибкой запроса (4xx): он жив
+  kFailure,   // NetworkError, 429 или 5xx
+};
+
+constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+std::mt19937_64& Random() {
+  thread_local std::mt19937_64 engine(std::random_device{}());
+  return engine;
+}
+
+double Millis(Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Ошибка, при которой запрос стоит повторить на другом backend
+bool IsBackendFailure(const std::exception_ptr& error) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const NetworkError&) {
+    return true;
+  } catch (const ApiError& e) {
+    return e.status_code == 429 || e.status_code >= 500;
+  } catch (...) {
+    return false;
+  }
+}
+
+struct Backend {
+  std::string name;
+  LLMInterface* llm = nullptr;
+  std::unique_ptr<LLMInterface> owned;
+  double weight = 1;
+
+  // Дальше - под mutex Impl
+  size_t outstanding = 0;
+  double latency[2] = {0, 0};  // EWMA задержки, мс
+  bool measured[2] = {false, false};
+  Clock::time_point sampled[2];
+  uint64_t requests = 0;
+  uint64_t failures = 0;
+  int failures_in_row = 0;
+  Circuit circuit = Circuit::kClosed;
+  Clock::time_point open_until;
+  bool probing = false;  // Пробный запрос полуоткрытого breaker в полете
+};
+
+}  // namespace
+
+class RoutingAdapter::Impl {
+ public:
+  explicit Impl(RoutingOptions options) : options_(options) {
+    options_.decay = std::max(options_.decay, std::chrono::milliseconds(1));
+    options_.failure_threshold = std::max(options_.failure_threshold, 1);
+  }
+
+  void Add(const std::string& name, LLMInterface& llm,
+           std::unique_ptr<LLMInterface> owned, double weight) {
+    Backend backend;
+    backend.name = name;
+    backend.llm = &llm;
+    backend.owned = std::move(owned);
+    backend.weight = weight > 0 ? weight : 1;
+    backends_.push_back(std::move(backend));
+  }
+
+  const std::vector<Backend>& backends() const { return backends_; }
+
+  // Сколько backends пробовать для одного запроса
+  size_t Attempts() const {
+    if (backends_.empty()) {
+      throw std::runtime_error("RoutingAdapter has no backends");
+    }
+    if (options_.max_attempts == 0) {
+      return backends_.size();
+    }
+    return std::min(options_.max_attempts, backends_.size());
+  }
+
+  // Лучший backend из еще не попытанных, count запросов ставятся ему в
+  // полет. Если breakers всех разомкнуты, берется тот, что раньше других
+  // вернется в ротацию
+  size_t Pick(Kind kind, const std::vector<bool>& tried, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    double best = std::numeric_limits<double>::infinity();
+    double ties_weight = 0;
+    size_t chosen = kNone;
+    size_t fallback = kNone;
+
+    for (size_t i = 0; i < backends_.size(); ++i) {
+      if (tried[i]) {
+        continue;
+      }
+      Backend& backend = backends_[i];
+      if (backend.circuit == Circuit::kOpen && now >= backend.open_until) {
+        backend.circuit = Circuit::kHalfOpen;
+      }
+      if (backend.circuit == Circuit::kOpen ||
+          (backend.circuit == Circuit::kHalfOpen && backend.probing)) {
+        if (fallback == kNone ||
+            backend.open_until < backends_[fallback].open_until) {
+          fallback = i;
+        }
+        continue;
+      }
+
+      double score = Score(backend, kind, now);
+      if (score < best) {
+        best = score;
+        ties_weight = backend.weight;
+        chosen = i;
+      } else if (score == best) {
+        // Равные оценки (нет замеров, простой) - случайно по весу
+        ties_weight += backend.weight;
+        std::uniform_real_distribution<double> pick(0, ties_weight);
+        if (pick(Random()) < backend.weight) {
+          chosen = i;
+        }
+      }
+    }
+
+    if (chosen == kNone) {
+      chosen = fallback;
+    }
+    Backend& backend = backends_[chosen];
+    if (backend.circuit == Circuit::kHalfOpen) {
+      backend.probing = true;
+    }
+    backend.outstanding += count;
+    backend.requests += count;
+    return chosen;
+  }
+
+  // Запрос к backend index завершен за latency
+  void Finish(size_t index, Kind kind, size_t count, Clock::duration latency,
+              Outcome outcome) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    Backend& backend = backends_[index];
+    backend.outstanding -= count;
+    backend.probing = false;
+
+    if (outcome == Outcome::kFailure) {
+      ++backend.failures;
+      ++backend.failures_in_row;
+      if (backend.circuit == Circuit::kHalfOpen ||
+          backend.failures_in_row >= options_.failure_threshold) {
+        backend.circuit = Circuit::kOpen;
+        backend.open_until = now + options_.open_duration;
+      }
+      return;
+    }
+
+    backend.failures_in_row = 0;
+    backend.circuit = Circuit::kClosed;
+    if (outcome == Outcome::kSuccess) {
+      Sample(backend, kind, Millis(latency), now);
+    }
+  }
+
+  // Выполнить call на лучшем backend, при отказе - на следующем
+  template <typename Call>
+  auto Route(Kind kind, Call&& call)
+      -> decltype(call(std::declval<LLMInterface&>())) {
+    size_t attempts = Attempts();
+    std::vector<bool> tried(backends_.size());
+    std::exception_ptr error;
+    for (size_t attempt = 0; attempt < attempts; ++attempt) {
+      size_t index = Pick(kind, tried, 1);
+      tried[index] = true;
+      Clock::time_point start = Clock::now();
+      try {
+        auto result = call(*backends_[index].llm);
+        Finish(index, kind, 1, Clock::now() - start, Outcome::kSuccess);
+        return result;
+      } catch (...) {
+        error = std::current_exception();
+        bool failure = IsBackendFailure(error);
+        Finish(index, kind, 1, {},
+               failure ? Outcome::kFailure : Outcome::kRejected);
+        if (!failure) {
+          throw;
+        }
+      }
+    }
+    std::rethrow_exception(error);
+  }
+
+  RoutingBackendStats Stats(const Backend& backend) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    RoutingBackendStats stats;
+    stats.name = backend.name;
+    stats.weight = backend.weight;
+    stats.outstanding = backend.outstanding;
+    stats.latency_ms = Latency(backend, kCall, now);
+    stats.stream_latency_ms = Latency(backend, kStream, now);
+    stats.requests = backend.requests;
+    stats.failures = backend.failures;
+    stats.circuit = backend.circuit;
+    if (stats.circuit == Circuit::kOpen && now >= backend.open_until) {
+      stats.circuit = Circuit::kHalfOpen;
+    }
+    return stats;
+  }
+
+ private:
+  RoutingOptions options_;
+  mutable std::mutex mutex_;
+  std::vector<Backend> backends_;
+
+  // Оценка EWMA на момент now: без новых замеров она затухает, иначе
+  // однажды замедлившийся backend больше не получил бы запросов
+  double Latency(const Backend& backend, Kind kind,
+                 Clock::time_point now) const {
+    if (!backend.measured[kind]) {
+      return 0;
+    }
+    double age = Millis(now - backend.sampled[kind]);
+    return backend.latency[kind] *
+           std::exp(-age / static_cast<double>(options_.decay.count()));
+  }
+
+  // Меньше - лучше
+  double Score(const Backend& backend, Kind kind,
+               Clock::time_point now) const {
+    if (options_.balance == RoutingOptions::Balance::kLeastOutstanding) {
+      return backend.outstanding / backend.weight;
+    }
+    return Latency(backend, kind, now) * (backend.outstanding + 1) /
+           backend.weight;
+  }
+
+  // Peak EWMA: замедление принимается сразу, ускорение - с весом по
+  // времени с прошлого замера
+  void Sample(Backend& backend, Kind kind, double latency_ms,
+              Clock::time_point now) {
+    double& latency = backend.latency[kind];
+    if (!backend.measured[kind] || latency_ms >= latency) {
+      latency = latency_ms;
+    } else {
+      double elapsed = Millis(now - backend.sampled[kind]);
+      double keep =
+          std::exp(-elapsed / static_cast<double>(options_.decay.count()));
+      latency = latency * keep + latency_ms * (1 - keep);
+    }
+    backend.measured[kind] = true;
+    backend.sampled[kind] = now;
+  }
+};
+
+RoutingAdapter::RoutingAdapter(RoutingOptions options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
+RoutingAdapter::~RoutingAdapter() = default;
+
+void RoutingAdapter::AddBackend(const std::string& name, LLMInterface& backend,
+                                double weight) {
+  impl_->Add(name, backend, nullptr, weight);
+}
+
+void RoutingAdapter::AddBackend(const std::string& name,
+                                std::unique_ptr<LLMInterface> backend,
+                                double weight) {
+  LLMInterface& llm = *backend;
+  impl_->Add(name, llm, std::move(backend), weight);
+}
+
+Response RoutingAdapter::Complete(const std::string& prompt) {
+  return impl_->Route(kCall,
+                      [&](LLMInterface& llm) { return llm.Complete(prompt); });
+}
+
+Response RoutingAdapter::Chat(const std::vector<Message>& messages) {
+  return impl_->Route(kCall,
+                      [&](LLMInterface& llm) { return llm.Chat(messages); });
+}
+
+StreamingResponse RoutingAdapter::CompleteStream(const std::string& prompt) {
+  return impl_->Route(kStream, [&](LLMInterface& llm) {
+    return llm.CompleteStream(prompt);
+  });
+}
+
+StreamingResponse RoutingAdapter::ChatStream(
+    const std::vector<Message>& messages) {
+  return impl_->Route(kStream, [&](LLMInterface& llm) {
+    return llm.ChatStream(messages);
+  });
+}
+
+std::vector<BatchResult> RoutingAdapter::ChatBatch(
+    const std::vector<std::vector<Message>>& batch,
+    const BatchOptions& options) {
+  std::vector<BatchResult> results(batch.size());
+  std::vector<size_t> pending(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    results[i].index = i;
+    pending[i] = i;
+  }
+  if (batch.empty()) {
+    return results;
+  }
+
+  size_t attempts = impl_->Attempts();
+  std::vector<bool> tried(impl_->backends().size());
+  for (size_t attempt = 0; attempt < attempts && !pending.empty();
+       ++attempt) {
+    bool last = attempt + 1 == attempts;
+    std::vector<std::vector<Message>> rest;
+    rest.reserve(pending.size());
+    for (size_t index : pending) {
+      rest.push_back(batch[index]);
+    }
+
+    // Отказы, которые уйдут на следующий backend, не отдаются в on_result.
+    // Индексы подпакета переводятся в индексы исходного пакета
+    BatchOptions rest_options = options;
+    rest_options.on_result = [&](const BatchResult& result) {
+      if (!options.on_result ||
+          (!result.ok() && !last && IsBackendFailure(result.error))) {
+        return;
+      }
+      BatchResult slot = result;
+      slot.index = pending[result.index];
+      options.on_result(slot);
+    };
+
+    size_t index = impl_->Pick(kCall, tried, rest.size());
+    tried[index] = true;
+    std::vector<BatchResult> rest_results;
+    try {
+      rest_results =
+          impl_->backends()[index].llm->ChatBatch(rest, rest_options);
+    } catch (...) {
+      impl_->Finish(index, kCall, rest.size(), {}, Outcome::kRejected);
+      throw;
+    }
+
+    // Задержка пакета не задержка запроса: в EWMA не идет. Backend
+    // считается отказавшим, если не ответил ни на один запрос пакета
+    std::vector<size_t> failed;
+    for (auto& result : rest_results) {
+      size_t original = pending[result.index];
+      if (!result.ok() && IsBackendFailure(result.error)) {
+        failed.push_back(original);
+      }
+      results[original] = std::move(result);
+      results[original].index = original;
+    }
+    impl_->Finish(index, kCall, rest.size(), {},
+                  failed.size() == rest.size() ? Outcome::kFailure
+                                               : Outcome::kRejected);
+    pending = std::move(failed);
+  }
+  return results;
+}
+
+std::string RoutingAdapter::ModelName() const {
+  const auto& backends = impl_->backends();
+  return backends.empty() ? std::string() : backends.front().llm->ModelName();
+}
+
+std::vector<RoutingBackendStats> RoutingAdapter::stats() const {
+  std::vector<RoutingBackendStats> stats;
+  for (const Backend& backend : impl_->backends()) {
+    stats.push_back(impl_->Stats(backend));
+  }
+  return stats;
+}
+
+}  // namespace agentixx
@@ -0,0 +1,703 @@
+#include "agentixx/testing/mock_server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+
+#include "agentixx/core/json_writer.hpp"
+
+namespace agentixx {
+
+namespace {
+
+constexpr size_t kMaxHeaderSize = 64 * 1024;
+constexpr size_t kMaxBodySize = 64 * 1024 * 1024;
+
+using Clock = std::chrono::steady_clock;
+
+[[noreturn]] void ThrowErrno(const std::string& what) {
+  throw AgentCppException("Mock server: " + what + ": " +
+                          std::strerror(errno));
+}
+
+bool EndsWith(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(),
+                       suffix) == 0;
+}
+
+std::string Lower(std::string value) {
+  for (char& c : value) {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  return value;
+}
+
+std::string Trim(const std::string& value) {
+  size_t begin = value.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return std::string();
+  }
+  size_t end = value.find_last_not_of(" \t\r");
+  return value.substr(begin, end - begin + 1);
+}
+
+double Sample(const MockLatency& latency, std::mt19937_64& rng) {
+  double value = latency.a;
+  switch (latency.kind) {
+    case MockLatency::Kind::kFixed:
+      break;
+    case MockLatency::Kind::kUniform:
+      value = std::uniform_real_distribution<double>(
+          latency.a, std::max(latency.a, latency.b))(rng);
+      break;
+    case MockLatency::Kind::kNormal:
+      if (latency.b > 0) {
+        value = std::normal_distribution<double>(latency.a, latency.b)(rng);
+      }
+      break;
+    case MockLatency::Kind::kLogNormal:
+      value = latency.a *
+              std::exp(latency.b * std::normal_distribution<double>()(rng));
+      break;
+  }
+  return std::max(value, 0.0);
+}
+
+// Грубая оценка токенов запроса: 4 символа на токен
+long EstimatePromptTokens(const Json& body) {
+  size_t chars = 0;
+  auto messages = body.find("messages");
+  if (messages != body.end() && messages->is_array()) {
+    for (const auto& message : *messages) {
+      auto content = message.find("content");
+      if (content != message.end() && content->is_string()) {
+        chars += content->get_ref<const std::string&>().size();
+      }
+    }
+  }
+  auto prompt = body.find("prompt");
+  if (prompt != body.end() && prompt->is_string()) {
+    chars += prompt->get_ref<const std::string&>().size();
+  }
+  return std::max<long>(1, static_cast<long>(chars / 4));
+}
+
+// Общие поля ответа и chunks: id, object, created, model
+void WriteHead(JsonWriter& writer, uint64_t index, const char* object,
+               const std::string& model) {
+  writer.BeginObject()
+      .Key("id")
+      .String("chatcmpl-mock-" + std::to_string(index))
+      .Key("object")
+      .String(object)
+      .Key("created")
+      .Int(static_cast<int64_t>(std::time(nullptr)))
+      .Key("model")
+      .String(model);
+}
+
+void WriteUsage(JsonWriter& writer, long prompt_tokens,
+                long completion_tokens) {
+  writer.Key("usage")
+      .BeginObject()
+      .Key("prompt_tokens")
+      .Int(prompt_tokens)
+      .Key("completion_tokens")
+      .Int(completion_tokens)
+      .Key("total_tokens")
+      .Int(prompt_tokens + completion_tokens)
+      .EndObject();
+}
+
+std::string ErrorBody(const std::string& message, const char* type) {
+  std::string body;
+  JsonWriter writer(&body);
+  writer.BeginObject().Key("error").BeginObject();
+  writer.Key("message").String(message).Key("type").String(type);
+  writer.Key("code").Null().EndObject().EndObject();
+  return body;
+}
+
+// Событие SSE в chunk кодировке HTTP/1.1
+std::string SseChunk(const std::string& data) {
+  char size[24];
+  size_t length = data.size() + 8;  // "data: " и "\n\n"
+  std::snprintf(size, sizeof(size), "%zx\r\n", length);
+  std::string chunk(size);
+  chunk.reserve(chunk.size() + length + 2);
+  chunk.append("data: ").append(data).append("\n\n\r\n");
+  return chunk;
+}
+
+}  // namespace
+
+class MockOpenAIServer::Impl {
+ public:
+  explicit Impl(MockServerOptions options) : options_(std::move(options)) {}
+
+  ~Impl() { Stop(); }
+
+  int Start(int port, const std::string& address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+      throw AgentCppException("Mock server: already started");
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+      throw AgentCppException("Mock server: invalid address " + address);
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      ThrowErrno("socket");
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    socklen_t length = sizeof(addr);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, SOMAXCONN) < 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0 ||
+        pipe(wake_) < 0) {
+      int error = errno;
+      close(fd);
+      errno = error;
+      ThrowErrno("listen on " + address + ":" + std::to_string(port));
+    }
+
+    listen_fd_ = fd;
+    address_ = address;
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::thread([this] { Serve(); });
+    return port_;
+  }
+
+  void Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+    char byte = 0;
+    while (write(wake_[1], &byte, 1) < 0 && errno == EINTR) {
+    }
+    thread_.join();
+    close(listen_fd_);
+    close(wake_[0]);
+    close(wake_[1]);
+    listen_fd_ = wake_[0] = wake_[1] = -1;
+
+    // Потоки соединений просыпаются из recv и пауз и завершаются сами
+    std::unique_lock<std::mutex> connections_lock(connections_mutex_);
+    stopping_ = true;
+    for (int connection : connections_) {
+      shutdown(connection, SHUT_RDWR);
+    }
+    connections_cv_.notify_all();
+    connections_cv_.wait(connections_lock, [this] { return active_ == 0; });
+    stopping_ = false;
+  }
+
+  std::string base_url() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return "http://" + address_ + ":" + std::to_string(port_) + "/v1";
+  }
+
+  MockServerStats stats() const {
+    MockServerStats stats;
+    stats.requests = requests_.load(std::memory_order_relaxed);
+    stats.streams = streams_.load(std::memory_order_relaxed);
+    stats.rate_limited = rate_limited_.load(std::memory_order_relaxed);
+    stats.server_errors = server_errors_.load(std::memory_order_relaxed);
+    stats.disconnects = disconnects_.load(std::memory_order_relaxed);
+    stats.abandoned = abandoned_.load(std::memory_order_relaxed);
+    stats.connections = connections_total_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  struct HttpMessage {
+    std::string method;
+    std::string path;
+    Headers headers;
+    std::string body;
+  };
+
+  MockServerOptions options_;
+
+  mutable std::mutex mutex_;  // Start, Stop и адрес
+  std::string address_;
+  int port_ = 0;
+  int listen_fd_ = -1;
+  int wake_[2] = {-1, -1};  // Pipe остановки потока accept
+  std::thread thread_;
+
+  // Открытые соединения. cv будит и паузы ответов при остановке
+  std::mutex connections_mutex_;
+  std::condition_variable connections_cv_;
+  std::set<int> connections_;
+  size_t active_ = 0;
+  bool stopping_ = false;
+
+  std::atomic<uint64_t> next_index_{0};
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<uint64_t> streams_{0};
+  std::atomic<uint64_t> rate_limited_{0};
+  std::atomic<uint64_t> server_errors_{0};
+  std::atomic<uint64_t> disconnects_{0};
+  std::atomic<uint64_t> abandoned_{0};
+  std::atomic<uint64_t> connections_total_{0};
+
+  void Serve() {
+    while (true) {
+      pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+      if (poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      if (fds[1].revents != 0) {
+        return;
+      }
+      if (!(fds[0].revents & POLLIN)) {
+        continue;
+      }
+      int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client < 0) {
+        continue;
+      }
+      // Chunks потока уходят сразу, без ожидания Nagle
+      int one = 1;
+      setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      connections_total_.fetch_add(1, std::memory_order_relaxed);
+      {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.insert(client);
+        ++active_;
+      }
+      std::thread([this, client] {
+        try {
+          ServeConnection(client);
+        } catch (...) {
+          // Исключение script: соединение закрывается, сервер работает
+        }
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.erase(client);
+        close(client);
+        --active_;
+        connections_cv_.notify_all();
+      }).detach();
+    }
+  }
+
+  // Пауза до deadline. false - сервер останавливается
+  bool SleepUntil(Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    return !connections_cv_.wait_until(lock, deadline,
+                                       [this] { return stopping_; });
+  }
+
+  bool Sleep(double ms) {
+    if (ms <= 0) {
+      return true;
+    }
+    return SleepUntil(Clock::now() +
+                      std::chrono::duration_cast<Clock::duration>(
+                          std::chrono::duration<double, std::milli>(ms)));
+  }
+
+  static bool Receive(int fd, std::string* buffer) {
+    char data[16 * 1024];
+    while (true) {
+      ssize_t received = recv(fd, data, sizeof(data), 0);
+      if (received < 0 && errno == EINTR) {
+        continue;
+      }
+      if (received <= 0) {
+        return false;
+      }
+      buffer->append(data, static_cast<size_t>(received));
+      return true;
+    }
+  }
+
+  static bool Send(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t done =
+          send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (done < 0 && errno == EINTR) {
+        continue;
+      }
+      if (done <= 0) {
+        return false;
+      }
+      sent += static_cast<size_t>(done);
+    }
+    return true;
+  }
+
+  // Клиент закрыл соединение, не дождавшись ответа: отмененный запрос
+  // или проигравший дубль hedging. Пустое чтение без ожидания - FIN
+  bool Abandoned(int fd) {
+    char byte;
+    ssize_t received = recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (received > 0 ||
+        (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                          errno == EINTR))) {
+      return false;
+    }
+    abandoned_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  static bool SendResponse(int fd, const char* status,
+                           const std::string& headers,
+                           const std::string& body) {
+    return Send(fd, std::string("HTTP/1.1 ") + status +
+                        "\r\nContent-Type: application/json\r\n"
+                        "Content-Length: " +
+                        std::to_string(body.size()) + "\r\n" + headers +
+                        "\r\n" + body);
+  }
+
+  // Запросы соединения по очереди, пока клиент держит keep-alive
+  void ServeConnection(int fd) {
+    std::string buffer;
+    while (true) {
+      size_t header_end;
+      while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > kMaxHeaderSize || !Receive(fd, &buffer)) {
+          return;
+        }
+      }
+
+      HttpMessage request;
+      std::string head = buffer.substr(0, header_end);
+      size_t line_end = head.find("\r\n");
+      std::string line = head.substr(0, line_end);
+      size_t method_end = line.find(' ');
+      size_t path_end = line.find(' ', method_end + 1);
+      if (method_end == std::string::npos) {
+        return;
+      }
+      request.method = line.substr(0, method_end);
+      request.path = line.substr(method_end + 1, path_end - method_end - 1);
+      request.path = request.path.substr(0, request.path.find('?'));
+
+      size_t pos = line_end;
+      while (pos != std::string::npos && pos < head.size()) {
+        size_t next = head.find("\r\n", pos + 2);
+        std::string header = head.substr(pos + 2, next - pos - 2);
+        size_t colon = header.find(':');
+        if (colon != std::string::npos) {
+          request.headers[Lower(Trim(header.substr(0, colon)))] =
+              Trim(header.substr(colon + 1));
+        }
+        pos = next;
+      }
+
+      size_t length = 0;
+      auto content_length = request.headers.find("content-length");
+      if (content_length != request.headers.end()) {
+        length = std::strtoull(content_length->second.c_str(), nullptr, 10);
+      }
+      if (length > kMaxBodySize) {
+        SendResponse(fd, "413 Payload Too Large", "Connection: close\r\n",
+                     ErrorBody("Request body too large",
+                               "invalid_request_error"));
+        return;
+      }
+      size_t body_start = header_end + 4;
+      auto expect = request.headers.find("expect");
+      if (expect != request.headers.end() &&
+          Lower(expect->second) == "100-continue" &&
+          buffer.size() < body_start + length &&
+          !Send(fd, "HTTP/1.1 100 Continue\r\n\r\n")) {
+        return;
+      }
+      while (buffer.size() < body_start + length) {
+        if (!Receive(fd, &buffer)) {
+          return;
+        }
+      }
+      request.body = buffer.substr(body_start, length);
+      buffer.erase(0, body_start + length);
+
+      auto connection = request.headers.find("connection");
+      bool keep_alive = connection == request.headers.end() ||
+                        Lower(connection->second) != "close";
+      if (!Handle(fd, request) || !keep_alive) {
+        return;
+      }
+    }
+  }
+
+  // Ответить на запрос. false - соединение нужно закрыть
+  bool Handle(int fd, const HttpMessage& message) {
+    bool chat = EndsWith(message.path, "/chat/completions");
+    bool completion = !chat && EndsWith(message.path, "/completions");
+    if (!chat && !completion) {
+      return SendResponse(fd, "404 Not Found", "",
+                          ErrorBody("Unknown path " + message.path,
+                                    "invalid_request_error"));
+    }
+    if (message.method != "POST") {
+      return SendResponse(fd, "405 Method Not Allowed", "",
+                          ErrorBody("Method not allowed",
+                                    "invalid_request_error"));
+    }
+
+    MockRequest request;
+    request.body = Json::parse(message.body, nullptr, false);
+    if (request.body.is_discarded() || !request.body.is_object()) {
+      return SendResponse(
+          fd, "400 Bad Request", "",
+          ErrorBody("Request body is not a JSON object",
+                    "invalid_request_error"));
+    }
+    request.index = next_index_.fetch_add(1, std::memory_order_relaxed);
+    request.path = message.path;
+    request.headers = message.headers;
+    auto model = request.body.find("model");
+    request.model = model != request.body.end() && model->is_string()
+                        ? model->get<std::string>()
+                        : std::string("mock");
+    auto stream = request.body.find("stream");
+    request.stream = stream != request.body.end() && stream->is_boolean() &&
+                     stream->get<bool>();
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    if (request.stream) {
+      streams_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MockBehavior behavior = options_.behavior;
+    if (options_.script) {
+      options_.script(request, behavior);
+    }
+
+    // Порядок выборок фиксирован: задержка, затем ошибка
+    std::seed_seq seed{static_cast<uint32_t>(options_.seed),
+                       static_cast<uint32_t>(options_.seed >> 32),
+                       static_cast<uint32_t>(request.index),
+                       static_cast<uint32_t>(request.index >> 32)};
+    std::mt19937_64 rng(seed);
+    double latency = Sample(behavior.latency, rng);
+    double draw = std::uniform_real_distribution<double>()(rng);
+    MockBehavior::Fault fault = behavior.fault;
+    if (fault == MockBehavior::Fault::kNone) {
+      double p429 = behavior.rate_limit_probability;
+      double p500 = p429 + behavior.server_error_probability;
+      double pdrop = p500 + behavior.disconnect_probability;
+      if (draw < p429) {
+        fault = MockBehavior::Fault::kRateLimit;
+      } else if (draw < p500) {
+        fault = MockBehavior::Fault::kServerError;
+      } else if (draw < pdrop) {
+        fault = MockBehavior::Fault::kDisconnect;
+      }
+    }
+
+    if (!Sleep(latency) || Abandoned(fd)) {
+      return false;
+    }
+
+    std::string request_id = "x-request-id: mock-" +
+                             std::to_string(request.index) + "\r\n";
+    if (fault == MockBehavior::Fault::kRateLimit) {
+      rate_limited_.fetch_add(1, std::memory_order_relaxed);
+      int retry_ms = std::max(behavior.retry_after_ms, 0);
+      return SendResponse(
+          fd, "429 Too Many Requests",
+          request_id + "retry-after: " +
+              std::to_string((retry_ms + 999) / 1000) +
+              "\r\nretry-after-ms: " + std::to_string(retry_ms) + "\r\n",
+          ErrorBody("Rate limit reached (mock)", "rate_limit_error"));
+    }
+    if (fault == MockBehavior::Fault::kServerError) {
+      server_errors_.fetch_add(1, std::memory_order_relaxed);
+      return SendResponse(
+          fd, "500 Internal Server Error", request_id,
+          ErrorBody("Internal server error (mock)", "server_error"));
+    }
+    bool disconnect = fault == MockBehavior::Fault::kDisconnect;
+    if (disconnect) {
+      disconnects_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    long prompt_tokens = EstimatePromptTokens(request.body);
+    long tokens = std::max(behavior.completion_tokens, 0);
+    double gap_ms = behavior.tokens_per_second > 0
+                        ? 1000.0 / behavior.tokens_per_second
+                        : 0;
+    if (request.stream) {
+      return Stream(fd, request, behavior, chat, prompt_tokens, tokens,
+                    gap_ms, disconnect, request_id);
+    }
+
+    // Обычный ответ приходит, когда сгенерирован весь текст
+    if (!Sleep(gap_ms * tokens) || Abandoned(fd)) {
+      return false;
+    }
+    std::string text;
+    text.reserve(behavior.token.size() * tokens);
+    for (long i = 0; i < tokens; ++i) {
+      text += behavior.token;
+    }
+    std::string body;
+    JsonWriter writer(&body);
+    WriteHead(writer, request.index,
+              chat ? "chat.completion" : "text_completion", request.model);
+    writer.Key("choices").BeginArray().BeginObject().Key("index").Int(0);
+    if (chat) {
+      writer.Key("message").BeginObject().Key("role").String("assistant");
+      writer.Key("content").String(text).EndObject();
+    } else {
+      writer.Key("text").String(text);
+    }
+    writer.Key("finish_reason").String("stop").EndObject().EndArray();
+    if (behavior.usage) {
+      WriteUsage(writer, prompt_tokens, tokens);
+    }
+    writer.EndObject();
+
+    if (disconnect) {
+      // Заголовки обещают все тело, приходит половина
+      std::string response = "HTTP/1.1 200 OK\r\nContent-Type: "
+                             "application/json\r\nContent-Length: " +
+                             std::to_string(body.size()) + "\r\n" +
+                             request_id + "\r\n" +
+                             body.substr(0, body.size() / 2);
+      Send(fd, response);
+      shutdown(fd, SHUT_RDWR);
+      return false;
+    }
+    return SendResponse(fd, "200 OK", request_id, body);
+  }
+
+  bool Stream(int fd, const MockRequest& request,
+              const MockBehavior& behavior, bool chat, long prompt_tokens,
+              long tokens, double gap_ms, bool disconnect,
+              const std::string& request_id) {
+    const char* object = chat ? "chat.completion.chunk" : "text_completion";
+    // Chunk с текстом одинаков для всех токенов: собирается один раз
+    auto make_chunk = [&](const std::string* content, bool finish) {
+      std::string data;
+      JsonWriter writer(&data);
+      WriteHead(writer, request.index, object, request.model);
+      writer.Key("choices").BeginArray().BeginObject().Key("index").Int(0);
+      if (chat) {
+        writer.Key("delta").BeginObject();
+        if (content) {
+          writer.Key("content").String(*content);
+        }
+        writer.EndObject();
+      } else {
+        writer.Key("text").String(content ? *content : std::string());
+      }
+      writer.Key("finish_reason");
+      if (finish) {
+        writer.String("stop");
+      } else {
+        writer.Null();
+      }
+      writer.EndObject().EndArray().EndObject();
+      return SseChunk(data);
+    };
+
+    std::string head =
+        "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\nTransfer-Encoding: chunked\r\n" +
+        request_id + "\r\n";
+    if (chat) {
+      // Первый chunk OpenAI несет роль без текста
+      std::string data;
+      JsonWriter writer(&data);
+      WriteHead(writer, request.index, object, request.model);
+      writer.Key("choices").BeginArray().BeginObject().Key("index").Int(0);
+      writer.Key("delta").BeginObject().Key("role").String("assistant");
+      writer.Key("content").String("").EndObject();
+      writer.Key("finish_reason").Null().EndObject().EndArray().EndObject();
+      head += SseChunk(data);
+    }
+    if (!Send(fd, head)) {
+      return false;
+    }
+
+    std::string token_chunk = make_chunk(&behavior.token, false);
+    long sent_tokens = disconnect ? tokens / 2 : tokens;
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < sent_tokens; ++i) {
+      // Расписание от начала потока: паузы не накапливают погрешность
+      if (gap_ms > 0 &&
+          !SleepUntil(start + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double, std::milli>(
+                                      gap_ms * (i + 1))))) {
+        return false;
+      }
+      if (!Send(fd, token_chunk)) {
+        abandoned_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    if (disconnect) {
+      // Обрыв без завершающего chunk: клиент видит ошибку передачи
+      shutdown(fd, SHUT_RDWR);
+      return false;
+    }
+
+    std::string tail = make_chunk(nullptr, true);
+    if (behavior.usage) {
+      // Как stream_options.include_usage: choices пустой
+      std::string data;
+      JsonWriter writer(&data);
+      WriteHead(writer, request.index, object, request.model);
+      writer.Key("choices").BeginArray().EndArray();
+      WriteUsage(writer, prompt_tokens, tokens);
+      writer.EndObject();
+      tail += SseChunk(data);
+    }
+    tail += SseChunk("[DONE]");
+    tail += "0\r\n\r\n";
+    return Send(fd, tail);
+  }
+};
+
+MockOpenAIServer::MockOpenAIServer(MockServerOptions options)
+    : pimpl_(std::make_unique<Impl>(std::move(options))) {}
+
+MockOpenAIServer::~MockOpenAIServer() = default;
+
+int MockOpenAIServer::Start(int port, const std::string& address) {
+  return pimpl_->Start(port, address);
+}
+
+void MockOpenAIServer::Stop() { pimpl_->Stop(); }
+
+std::string MockOpenAIServer::base_url() const { return pimpl_->base_url(); }
+
+MockServerStats MockOpenAIServer::stats() const { return pimpl_->stats(); }
+
+}  // namespace agentixx
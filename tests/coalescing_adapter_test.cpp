@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+
+namespace agentixx {
+namespace {
+
+const std::vector<Message> kMessages = {{"user", "plan"}};
+const std::string kText = "token token token token token token ";
+
+class CoalescingAdapterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MockServerOptions options;
+    options.behavior.SetCompletionTokens(6);
+    server_ = std::make_unique<MockOpenAIServer>(options);
+    server_->Start();
+  }
+
+  CoalescingAdapter MakeAdapter(StreamRetention retention) {
+    Config config;
+    config.SetApiKey("test");
+    config.SetBaseUrl(server_->base_url());
+    config.SetStreamRetention(retention);
+    return CoalescingAdapter(std::make_unique<OpenAIAdapter>(config, "mock"));
+  }
+
+  std::unique_ptr<MockOpenAIServer> server_;
+};
+
+std::string ReadAll(StreamingResponse& stream) {
+  std::string text;
+  for (const auto& chunk : stream) {
+    text += chunk.text();
+  }
+  return text;
+}
+
+TEST_F(CoalescingAdapterTest, SubscribersShareOneStream) {
+  for (auto retention : {StreamRetention::All(), StreamRetention::None()}) {
+    CoalescingAdapter adapter = MakeAdapter(retention);
+    uint64_t requests = server_->stats().requests;
+
+    auto first = adapter.ChatStream(kMessages);
+    auto second = adapter.ChatStream(kMessages);
+    EXPECT_EQ(ReadAll(first), kText);
+    EXPECT_EQ(ReadAll(second), kText);
+
+    EXPECT_EQ(server_->stats().requests - requests, 1u);
+    EXPECT_EQ(adapter.stats().coalesced, 1u);
+  }
+}
+
+TEST_F(CoalescingAdapterTest, LateJoinerReplaysBufferedStream) {
+  CoalescingAdapter adapter = MakeAdapter(StreamRetention::All());
+
+  auto first = adapter.ChatStream(kMessages);
+  auto it = first.begin();
+  ASSERT_NE(it, first.end());
+  ++it;
+
+  // Весь поток в буфере: опоздавший получает его с начала
+  auto late = adapter.ChatStream(kMessages);
+  EXPECT_EQ(ReadAll(late), kText);
+  EXPECT_EQ(adapter.stats().coalesced, 1u);
+  EXPECT_EQ(server_->stats().requests, 1u);
+}
+
+TEST_F(CoalescingAdapterTest, BoundedRetentionTrimsReadChunks) {
+  CoalescingAdapter adapter = MakeAdapter(StreamRetention::None());
+
+  auto first = adapter.ChatStream(kMessages);
+  auto it = first.begin();
+  ASSERT_NE(it, first.end());
+  std::string text = it->text();
+  ++it;
+
+  // Прочитанный единственным подписчиком chunk уже удален, опоздавший
+  // идет в API сам и получает полный поток
+  auto late = adapter.ChatStream(kMessages);
+  EXPECT_EQ(ReadAll(late), kText);
+  EXPECT_EQ(adapter.stats().coalesced, 0u);
+  EXPECT_EQ(server_->stats().requests, 2u);
+
+  for (; it != first.end(); ++it) {
+    text += it->text();
+  }
+  EXPECT_EQ(text, kText);
+}
+
+}  // namespace
+}  // namespace agentixx
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace agentixx {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char kBody[] =
+    R"({"model":"mock","messages":[{"role":"user","content":"hi"}]})";
+const Headers kHeaders = {{"Content-Type", "application/json"}};
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+MockServerOptions SlowServer(double latency_ms) {
+  MockServerOptions options;
+  options.behavior.SetLatency(MockLatency::Fixed(latency_ms));
+  options.behavior.SetCompletionTokens(2);
+  return options;
+}
+
+// threads одновременных post через один клиент, возвращает время в мс
+double PostConcurrently(HttpClient& client, const std::string& url,
+                        int threads) {
+  std::vector<std::thread> workers;
+  std::vector<int> status(threads, 0);
+  auto start = Clock::now();
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      status[i] = client.post(url, kBody, kHeaders).status_code;
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double elapsed = ElapsedMs(start);
+  for (int code : status) {
+    EXPECT_EQ(code, 200);
+  }
+  return elapsed;
+}
+
+TEST(ConnectionPoolTest, ConcurrentCallersDoNotWait) {
+  MockOpenAIServer server(SlowServer(400));
+  server.Start();
+
+  auto pool = std::make_shared<ConnectionPool>();
+  Config config;
+  config.SetApiKey("test");
+  config.SetConnectionPool(pool);
+  HttpClient client(config);
+
+  // С лимитом 8 аренд вторая половина ждала бы первую: не меньше 800 мс
+  double elapsed =
+      PostConcurrently(client, server.base_url() + "/chat/completions", 16);
+  EXPECT_LT(elapsed, 750);
+
+  auto stats = pool->GetStats();
+  EXPECT_EQ(stats.leased, 0u);
+  EXPECT_EQ(stats.created, 16u);
+  EXPECT_EQ(stats.idle, pool->options().max_idle_per_host);
+  EXPECT_EQ(stats.evicted, 16u - stats.idle);
+}
+
+TEST(ConnectionPoolTest, IdleHandlesAreCapped) {
+  MockOpenAIServer server(SlowServer(50));
+  server.Start();
+
+  ConnectionPoolOptions options;
+  options.SetMaxIdlePerHost(3);
+  auto pool = std::make_shared<ConnectionPool>(options);
+  Config config;
+  config.SetApiKey("test");
+  config.SetConnectionPool(pool);
+  HttpClient client(config);
+
+  std::string url = server.base_url() + "/chat/completions";
+  PostConcurrently(client, url, 6);
+  EXPECT_EQ(pool->GetStats().idle, 3u);
+
+  // Следующая волна переиспользует сохраненные handles
+  PostConcurrently(client, url, 3);
+  auto stats = pool->GetStats();
+  EXPECT_EQ(stats.created, 6u);
+  EXPECT_EQ(stats.reused, 3u);
+}
+
+TEST(ConnectionPoolTest, ConnectionLimitBlocks) {
+  MockOpenAIServer server(SlowServer(200));
+  server.Start();
+
+  ConnectionPoolOptions options;
+  options.SetMaxConnectionsPerHost(2);
+  auto pool = std::make_shared<ConnectionPool>(options);
+  Config config;
+  config.SetApiKey("test");
+  config.SetConnectionPool(pool);
+  HttpClient client(config);
+
+  // Четыре запроса по два одновременно - две волны
+  double elapsed =
+      PostConcurrently(client, server.base_url() + "/chat/completions", 4);
+  EXPECT_GE(elapsed, 400);
+  EXPECT_EQ(pool->GetStats().created, 2u);
+}
+
+TEST(ConnectionPoolTest, ClientsShareLoopConnections) {
+  MockOpenAIServer server(SlowServer(0));
+  server.Start();
+
+  auto pool = std::make_shared<ConnectionPool>();
+  Config config;
+  config.SetApiKey("test");
+  config.SetConnectionPool(pool);
+  HttpClient first(config);
+  HttpClient second(config);
+
+  // Асинхронные запросы обоих клиентов идут через цикл пула и его
+  // соединения
+  std::string url = server.base_url() + "/chat/completions";
+  HttpResponse a = first.PostAsync(url, kBody, kHeaders).get();
+  HttpResponse b = second.PostAsync(url, kBody, kHeaders).get();
+  EXPECT_EQ(a.status_code, 200);
+  EXPECT_EQ(b.status_code, 200);
+  EXPECT_TRUE(b.reused_connection);
+  EXPECT_EQ(server.stats().connections, 1u);
+}
+
+}  // namespace
+}  // namespace agentixx
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace agentixx {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char kBody[] =
+    R"({"model":"mock","messages":[{"role":"user","content":"hi"}]})";
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+TEST(EventLoopTest, PendingTimersRunOnShutdown) {
+  bool posted = false;
+  bool delayed = false;
+  auto start = Clock::now();
+  {
+    EventLoop loop;
+    loop.PostAfter(std::chrono::hours(1), [&] { delayed = true; });
+    loop.Post([&] { posted = true; });
+  }
+  EXPECT_TRUE(posted);
+  EXPECT_TRUE(delayed);
+  EXPECT_LT(ElapsedMs(start), 5000);
+}
+
+TEST(EventLoopTest, StoppedLoopRejectsWork) {
+  // Таймер выполняется при остановке, когда цикл уже не принимает задачи:
+  // так повтор после паузы узнает об остановке
+  auto loop = std::make_unique<EventLoop>();
+  EventLoop* raw = loop.get();
+  std::string send_error;
+  std::string post_error;
+  loop->PostAfter(std::chrono::hours(1), [&] {
+    try {
+      raw->Send(HttpRequest{}, nullptr, nullptr);
+    } catch (const NetworkError& e) {
+      send_error = e.what();
+    }
+    try {
+      raw->PostAfter(std::chrono::milliseconds(1), [] {});
+    } catch (const NetworkError& e) {
+      post_error = e.what();
+    }
+  });
+  loop.reset();
+
+  EXPECT_EQ(send_error, "Network error: Event loop stopped");
+  EXPECT_EQ(post_error, "Network error: Event loop stopped");
+}
+
+TEST(EventLoopTest, ClientDestroyedDuringRetryAfter) {
+  MockServerOptions options;
+  options.behavior.SetCompletionTokens(4);
+  options.SetScript([](const MockRequest& request, MockBehavior& behavior) {
+    if (request.index == 0) {
+      behavior.SetFault(MockBehavior::Fault::kRateLimit);
+      behavior.SetRetryAfterMs(300);
+    }
+  });
+  MockOpenAIServer server(options);
+  server.Start();
+
+  RetryPolicy policy;
+  policy.max_attempts = 3;
+  policy.initial_backoff_ms = 1;
+  policy.max_backoff_ms = 1;
+
+  Config config;
+  config.SetApiKey("test");
+  config.SetRetryPolicy(policy);
+
+  // Клиент уничтожается, пока повтор ждет Retry-After. Повтор держит
+  // цикл сам и завершает future ответом, а не broken_promise
+  std::future<HttpResponse> future;
+  {
+    HttpClient client(config);
+    future = client.PostAsync(server.base_url() + "/chat/completions", kBody,
+                              {{"Content-Type", "application/json"}});
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (server.stats().rate_limited == 0 && Clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(server.stats().rate_limited, 1u);
+  }
+
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  HttpResponse response = future.get();
+  EXPECT_EQ(response.status_code, 200);
+  EXPECT_EQ(server.stats().requests, 2u);
+}
+
+}  // namespace
+}  // namespace agentixx
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace agentixx {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double kFastMs = 10;
+constexpr double kSlowMs = 400;
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Первый запрос с текстом "slow ..." отвечает медленно, его дубль и
+// остальные запросы - быстро: одна медленная реплика на запрос
+class SlowReplicaServer {
+ public:
+  SlowReplicaServer() {
+    MockServerOptions options;
+    options.behavior.SetLatency(MockLatency::Fixed(kFastMs));
+    options.behavior.SetCompletionTokens(4);
+    options.SetScript([this](const MockRequest& request,
+                             MockBehavior& behavior) {
+      std::string content = request.body.at("messages").back().at("content");
+      if (content.rfind("slow", 0) != 0) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (seen_.insert(content).second) {
+        behavior.SetLatency(MockLatency::Fixed(kSlowMs));
+      }
+    });
+    server_ = std::make_unique<MockOpenAIServer>(options);
+    server_->Start();
+  }
+
+  MockOpenAIServer& server() { return *server_; }
+
+  // Проигравшие дубли отменяются на клиенте, сервер замечает закрытое
+  // соединение, когда просыпается после задержки
+  uint64_t WaitAbandoned(uint64_t expected) {
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (server_->stats().abandoned < expected && Clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return server_->stats().abandoned;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::set<std::string> seen_;
+  std::unique_ptr<MockOpenAIServer> server_;
+};
+
+Config MakeConfig(const std::string& base_url, double budget) {
+  // Дубль не раньше 100 мс: быстрые ответы никогда его не вызывают,
+  // медленная реплика - всегда, если позволяет бюджет
+  HedgingPolicy policy;
+  policy.percentile = 0.9;
+  policy.budget = budget;
+  policy.initial_delay_ms = 100;
+  policy.min_delay_ms = 100;
+
+  Config config;
+  config.SetApiKey("test");
+  config.SetBaseUrl(base_url);
+  config.SetHedging(policy);
+  return config;
+}
+
+// Каждый десятый запрос попадает на медленную реплику
+std::vector<Message> Request(int i) {
+  std::string prefix = i % 10 == 9 ? "slow " : "fast ";
+  return {{"user", prefix + std::to_string(i)}};
+}
+
+TEST(HedgingTest, HedgeWinsOverSlowReplica) {
+  SlowReplicaServer mock;
+  OpenAIAdapter adapter(MakeConfig(mock.server().base_url(), 0.2), "mock");
+
+  constexpr int kRequests = 40;
+  for (int i = 0; i < kRequests; ++i) {
+    auto start = Clock::now();
+    Response response = adapter.Chat(Request(i));
+    EXPECT_EQ(response.text(), "token token token token ");
+    // Медленную реплику ждать не пришлось
+    EXPECT_LT(ElapsedMs(start), kSlowMs / 2) << i;
+  }
+
+  HedgingStats stats = adapter.hedging_stats();
+  EXPECT_EQ(stats.requests, static_cast<uint64_t>(kRequests));
+  EXPECT_EQ(stats.hedged, 4u);
+  EXPECT_EQ(stats.hedge_wins, 4u);
+
+  // Каждый проигравший запрос прерван, а не дочитан
+  EXPECT_GE(mock.WaitAbandoned(4), 4u);
+}
+
+TEST(HedgingTest, StreamHedgeWinsOverSlowReplica) {
+  SlowReplicaServer mock;
+  OpenAIAdapter adapter(MakeConfig(mock.server().base_url(), 0.2), "mock");
+
+  constexpr int kRequests = 20;
+  for (int i = 0; i < kRequests; ++i) {
+    std::string text;
+    for (const auto& chunk : adapter.ChatStream(Request(i))) {
+      text += chunk.text();
+    }
+    EXPECT_EQ(text, "token token token token ");
+  }
+
+  HedgingStats stats = adapter.hedging_stats();
+  EXPECT_EQ(stats.requests, static_cast<uint64_t>(kRequests));
+  EXPECT_EQ(stats.hedged, 2u);
+  EXPECT_EQ(stats.hedge_wins, 2u);
+  EXPECT_GE(mock.WaitAbandoned(2), 2u);
+}
+
+TEST(HedgingTest, HedgesStayWithinBudget) {
+  SlowReplicaServer mock;
+  OpenAIAdapter adapter(MakeConfig(mock.server().base_url(), 0.1), "mock");
+
+  // После 10 быстрых запросов медленная реплика у каждого: дубль нужен
+  // всем, но бюджет пропускает только каждый десятый запрос
+  constexpr int kRequests = 20;
+  for (int i = 0; i < kRequests; ++i) {
+    std::string prefix = i < kRequests / 2 ? "fast " : "slow ";
+    adapter.Chat({{"user", prefix + std::to_string(i)}});
+  }
+
+  HedgingStats stats = adapter.hedging_stats();
+  EXPECT_EQ(stats.requests, static_cast<uint64_t>(kRequests));
+  EXPECT_EQ(stats.hedged, static_cast<uint64_t>(0.1 * kRequests));
+  EXPECT_EQ(stats.hedge_wins, stats.hedged);
+  // Без дубля запросы дождались медленной реплики
+  EXPECT_EQ(mock.server().stats().requests, kRequests + stats.hedged);
+}
+
+}  // namespace
+}  // namespace agentixx
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace agentixx {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr int kLines = 200;
+
+// Передает запросы в inner и падает на окне номер crash_at, как процесс,
+// убитый посреди прогона
+class CrashingLLM : public LLMInterface {
+ public:
+  CrashingLLM(LLMInterface& inner, int crash_at)
+      : inner_(inner), crash_at_(crash_at) {}
+
+  Response Complete(const std::string& prompt) override {
+    return inner_.Complete(prompt);
+  }
+  Response Chat(const std::vector<Message>& messages) override {
+    return inner_.Chat(messages);
+  }
+  std::vector<BatchResult> ChatBatch(
+      const std::vector<std::vector<Message>>& batch,
+      const BatchOptions& options) override {
+    if (batches_++ == crash_at_) {
+      throw std::runtime_error("crash");
+    }
+    return inner_.ChatBatch(batch, options);
+  }
+  std::string ModelName() const override { return inner_.ModelName(); }
+
+ private:
+  LLMInterface& inner_;
+  int crash_at_;
+  int batches_ = 0;
+};
+
+class JsonlRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("agentixx_jsonl_" + std::to_string(std::random_device{}()));
+    fs::create_directories(dir_);
+    input_ = (dir_ / "input.jsonl").string();
+    output_ = (dir_ / "output.jsonl").string();
+    checkpoint_ = (dir_ / "checkpoint").string();
+
+    std::ofstream input(input_);
+    for (int i = 0; i < kLines; ++i) {
+      input << "{\"id\":\"req-" << i
+            << "\",\"messages\":[{\"role\":\"user\",\"content\":\"q" << i
+            << "\"}]}\n";
+    }
+  }
+
+  void TearDown() override { fs::remove_all(dir_); }
+
+  JsonlRunOptions Options() const {
+    JsonlRunOptions options;
+    options.SetMaxInFlight(4);
+    options.SetWindow(16);
+    options.SetCheckpointPath(checkpoint_);
+    return options;
+  }
+
+  std::vector<Json> ReadOutput() const {
+    std::vector<Json> lines;
+    std::ifstream in(output_);
+    std::string line;
+    while (std::getline(in, line)) {
+      lines.push_back(Json::parse(line));
+    }
+    return lines;
+  }
+
+  fs::path dir_;
+  std::string input_;
+  std::string output_;
+  std::string checkpoint_;
+};
+
+TEST_F(JsonlRunnerTest, ResumeWritesEveryLineOnceInOrder) {
+  // Ошибки сервера и обрывы соединений, часть из них переживает повторы
+  MockServerOptions mock_options;
+  mock_options.behavior.SetCompletionTokens(3);
+  mock_options.behavior.SetServerErrorProbability(0.2);
+  mock_options.behavior.SetDisconnectProbability(0.1);
+  MockOpenAIServer server(mock_options);
+  server.Start();
+
+  RetryPolicy retry;
+  retry.max_attempts = 2;
+  retry.initial_backoff_ms = 1;
+  retry.max_backoff_ms = 5;
+
+  Config config;
+  config.SetApiKey("test");
+  config.SetBaseUrl(server.base_url());
+  config.SetRetryPolicy(retry);
+  OpenAIAdapter adapter(config, "mock");
+
+  // Первый запуск падает на пятом окне
+  CrashingLLM crashing(adapter, 4);
+  JsonlRunner first(crashing, Options());
+  EXPECT_THROW(first.Run(input_, output_), std::runtime_error);
+  EXPECT_EQ(ReadOutput().size(), 4u * 16);
+
+  // Сбой между записью результата и checkpoint оставляет неподтвержденный
+  // хвост, в том числе оборванную строку
+  {
+    std::ofstream out(output_, std::ios::app);
+    out << "{\"id\":\"req-64\",\"line\":65,\"content\":\"stale\"}\n"
+        << "{\"id\":\"req-65\",\"li";
+  }
+
+  JsonlRunner second(adapter, Options());
+  JsonlProgress progress = second.Run(input_, output_);
+  EXPECT_EQ(progress.lines, static_cast<uint64_t>(kLines));
+  EXPECT_EQ(progress.succeeded + progress.failed,
+            static_cast<uint64_t>(kLines));
+  EXPECT_EQ(progress.input_offset, progress.input_size);
+
+  std::vector<Json> lines = ReadOutput();
+  ASSERT_EQ(lines.size(), static_cast<size_t>(kLines));
+  uint64_t errors = 0;
+  for (int i = 0; i < kLines; ++i) {
+    EXPECT_EQ(lines[i].at("id"), "req-" + std::to_string(i));
+    EXPECT_EQ(lines[i].at("line"), i + 1);
+    if (lines[i].contains("error")) {
+      ++errors;
+    } else {
+      EXPECT_EQ(lines[i].at("content"), "token token token ");
+    }
+  }
+  EXPECT_EQ(errors, progress.failed);
+  // Строки, не пережившие повторов, тоже записаны ровно один раз
+  EXPECT_GT(errors, 0u);
+
+  // Ошибки действительно были
+  MockServerStats stats = server.stats();
+  EXPECT_GT(stats.server_errors, 0u);
+  EXPECT_GT(stats.disconnects, 0u);
+}
+
+}  // namespace
+}  // namespace agentixx
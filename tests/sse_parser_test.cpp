@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/core/sse_parser.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agentixx {
+namespace {
+
+// Копия SseEvent: views действительны только внутри callback
+struct Event {
+  std::string type;
+  std::string data;
+  std::string id;
+
+  bool operator==(const Event& other) const {
+    return type == other.type && data == other.data && id == other.id;
+  }
+};
+
+std::ostream& operator<<(std::ostream& os, const Event& event) {
+  return os << "{type=" << event.type << " data=" << event.data
+            << " id=" << event.id << "}";
+}
+
+class Collector {
+ public:
+  SseParser::EventHandler handler() {
+    return [this](const SseEvent& event) {
+      events_.push_back({std::string(event.type), std::string(event.data),
+                         std::string(event.id)});
+    };
+  }
+
+  const std::vector<Event>& events() const { return events_; }
+
+ private:
+  std::vector<Event> events_;
+};
+
+std::vector<Event> ParseWhole(std::string_view input) {
+  SseParser parser;
+  Collector collector;
+  parser.Feed(input, collector.handler());
+  return collector.events();
+}
+
+std::vector<Event> ParseByteByByte(std::string_view input) {
+  SseParser parser;
+  Collector collector;
+  auto handler = collector.handler();
+  for (size_t i = 0; i < input.size(); ++i) {
+    parser.Feed(input.substr(i, 1), handler);
+  }
+  return collector.events();
+}
+
+TEST(SseParserTest, LfLineEndings) {
+  auto events = ParseWhole("data: a\n\ndata: b\n\n");
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].data, "a");
+  EXPECT_EQ(events[1].data, "b");
+  EXPECT_EQ(events[0].type, "message");
+}
+
+TEST(SseParserTest, CrLineEndings) {
+  auto events = ParseWhole("data: a\r\rdata: b\r\r");
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].data, "a");
+  EXPECT_EQ(events[1].data, "b");
+}
+
+TEST(SseParserTest, CrLfLineEndings) {
+  auto events = ParseWhole("data: a\r\n\r\ndata: b\r\n\r\n");
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].data, "a");
+  EXPECT_EQ(events[1].data, "b");
+}
+
+TEST(SseParserTest, CrLfSplitAcrossFeeds) {
+  // CR в конце куска и LF в начале следующего - одно окончание строки,
+  // а не пустая строка, которая завершила бы событие
+  SseParser parser;
+  Collector collector;
+  auto handler = collector.handler();
+  parser.Feed("data: a\r", handler);
+  parser.Feed("\ndata: b\r", handler);
+  EXPECT_TRUE(collector.events().empty());
+  parser.Feed("\n\r", handler);
+  parser.Feed("\n", handler);
+
+  ASSERT_EQ(collector.events().size(), 1u);
+  EXPECT_EQ(collector.events()[0].data, "a\nb");
+}
+
+TEST(SseParserTest, MixedLineEndings) {
+  auto events = ParseWhole("data: a\r\ndata: b\rdata: c\n\r\n");
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "a\nb\nc");
+}
+
+TEST(SseParserTest, StripsLeadingBom) {
+  auto events = ParseWhole("\xEF\xBB\xBF" "data: a\n\n");
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "a");
+}
+
+TEST(SseParserTest, BomOnlyAtStreamStart) {
+  // BOM в середине потока - часть данных
+  auto events = ParseWhole("data: a\n\ndata: \xEF\xBB\xBF" "b\n\n");
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[1].data, "\xEF\xBB\xBF" "b");
+}
+
+TEST(SseParserTest, BomSplitAcrossFeeds) {
+  SseParser parser;
+  Collector collector;
+  auto handler = collector.handler();
+  parser.Feed("\xEF", handler);
+  parser.Feed("\xBB\xBF" "da", handler);
+  parser.Feed("ta: a\n\n", handler);
+
+  ASSERT_EQ(collector.events().size(), 1u);
+  EXPECT_EQ(collector.events()[0].data, "a");
+}
+
+TEST(SseParserTest, MultiLineData) {
+  auto events = ParseWhole("data: first\ndata:second\ndata\ndata:  four\n\n");
+  ASSERT_EQ(events.size(), 1u);
+  // Удаляется только один пробел после двоеточия, data без значения
+  // добавляет пустую строку
+  EXPECT_EQ(events[0].data, "first\nsecond\n\n four");
+}
+
+TEST(SseParserTest, EventWithoutDataIsNotDispatched) {
+  auto events = ParseWhole("event: ping\n\ndata: a\n\n");
+  ASSERT_EQ(events.size(), 1u);
+  // Тип сбрасывается и на событии без data
+  EXPECT_EQ(events[0].type, "message");
+}
+
+TEST(SseParserTest, EventType) {
+  auto events = ParseWhole("event: delta\ndata: a\n\ndata: b\n\n");
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].type, "delta");
+  EXPECT_EQ(events[1].type, "message");
+}
+
+TEST(SseParserTest, SkipsComments) {
+  auto events = ParseWhole(": keep-alive\ndata: a\n:\n: data: b\n\n");
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "a");
+}
+
+TEST(SseParserTest, CommentOnlyStreamHasNoEvents) {
+  EXPECT_TRUE(ParseWhole(": ping\n\n: ping\n\n").empty());
+}
+
+TEST(SseParserTest, IdPersistsAcrossEvents) {
+  SseParser parser;
+  Collector collector;
+  parser.Feed("id: 1\ndata: a\n\ndata: b\n\nid\ndata: c\n\n",
+              collector.handler());
+
+  ASSERT_EQ(collector.events().size(), 3u);
+  EXPECT_EQ(collector.events()[0].id, "1");
+  EXPECT_EQ(collector.events()[1].id, "1");
+  // Пустой id: сбрасывает последний id
+  EXPECT_EQ(collector.events()[2].id, "");
+  EXPECT_EQ(parser.last_event_id(), "");
+}
+
+TEST(SseParserTest, IdWithNulIsIgnored) {
+  constexpr char kStream[] = "id: 7\ndata: a\n\nid: x\0y\ndata: b\n\n";
+  SseParser parser;
+  Collector collector;
+  parser.Feed(std::string_view(kStream, sizeof(kStream) - 1),
+              collector.handler());
+
+  ASSERT_EQ(collector.events().size(), 2u);
+  EXPECT_EQ(collector.events()[1].id, "7");
+  EXPECT_EQ(parser.last_event_id(), "7");
+}
+
+TEST(SseParserTest, Retry) {
+  SseParser parser;
+  Collector collector;
+  auto handler = collector.handler();
+  EXPECT_FALSE(parser.retry_ms().has_value());
+
+  parser.Feed("retry: 1500\n\n", handler);
+  ASSERT_TRUE(parser.retry_ms().has_value());
+  EXPECT_EQ(*parser.retry_ms(), 1500);
+
+  // Некорректные значения игнорируются
+  parser.Feed("retry: 10s\n\nretry: -1\n\nretry:\n\n", handler);
+  EXPECT_EQ(*parser.retry_ms(), 1500);
+
+  parser.Feed("retry:20\n\n", handler);
+  EXPECT_EQ(*parser.retry_ms(), 20);
+  EXPECT_TRUE(collector.events().empty());
+}
+
+TEST(SseParserTest, UnknownFieldsAreIgnored) {
+  auto events = ParseWhole("foo: bar\ndata: a\nbaz\n\n");
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "a");
+}
+
+TEST(SseParserTest, IncompleteEventIsNotDispatched) {
+  SseParser parser;
+  Collector collector;
+  parser.Feed("data: a\n\ndata: b\n", collector.handler());
+  EXPECT_EQ(collector.events().size(), 1u);
+
+  // Reset отбрасывает незавершенное событие
+  parser.Reset();
+  parser.Feed("data: c\n\n", collector.handler());
+  ASSERT_EQ(collector.events().size(), 2u);
+  EXPECT_EQ(collector.events()[1].data, "c");
+}
+
+TEST(SseParserTest, ByteByByteMatchesWholeBuffer) {
+  const std::string streams[] = {
+      "\xEF\xBB\xBF" "data: a\n\n",
+      "data: a\r\n\r\ndata: b\r\rdata: c\n\n",
+      "event: delta\nid: 42\nretry: 100\ndata: x\ndata: y\r\n\r\n",
+      ": comment\r\ndata: {\"k\":\"v\"}\r\n\r\n: ping\r\rdata: [DONE]\r\n\r\n",
+      "data:no-space\ndata:\ndata:  two\r\n\n",
+  };
+  for (const auto& stream : streams) {
+    auto whole = ParseWhole(stream);
+    EXPECT_FALSE(whole.empty()) << stream;
+    EXPECT_EQ(ParseByteByByte(stream), whole) << stream;
+  }
+}
+
+TEST(SseParserTest, LargeStreamInChunks) {
+  // Длинный поток, разрезанный на куски разной длины
+  std::string stream;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 20000; ++i) {
+    std::string data = "{\"content\":\"token" + std::to_string(i) + "\"}";
+    stream += "data: " + data + (i % 3 == 0 ? "\r\n\r\n" : "\n\n");
+    expected.push_back(data);
+  }
+
+  for (size_t chunk : {7u, 4096u, 100000u}) {
+    SseParser parser;
+    Collector collector;
+    auto handler = collector.handler();
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+      parser.Feed(std::string_view(stream).substr(pos, chunk), handler);
+    }
+    ASSERT_EQ(collector.events().size(), expected.size()) << chunk;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(collector.events()[i].data, expected[i]) << chunk;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace agentixx
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/core/streaming.hpp>
+#include <agentixx/core/types.hpp>
+#include <string>
+
+namespace agentixx {
+namespace {
+
+std::string Chunk(const std::string& extra) {
+  return R"({"choices":[{"index":0,"delta":{"content":"hi"}}],"x":)" + extra +
+         "}";
+}
+
+TEST(StreamChunkTest, DecodesWithoutDom) {
+  auto chunk = StreamChunk::FromJson(
+      R"({"id":"c1","created":1700000000,"choices":[{"index":0,)"
+      R"("delta":{"content":"a\nb é"},"logprobs":null,)"
+      R"("finish_reason":"stop"}],"usage":{"prompt_tokens":3,)"
+      R"("completion_tokens":2,"total_tokens":5}})");
+  EXPECT_EQ(chunk.text(), "a\nb \xC3\xA9");
+  ASSERT_TRUE(chunk.finish_reason.has_value());
+  EXPECT_EQ(*chunk.finish_reason, "stop");
+  ASSERT_TRUE(chunk.usage.has_value());
+  EXPECT_EQ(chunk.usage->total_tokens, 5);
+  EXPECT_EQ(chunk.raw()["created"], 1700000000);
+}
+
+TEST(StreamChunkTest, AcceptsValidNumbers) {
+  for (const char* number : {"0", "-0", "12", "-3.25", "1e9", "1E+2",
+                             "0.5e-3", "-10.0E10"}) {
+    auto chunk = StreamChunk::FromJson(Chunk(number));
+    EXPECT_EQ(chunk.text(), "hi") << number;
+    EXPECT_TRUE(chunk.raw()["x"].is_number()) << number;
+  }
+}
+
+TEST(StreamChunkTest, RejectsMalformedNumbers) {
+  // Все это отвергает и DOM парсер
+  for (const char* number : {"1-2", "+1", "--1", "1.", ".5", "01", "-",
+                             "1e", "1e+", "1.2.3", "1ee2", "0x10", "1E5e"}) {
+    EXPECT_THROW(StreamChunk::FromJson(Chunk(number)), ParseError) << number;
+  }
+  EXPECT_THROW(StreamChunk::FromJson(
+                   R"({"choices":[{"index":01,"delta":{"content":"a"}}]})"),
+               ParseError);
+}
+
+TEST(StreamChunkTest, RejectsMalformedEscapes) {
+  for (const char* value : {R"("\x")", R"("\u12")", R"("\uZZZZ")",
+                            R"("\udc00")", R"("\ud800x")"}) {
+    EXPECT_THROW(StreamChunk::FromJson(Chunk(value)), ParseError) << value;
+  }
+}
+
+TEST(StreamChunkTest, RawThrowsParseError) {
+  // Некорректный UTF-8 в пропущенном поле не проверяется при разборе
+  // chunk, DOM в raw() его отвергает
+  auto chunk = StreamChunk::FromJson(Chunk("\"\xFF\""));
+  EXPECT_EQ(chunk.text(), "hi");
+  EXPECT_THROW(chunk.raw(), ParseError);
+}
+
+}  // namespace
+}  // namespace agentixx
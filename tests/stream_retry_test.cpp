@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <agentixx/agentixx.hpp>
+#include <agentixx/testing/mock_server.hpp>
+#include <chrono>
+
+namespace agentixx {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::vector<Message> kMessages = {{"user", "hi"}};
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Первый запрос получает 429 с Retry-After, остальные проходят
+MockServerOptions RateLimitFirst(int retry_after_ms) {
+  MockServerOptions options;
+  options.behavior.SetCompletionTokens(4);
+  options.SetScript([retry_after_ms](const MockRequest& request,
+                                     MockBehavior& behavior) {
+    if (request.index == 0) {
+      behavior.SetFault(MockBehavior::Fault::kRateLimit);
+      behavior.SetRetryAfterMs(retry_after_ms);
+    }
+  });
+  return options;
+}
+
+std::string ReadAll(StreamingResponse& stream) {
+  std::string text;
+  for (const auto& chunk : stream) {
+    text += chunk.text();
+  }
+  return text;
+}
+
+TEST(StreamRetryTest, ApiErrorCarriesResponseHeaders) {
+  MockOpenAIServer server(RateLimitFirst(250));
+  server.Start();
+
+  Config config;
+  config.SetApiKey("test");
+  config.SetBaseUrl(server.base_url());
+  OpenAIAdapter adapter(config, "mock");
+
+  try {
+    adapter.ChatStream(kMessages);
+    FAIL() << "429 must be thrown";
+  } catch (const ApiError& e) {
+    EXPECT_EQ(e.status_code, 429);
+    ASSERT_TRUE(e.headers.count("retry-after-ms"));
+    EXPECT_EQ(e.headers.at("retry-after-ms"), "250");
+  }
+}
+
+TEST(StreamRetryTest, RetryWaitsForRetryAfter) {
+  MockOpenAIServer server(RateLimitFirst(300));
+  server.Start();
+
+  // Собственный backoff почти нулевой: пауза может прийти только из
+  // Retry-After
+  RetryPolicy policy;
+  policy.max_attempts = 3;
+  policy.initial_backoff_ms = 1;
+  policy.max_backoff_ms = 1;
+
+  Config config;
+  config.SetApiKey("test");
+  config.SetBaseUrl(server.base_url());
+  config.SetRetryPolicy(policy);
+  OpenAIAdapter adapter(config, "mock");
+
+  auto start = Clock::now();
+  auto stream = adapter.ChatStream(kMessages);
+  EXPECT_GE(ElapsedMs(start), 300);
+  EXPECT_EQ(ReadAll(stream), "token token token token ");
+
+  MockServerStats stats = server.stats();
+  EXPECT_EQ(stats.requests, 2u);
+  EXPECT_EQ(stats.rate_limited, 1u);
+}
+
+TEST(StreamRetryTest, RateLimiterUsesRetryAfter) {
+  MockOpenAIServer server(RateLimitFirst(200));
+  server.Start();
+
+  auto limiter = std::make_shared<RateLimiter>();
+  Config config;
+  config.SetApiKey("test");
+  config.SetBaseUrl(server.base_url());
+  config.SetRateLimiter(limiter);
+  OpenAIAdapter adapter(config, "mock");
+
+  EXPECT_THROW(adapter.ChatStream(kMessages), ApiError);
+  EXPECT_EQ(limiter->GetStats().throttled, 1u);
+
+  // Без заголовков limiter остановил бы ключ на секунду по умолчанию
+  auto start = Clock::now();
+  auto stream = adapter.ChatStream(kMessages);
+  double waited = ElapsedMs(start);
+  EXPECT_GE(waited, 150);
+  EXPECT_LT(waited, 900);
+  EXPECT_EQ(ReadAll(stream), "token token token token ");
+}
+
+}  // namespace
+}  // namespace agentixx